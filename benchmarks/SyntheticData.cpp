@@ -0,0 +1,160 @@
+/*
+ * Vishnu
+ * Copyright (c) 2017-2019 GMRV/URJC.
+ *
+ * Authors: Gonzalo Bayo Martinez <gonzalo.bayo@urjc.es>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "SyntheticData.h"
+
+#include <iomanip>
+#include <locale>
+#include <random>
+#include <sstream>
+
+#include "../vishnu/Definitions.hpp"
+#include "../vishnu/pipeline/CsvFormat.h"
+#include "../vishnu/pipeline/DataSetWriter.h"
+
+namespace vishnu
+{
+
+  namespace
+  {
+    std::string getMeshFilename( const size_t& mesh )
+    {
+      return std::string( "mesh_" ) + std::to_string( mesh ) + ".obj";
+    }
+
+    //Same digits as std::to_string, which follows LC_NUMERIC and may write
+    //a decimal comma. The stream is reused from number to number
+    void initNumberStream( std::ostringstream& stream )
+    {
+      stream.imbue( std::locale::classic( ) );
+      stream << std::fixed << std::setprecision( 6 );
+    }
+
+    std::string formatNumber( std::ostringstream& stream,
+      const double& value )
+    {
+      stream.str( std::string( ) );
+      stream << value;
+      return stream.str( );
+    }
+
+    bool generateGeometry( const std::string& folder,
+      const SyntheticDataOptions& options, std::string& error )
+    {
+      std::mt19937 random( options.seed );
+      std::uniform_real_distribution< double > coordinate( -100.0, 100.0 );
+      std::ostringstream number;
+      initNumberStream( number );
+      for ( size_t mesh = 0; mesh < options.geometryFiles; ++mesh )
+      {
+        DataSetWriter writer( folder + getMeshFilename( mesh ) );
+        while ( writer.getBytesWritten( ) < options.geometrySize )
+        {
+          writer.writeLine( "v " + formatNumber( number, coordinate( random ) )
+            + " " + formatNumber( number, coordinate( random ) ) + " "
+            + formatNumber( number, coordinate( random ) ) );
+        }
+        if ( !writer.close( ) )
+        {
+          error = writer.getError( );
+          return false;
+        }
+      }
+      return true;
+    }
+  }
+
+  bool SyntheticData::generate( const std::string& folder,
+    const SyntheticDataOptions& options,
+    std::vector< std::string >& csvPaths, std::string& error )
+  {
+    csvPaths.clear( );
+    std::mt19937 random( options.seed );
+    std::uniform_real_distribution< double > unit( 0.0, 1.0 );
+    std::ostringstream number;
+    initNumberStream( number );
+    size_t sharedColumns = static_cast< size_t >( options.overlap
+      * static_cast< double >( options.columns ) + 0.5 );
+
+    for ( size_t file = 0; file < options.files; ++file )
+    {
+      std::vector< std::string > headers( { "id" } );
+      for ( size_t col = 0; col < options.columns; ++col )
+      {
+        headers.emplace_back( ( col < sharedColumns )
+          ? "shared_" + std::to_string( col )
+          : "file" + std::to_string( file ) + "_" + std::to_string( col ) );
+      }
+      if ( options.geometryFiles > 0 )
+      {
+        headers.emplace_back( "mesh" );
+      }
+
+      std::string csvPath = folder + "data_" + std::to_string( file ) + "."
+        + STR_EXT_CSV;
+      DataSetWriter writer( csvPath );
+      writer.writeLine( joinCsvFields( headers ) );
+
+      std::string line;
+      std::string field;
+      for ( size_t row = 0; row < options.rows; ++row )
+      {
+        line = std::to_string( row );
+        for ( size_t col = 0; col < options.columns; ++col )
+        {
+          line += ",";
+          if ( unit( random ) < options.missing )
+          {
+            continue;
+          }
+          //One of every four columns holds text, the rest numbers
+          if ( col % 4 == 3 )
+          {
+            field = "label " + std::to_string( row % 97 );
+            if ( unit( random ) < options.quoted )
+            {
+              field += ", \"quoted\"";
+            }
+            appendCsvField( line, StringView( field ) );
+          }
+          else
+          {
+            line += formatNumber( number, unit( random ) * 1000.0 );
+          }
+        }
+        if ( options.geometryFiles > 0 )
+        {
+          line += ",";
+          line += getMeshFilename( row % options.geometryFiles );
+        }
+        writer.writeLine( line );
+      }
+      if ( !writer.close( ) )
+      {
+        error = writer.getError( );
+        return false;
+      }
+      csvPaths.emplace_back( csvPath );
+    }
+
+    return generateGeometry( folder + GEOMETRY_DATA_FOLDER, options, error );
+  }
+
+}
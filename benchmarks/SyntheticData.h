@@ -0,0 +1,67 @@
+/*
+ * Vishnu
+ * Copyright (c) 2017-2019 GMRV/URJC.
+ *
+ * Authors: Gonzalo Bayo Martinez <gonzalo.bayo@urjc.es>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef VISHNU_SYNTHETICDATA_H
+#define VISHNU_SYNTHETICDATA_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace vishnu
+{
+
+  struct SyntheticDataOptions
+  {
+    size_t files = 4;
+    size_t rows = 100000;
+    //Columns of every file besides the id (and mesh) columns
+    size_t columns = 16;
+    //Fraction of the columns shared by all the files
+    double overlap = 0.5;
+    //Fraction of text fields with separators or quotes, written quoted
+    double quoted = 0.0;
+    //Fraction of empty fields
+    double missing = 0.0;
+    size_t geometryFiles = 0;
+    size_t geometrySize = 65536;
+    uint32_t seed = 1;
+  };
+
+  /*
+   * Generates CSV sources for benchmarks: files sharing an "id" primary key
+   * (rows with the same index are the same entity), the shared columns and
+   * some columns of their own. With geometry files, every source gets a
+   * "mesh" column naming a file of the GEOMETRY_DATA_FOLDER folder. The
+   * folder (ending in a separator) and its geometry folder must exist.
+   */
+  class SyntheticData
+  {
+
+    public:
+
+      static bool generate( const std::string& folder,
+        const SyntheticDataOptions& options,
+        std::vector< std::string >& csvPaths, std::string& error );
+  };
+
+}
+
+#endif
@@ -0,0 +1,440 @@
+/*
+ * Vishnu
+ * Copyright (c) 2017-2019 GMRV/URJC.
+ *
+ * Authors: Gonzalo Bayo Martinez <gonzalo.bayo@urjc.es>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <QCoreApplication>
+#include <QDir>
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+
+#include <algorithm>
+#include <chrono>
+#include <clocale>
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <vishnucommon/vishnucommon.h>
+
+#include "SyntheticData.h"
+#include "../vishnu/Definitions.hpp"
+#include "../vishnu/pipeline/DataSetBuilder.h"
+#include "../vishnu/pipeline/DataSetSchema.h"
+#include "../vishnu/pipeline/DataSetWriter.h"
+#include "../vishnu/pipeline/ExternalSorter.h"
+#include "../vishnu/pipeline/FileFingerprint.h"
+#include "../vishnu/pipeline/NumberFormat.h"
+#include "../vishnu/pipeline/RowFilter.h"
+#include "../vishnu/pipeline/SourceCache.h"
+
+using namespace vishnu;
+
+namespace
+{
+  const std::vector< std::string > STAGES(
+    { "headers", "csv", "sort", "json", "xml", "geometry" } );
+
+  std::string getArg( vishnucommon::Args& args, const std::string& key,
+    const std::string& defaultValue )
+  {
+    return args.has( key ) ? args.get( key ) : defaultValue;
+  }
+
+  //Read as sources are, so options don't depend on the locale either
+  double getNumber( vishnucommon::Args& args, const std::string& key,
+    const std::string& defaultValue )
+  {
+    double value;
+    if ( !parseNumber( StringView( getArg( args, key, defaultValue ) ),
+      value ) )
+    {
+      throw std::invalid_argument( key );
+    }
+    return value;
+  }
+
+  double getSeconds( const std::chrono::steady_clock::time_point& start )
+  {
+    return std::chrono::duration< double >(
+      std::chrono::steady_clock::now( ) - start ).count( );
+  }
+
+  bool resetFolder( const std::string& folder )
+  {
+    QDir qDir( QString::fromStdString( folder ) );
+    if ( qDir.exists( ) && !qDir.removeRecursively( ) )
+    {
+      return false;
+    }
+    return qDir.mkpath( QString::fromStdString( folder + GEOMETRY_DATA_FOLDER ) );
+  }
+
+  //Source numbers must be read the same under the LC_NUMERIC in use, which
+  //may have a decimal comma
+  bool checkNumbers( std::string& error )
+  {
+    std::string locale = setlocale( LC_NUMERIC, nullptr );
+    const std::vector< std::pair< std::string, double > > samples(
+      { { "1.5", 1.5 }, { "-2.25e1", -22.5 }, { ".125", 0.125 } } );
+    for ( const auto& sample : samples )
+    {
+      double value;
+      if ( !parseNumber( StringView( sample.first ), value )
+        || value != sample.second )
+      {
+        error = "Number " + sample.first + " misread under the " + locale
+          + " locale.";
+        return false;
+      }
+    }
+
+    RowFilter rowFilter;
+    if ( !rowFilter.parse( "volume > 1.25", { "volume" } )
+      || !rowFilter.accept( { StringView( "1.5", 3 ) } )
+      || rowFilter.accept( { StringView( "1.2", 3 ) } ) )
+    {
+      error = "Filter on decimals misread under the " + locale + " locale.";
+      return false;
+    }
+    return true;
+  }
+
+  //Decimal primary keys must sort by value under the LC_NUMERIC in use
+  bool checkSortKeys( const std::string& folder, std::string& error )
+  {
+    std::string sourcePath = folder + "sortCheck.csv";
+    std::string sortedPath = folder + "sortCheck.sorted.csv";
+    DataSetWriter source( sourcePath );
+    for ( const auto& line : { "key", "1.5", "10", "1.25", "-0.5" } )
+    {
+      source.writeLine( line );
+    }
+    if ( !source.close( ) )
+    {
+      error = source.getError( );
+      return false;
+    }
+
+    ExternalSorter sorter( { "key" }, { "key" },
+      DEFAULT_SORT_MEMORY_BUDGET, folder );
+    DataSetWriter sorted( sortedPath );
+    bool sortedOk = sorter.sort( sourcePath, sorted );
+    bool closedOk = sorted.close( );
+    if ( !sortedOk || !closedOk )
+    {
+      error = sortedOk ? sorted.getError( ) : sorter.getError( );
+      return false;
+    }
+
+    std::vector< std::string > lines;
+    std::ifstream sortedFile( sortedPath );
+    std::string line;
+    while ( std::getline( sortedFile, line ) )
+    {
+      lines.emplace_back( line );
+    }
+    sortedFile.close( );
+    QFile::remove( QString::fromStdString( sourcePath ) );
+    QFile::remove( QString::fromStdString( sortedPath ) );
+    if ( lines != std::vector< std::string >(
+      { "key", "-0.5", "1.25", "1.5", "10" } ) )
+    {
+      error = std::string( "Decimal keys missorted under the " )
+        + setlocale( LC_NUMERIC, nullptr ) + " locale.";
+      return false;
+    }
+    return true;
+  }
+
+  //Every property in use, "id" as primary key
+  vishnucommon::DataSetsPtr createDataSets(
+    const std::vector< std::string >& headers )
+  {
+    DataSetSchema::Properties properties;
+    for ( const auto& header : headers )
+    {
+      DataSetSchema::Property property;
+      property.name = header;
+      property.primaryKey = ( header == "id" );
+      if ( header == "mesh" )
+      {
+        property.dataCategory = vishnucommon::DataCategory::Geometric;
+      }
+      properties.emplace_back( property );
+    }
+    return DataSetSchema::createResultDataSets( properties );
+  }
+}
+
+/*
+ * Times the dataset build stages over synthetic sources and prints the
+ * results as JSON (or writes them to the -o file).
+ *
+ * VishnuBench [-d folder] [-f files] [-r rows] [-c columns] [-overlap 0.5]
+ *   [-quoted 0.0] [-missing 0.0] [-g geometryFiles] [-gs geometrySize]
+ *   [-s seed] [-i iterations] [-join 0|1] [-cache 0|1] [-sparse 0|1]
+ *   [-sort 0|1] [-filter expression] [-staging copy|hardLink|reflink|symlink]
+ *   [-pack 0|1] [-compression 0-9] [-locale name] [-o results.json]
+ *
+ * -locale sets LC_NUMERIC (the user locale by default) and checks numbers
+ * are still read, filtered and sorted by value before timing anything.
+ */
+int main( int argc, char* argv[] )
+{
+  QCoreApplication app( argc, argv );
+  vishnucommon::Args args( argc, argv );
+
+  SyntheticDataOptions options;
+  size_t iterations;
+  bool join;
+  bool useCache;
+  bool sparse;
+  bool sort;
+  std::string filter;
+  GeometryStager::Mode staging;
+  bool pack;
+  int compression;
+  try
+  {
+    options.files = std::stoul( getArg( args, "-f", "4" ) );
+    options.rows = std::stoul( getArg( args, "-r", "100000" ) );
+    options.columns = std::stoul( getArg( args, "-c", "16" ) );
+    options.overlap = getNumber( args, "-overlap", "0.5" );
+    options.quoted = getNumber( args, "-quoted", "0.0" );
+    options.missing = getNumber( args, "-missing", "0.0" );
+    options.geometryFiles = std::stoul( getArg( args, "-g", "0" ) );
+    options.geometrySize = std::stoul( getArg( args, "-gs", "65536" ) );
+    options.seed = static_cast< uint32_t >(
+      std::stoul( getArg( args, "-s", "1" ) ) );
+    iterations = std::max( 1ul, std::stoul( getArg( args, "-i", "3" ) ) );
+    join = std::stoul( getArg( args, "-join", "0" ) ) != 0;
+    useCache = std::stoul( getArg( args, "-cache", "0" ) ) != 0;
+    sparse = std::stoul( getArg( args, "-sparse", "0" ) ) != 0;
+    sort = std::stoul( getArg( args, "-sort", "0" ) ) != 0;
+    filter = getArg( args, "-filter", "" );
+    staging = GeometryStager::toMode( getArg( args, "-staging", "copy" ) );
+    pack = std::stoul( getArg( args, "-pack", "0" ) ) != 0;
+    compression = std::stoi( getArg( args, "-compression", "0" ) );
+  }
+  catch ( const std::exception& )
+  {
+    std::cerr << "Invalid arguments." << std::endl;
+    return 1;
+  }
+
+  if ( args.has( "-locale" )
+    && !setlocale( LC_NUMERIC, args.get( "-locale" ).c_str( ) ) )
+  {
+    std::cerr << "Can't set " << args.get( "-locale" ) << " locale."
+      << std::endl;
+    return 1;
+  }
+  std::string error;
+  if ( !checkNumbers( error ) )
+  {
+    std::cerr << error << std::endl;
+    return 1;
+  }
+
+  std::string folder = getArg( args, "-d",
+    QDir::tempPath( ).toStdString( ) + "/vishnu-bench" ) + "/";
+  std::string inputFolder = folder + "input/";
+  std::string outputFolder = folder + "output/";
+  std::string cacheFolder = useCache ? folder + SOURCE_CACHE_FOLDER
+    : std::string( );
+
+  //Sources
+  if ( !resetFolder( inputFolder ) )
+  {
+    std::cerr << "Can't create " << inputFolder << " folder." << std::endl;
+    return 1;
+  }
+  if ( !checkSortKeys( inputFolder, error ) )
+  {
+    std::cerr << error << std::endl;
+    return 1;
+  }
+  if ( useCache && !resetFolder( cacheFolder ) )
+  {
+    std::cerr << "Can't create " << cacheFolder << " folder." << std::endl;
+    return 1;
+  }
+  std::vector< std::string > sourcePaths;
+  std::chrono::steady_clock::time_point start =
+    std::chrono::steady_clock::now( );
+  if ( !SyntheticData::generate( inputFolder, options, sourcePaths, error ) )
+  {
+    std::cerr << error << std::endl;
+    return 1;
+  }
+  double generateTime = getSeconds( start );
+
+  uint64_t inputSize = 0;
+  for ( const auto& sourcePath : sourcePaths )
+  {
+    FileFingerprint fingerprint;
+    FileFingerprint::stat( sourcePath, fingerprint );
+    inputSize += fingerprint.size;
+  }
+
+  QJsonArray iterationsArray;
+  std::vector< std::vector< double > > times( STAGES.size( ) );
+  for ( size_t iteration = 0; iteration < iterations; ++iteration )
+  {
+    //Header reading, as done when sources are added to the dataset window
+    start = std::chrono::steady_clock::now( );
+    std::vector< std::string > headers;
+    for ( const auto& sourcePath : sourcePaths )
+    {
+      std::vector< std::string > sourceHeaders;
+      SourceCache::readHeaders( sourcePath, cacheFolder,
+        sourceHeaders );
+      for ( const auto& header : sourceHeaders )
+      {
+        if ( vishnucommon::Vectors::find( headers, header ) == -1 )
+        {
+          headers.emplace_back( header );
+        }
+      }
+    }
+    double headersTime = getSeconds( start );
+
+    //A clean output folder every time, so nothing is rebuilt incrementally
+    if ( !resetFolder( outputFolder ) )
+    {
+      std::cerr << "Can't create " << outputFolder << " folder." << std::endl;
+      return 1;
+    }
+    DataSetBuilder dataSetBuilder( createDataSets( headers ), sourcePaths,
+      outputFolder, outputFolder + "dataSet.csv",
+      outputFolder + "dataSet.json", outputFolder + "dataSet.xml" );
+    dataSetBuilder.setJoin( join );
+    dataSetBuilder.setCacheFolder( cacheFolder );
+    dataSetBuilder.setSparse( sparse );
+    dataSetBuilder.setSort( sort );
+    dataSetBuilder.setRowFilter( filter );
+    dataSetBuilder.setGeometrySource( inputFolder + GEOMETRY_DATA_FOLDER );
+    dataSetBuilder.setGeometryStaging( staging );
+    dataSetBuilder.setGeometryArchive( pack );
+    dataSetBuilder.setGeometryCompression( compression );
+    if ( !dataSetBuilder.build( ) )
+    {
+      std::cerr << dataSetBuilder.getError( ) << std::endl;
+      return 1;
+    }
+    BuildProgressPtr progress = dataSetBuilder.getProgress( );
+
+    std::vector< double > iterationTimes( {
+      headersTime,
+      progress->getStageTime( BuildProgress::Stage::CSV ),
+      progress->getStageTime( BuildProgress::Stage::Sort ),
+      progress->getStageTime( BuildProgress::Stage::JSON ),
+      progress->getStageTime( BuildProgress::Stage::XML ),
+      progress->getStageTime( BuildProgress::Stage::Geometry ) } );
+    QJsonObject iterationObject;
+    for ( size_t stage = 0; stage < STAGES.size( ); ++stage )
+    {
+      times.at( stage ).emplace_back( iterationTimes.at( stage ) );
+      iterationObject[ QString::fromStdString( STAGES.at( stage ) ) ] =
+        iterationTimes.at( stage );
+    }
+    iterationObject[ "rows" ] = static_cast< double >( progress->getRows( ) );
+    iterationObject[ "batches" ] =
+      static_cast< double >( progress->getBatches( ) );
+    iterationObject[ "batchBytes" ] =
+      static_cast< double >( progress->getBatchBytes( ) );
+    iterationObject[ "batchAllocations" ] =
+      static_cast< double >( progress->getBatchAllocations( ) );
+    iterationsArray.append( iterationObject );
+  }
+
+  //Results
+  QJsonObject optionsObject;
+  optionsObject[ "files" ] = static_cast< double >( options.files );
+  optionsObject[ "rows" ] = static_cast< double >( options.rows );
+  optionsObject[ "columns" ] = static_cast< double >( options.columns );
+  optionsObject[ "overlap" ] = options.overlap;
+  optionsObject[ "quoted" ] = options.quoted;
+  optionsObject[ "missing" ] = options.missing;
+  optionsObject[ "geometryFiles" ] =
+    static_cast< double >( options.geometryFiles );
+  optionsObject[ "geometrySize" ] =
+    static_cast< double >( options.geometrySize );
+  optionsObject[ "seed" ] = static_cast< double >( options.seed );
+  optionsObject[ "join" ] = join;
+  optionsObject[ "cache" ] = useCache;
+  optionsObject[ "sparse" ] = sparse;
+  optionsObject[ "sort" ] = sort;
+  optionsObject[ "filter" ] = QString::fromStdString( filter );
+  optionsObject[ "staging" ] = QString::fromStdString(
+    GeometryStager::toString( staging ) );
+  optionsObject[ "pack" ] = pack;
+  optionsObject[ "compression" ] = compression;
+
+  QJsonObject summaryObject;
+  for ( size_t stage = 0; stage < STAGES.size( ); ++stage )
+  {
+    std::vector< double >& stageTimes = times.at( stage );
+    std::sort( stageTimes.begin( ), stageTimes.end( ) );
+    double sum = 0.0;
+    for ( const auto& stageTime : stageTimes )
+    {
+      sum += stageTime;
+    }
+    QJsonObject stageObject;
+    stageObject[ "min" ] = stageTimes.front( );
+    stageObject[ "median" ] = stageTimes.at( stageTimes.size( ) / 2 );
+    stageObject[ "mean" ] = sum / stageTimes.size( );
+    stageObject[ "max" ] = stageTimes.back( );
+    summaryObject[ QString::fromStdString( STAGES.at( stage ) ) ] =
+      stageObject;
+  }
+  double csvTime = times.at( 1 ).front( );
+  summaryObject[ "csvThroughputMBs" ] = ( csvTime > 0.0 )
+    ? inputSize / 1048576.0 / csvTime : 0.0;
+
+  QJsonObject resultsObject;
+  resultsObject[ "options" ] = optionsObject;
+  resultsObject[ "inputBytes" ] = static_cast< double >( inputSize );
+  resultsObject[ "generate" ] = generateTime;
+  resultsObject[ "iterations" ] = iterationsArray;
+  resultsObject[ "summary" ] = summaryObject;
+  QByteArray results = QJsonDocument( resultsObject ).toJson( );
+
+  if ( args.has( "-o" ) )
+  {
+    QFile file( QString::fromStdString( args.get( "-o" ) ) );
+    if ( !file.open( QIODevice::WriteOnly )
+      || file.write( results ) != results.size( ) )
+    {
+      std::cerr << "Can't write " << args.get( "-o" ) << " file."
+        << std::endl;
+      return 1;
+    }
+  }
+  else
+  {
+    std::cout << results.toStdString( );
+  }
+  return 0;
+}
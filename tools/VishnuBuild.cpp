@@ -0,0 +1,309 @@
+/*
+ * Vishnu
+ * Copyright (c) 2017-2019 GMRV/URJC.
+ *
+ * Authors: Gonzalo Bayo Martinez <gonzalo.bayo@urjc.es>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <QCoreApplication>
+#include <QDir>
+#include <QFileInfo>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <vishnucommon/vishnucommon.h>
+
+#include "../vishnu/Definitions.hpp"
+#include "../vishnu/model/BuildRecipe.h"
+#include "../vishnu/model/UserDataSets.h"
+#include "../vishnu/pipeline/DataSetBuilder.h"
+
+using namespace vishnu;
+
+namespace
+{
+  std::string getArg( vishnucommon::Args& args, const std::string& key,
+    const std::string& defaultValue )
+  {
+    return args.has( key ) ? args.get( key ) : defaultValue;
+  }
+
+  //Recipe paths are relative to the recipe file
+  std::string resolve( const QDir& recipeFolder, const std::string& path )
+  {
+    return path.empty( ) ? path : QDir::cleanPath( recipeFolder.absoluteFilePath(
+      QString::fromStdString( path ) ) ).toStdString( );
+  }
+
+  bool buildRecipe( const BuildRecipePtr& recipe, const bool& useCache,
+    const size_t& memoryBudget, std::string& error )
+  {
+    if ( recipe->getName( ).empty( ) || recipe->getInputs( ).empty( )
+      || recipe->getProperties( ).empty( ) || recipe->getPath( ).empty( ) )
+    {
+      error = "Recipe needs a name, inputs, properties and a path.";
+      return false;
+    }
+
+    QDir qDir( QString::fromStdString( recipe->getPath( ) ) );
+    if ( !qDir.mkpath( qDir.absolutePath( ) ) )
+    {
+      error = "Can't create " + recipe->getPath( ) + " folder.";
+      return false;
+    }
+    std::string path = qDir.absolutePath( ).toStdString( );
+
+    DataSetBuilder dataSetBuilder( recipe->getDataSets( ),
+      recipe->getInputs( ), path, path + "/" + recipe->getCsvFilename( ),
+      path + "/" + recipe->getJsonFilename( ),
+      path + "/" + recipe->getXmlFilename( ) );
+    dataSetBuilder.setJoin( recipe->getJoin( ) );
+    dataSetBuilder.setSparse( recipe->getSparse( ) );
+    dataSetBuilder.setSort( recipe->getSort( ) );
+    dataSetBuilder.setRowFilter( recipe->getFilter( ) );
+    dataSetBuilder.setDuplicatePolicy(
+      DuplicateFilter::toPolicy( recipe->getDuplicates( ) ) );
+    if ( useCache )
+    {
+      //Shared with the datasets built from the dataset window
+      dataSetBuilder.setCacheFolder(
+        qApp->applicationDirPath( ).toStdString( ) + std::string( "/" )
+        + USER_DATA_FOLDER + SOURCE_CACHE_FOLDER );
+    }
+    dataSetBuilder.setJoinMemoryBudget( memoryBudget );
+    dataSetBuilder.setSortMemoryBudget( memoryBudget );
+    dataSetBuilder.setGeometrySource( recipe->getGeometrySource( ) );
+    dataSetBuilder.setGeometryStaging(
+      GeometryStager::toMode( recipe->getGeometryStaging( ) ) );
+    dataSetBuilder.setGeometrySync( recipe->getGeometrySync( ) );
+    dataSetBuilder.setGeometryHash( recipe->getGeometryHash( ) );
+    if ( recipe->getGeometryStore( ) )
+    {
+      //Shared with the datasets built from the dataset window
+      dataSetBuilder.setGeometryStore(
+        qApp->applicationDirPath( ).toStdString( ) + std::string( "/" )
+        + USER_DATA_FOLDER + GEOMETRY_STORE_FOLDER );
+    }
+    dataSetBuilder.setGeometryArchive( recipe->getGeometryArchive( ) );
+    dataSetBuilder.setGeometryCompression(
+      recipe->getGeometryCompression( ) );
+    if ( !dataSetBuilder.build( ) )
+    {
+      error = dataSetBuilder.getError( );
+      return false;
+    }
+    return true;
+  }
+
+  //Same registry MainWindow reads and writes
+  bool registerUserDataSets( const BuildRecipeVector& recipes )
+  {
+    std::string userDataFolder = qApp->applicationDirPath( ).toStdString( )
+        + std::string( "/" ) + USER_DATA_FOLDER + std::string( "/" );
+    std::string userDataSetsFilename = userDataFolder + FILE_DATASETS;
+    QDir qUserDataFolder( QString::fromStdString( userDataFolder ) );
+    if ( !qUserDataFolder.mkpath( QString::fromStdString( userDataFolder ) ) )
+    {
+      return false;
+    }
+
+    UserDataSetsPtr userDataSets( new UserDataSets( ) );
+    if ( vishnucommon::Files::exist( userDataSetsFilename ) )
+    {
+      userDataSets =
+        vishnucommon::JSON::deserialize< UserDataSets >( userDataSetsFilename );
+      //Never replaced by an empty registry when it can't be read
+      if ( !userDataSets )
+      {
+        std::cerr << "Can't read " << userDataSetsFilename << " file."
+          << std::endl;
+        return false;
+      }
+    }
+
+    //Rebuilt datasets replace the ones with the same name
+    UserDataSetsPtr newUserDataSets( new UserDataSets( ) );
+    for ( const auto& userDataSet : userDataSets->getUserDataSets( ) )
+    {
+      bool rebuilt = false;
+      for ( const auto& recipe : recipes )
+      {
+        rebuilt |= ( userDataSet->getName( ) == recipe->getName( ) );
+      }
+      if ( !rebuilt )
+      {
+        newUserDataSets->addUserDataSet( userDataSet );
+      }
+    }
+    for ( const auto& recipe : recipes )
+    {
+      newUserDataSets->addUserDataSet( UserDataSetPtr( new UserDataSet(
+        recipe->getName( ), recipe->getPath( ), recipe->getCsvFilename( ),
+        recipe->getJsonFilename( ), recipe->getXmlFilename( ), false ) ) );
+    }
+    return vishnucommon::JSON::serialize( userDataSetsFilename,
+      newUserDataSets );
+  }
+}
+
+/*
+ * Builds the datasets described in a recipes file without a display, running
+ * the same stages as the dataset window, and registers them as user
+ * datasets. Recipes are built concurrently, one per hardware thread unless
+ * limited with -j. The memory budget is shared by the concurrent builds,
+ * each joining and sorting within budget / jobs bytes.
+ *
+ * VishnuBuild -r recipes.json [-j jobs] [-cache 0|1] [-budget bytes]
+ *   [-register 0|1]
+ */
+int main( int argc, char* argv[] )
+{
+  QCoreApplication app( argc, argv );
+  vishnucommon::Args args( argc, argv );
+
+  if ( !args.has( "-r" ) )
+  {
+    std::cerr << "Usage: VishnuBuild -r recipes.json [-j jobs] [-cache 0|1] "
+      "[-budget bytes] [-register 0|1]" << std::endl
+      << "  -j jobs        recipes built at a time (default: hardware "
+      "threads)" << std::endl
+      << "  -budget bytes  join and sort memory shared by all jobs, "
+      "budget / jobs each" << std::endl;
+    return 1;
+  }
+
+  size_t jobs;
+  bool useCache;
+  size_t memoryBudget;
+  bool registerResults;
+  try
+  {
+    jobs = std::stoul( getArg( args, "-j", "0" ) );
+    useCache = std::stoul( getArg( args, "-cache", "0" ) ) != 0;
+    memoryBudget = std::stoull( getArg( args, "-budget",
+      std::to_string( DEFAULT_JOIN_MEMORY_BUDGET ) ) );
+    registerResults = std::stoul( getArg( args, "-register", "1" ) ) != 0;
+  }
+  catch ( const std::exception& )
+  {
+    std::cerr << "Invalid arguments." << std::endl;
+    return 1;
+  }
+
+  std::string recipesFilename = args.get( "-r" );
+  if ( !vishnucommon::Files::exist( recipesFilename ) )
+  {
+    std::cerr << "Can't find " << recipesFilename << " file." << std::endl;
+    return 1;
+  }
+  BuildRecipesPtr buildRecipes =
+    vishnucommon::JSON::deserialize< BuildRecipes >( recipesFilename );
+  if ( !buildRecipes )
+  {
+    std::cerr << "Can't read " << recipesFilename << " file." << std::endl;
+    return 1;
+  }
+  BuildRecipeVector recipes = buildRecipes->getBuildRecipes( );
+
+  QDir recipeFolder = QFileInfo( QString::fromStdString( recipesFilename )
+    ).absoluteDir( );
+  for ( auto& recipe : recipes )
+  {
+    std::vector< std::string > inputs;
+    for ( const auto& input : recipe->getInputs( ) )
+    {
+      inputs.emplace_back( resolve( recipeFolder, input ) );
+    }
+    recipe->setInputs( inputs );
+    recipe->setPath( resolve( recipeFolder, recipe->getPath( ) ) );
+    recipe->setGeometrySource(
+      resolve( recipeFolder, recipe->getGeometrySource( ) ) );
+  }
+
+  //One recipe per hardware thread unless limited
+  if ( jobs == 0 )
+  {
+    jobs = std::max( 1u, std::thread::hardware_concurrency( ) );
+  }
+  jobs = std::max( static_cast< size_t >( 1 ),
+    std::min( jobs, recipes.size( ) ) );
+
+  //The budget bounds all concurrent builds together
+  size_t jobMemoryBudget = std::max( static_cast< size_t >(
+    JOIN_MIN_MEMORY_BUDGET ), memoryBudget / jobs );
+
+  //Not vector< bool >, workers write their results concurrently
+  std::vector< char > results( recipes.size( ), 0 );
+  std::atomic< size_t > nextRecipe( 0 );
+  std::mutex outputMutex;
+  std::vector< std::thread > workers;
+  for ( size_t i = 0; i < jobs; ++i )
+  {
+    workers.emplace_back( [ & ]( )
+    {
+      size_t index;
+      while ( ( index = nextRecipe++ ) < recipes.size( ) )
+      {
+        const BuildRecipePtr& recipe = recipes.at( index );
+        std::chrono::steady_clock::time_point start =
+          std::chrono::steady_clock::now( );
+        std::string error;
+        results.at( index ) = buildRecipe( recipe, useCache,
+          jobMemoryBudget, error );
+        double seconds = std::chrono::duration< double >(
+          std::chrono::steady_clock::now( ) - start ).count( );
+
+        std::lock_guard< std::mutex > lock( outputMutex );
+        if ( results.at( index ) )
+        {
+          std::cout << recipe->getName( ) << ": built in " << seconds
+            << " s." << std::endl;
+        }
+        else
+        {
+          std::cerr << recipe->getName( ) << ": " << error << std::endl;
+        }
+      }
+    } );
+  }
+  for ( auto& worker : workers )
+  {
+    worker.join( );
+  }
+
+  BuildRecipeVector builtRecipes;
+  for ( size_t i = 0; i < recipes.size( ); ++i )
+  {
+    if ( results.at( i ) )
+    {
+      builtRecipes.emplace_back( recipes.at( i ) );
+    }
+  }
+  if ( registerResults && !builtRecipes.empty( )
+    && !registerUserDataSets( builtRecipes ) )
+  {
+    std::cerr << "Can't write user datasets file." << std::endl;
+    return 1;
+  }
+  return ( builtRecipes.size( ) == recipes.size( ) ) ? 0 : 1;
+}
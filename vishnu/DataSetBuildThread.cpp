@@ -0,0 +1,56 @@
+/*
+ * Vishnu
+ * Copyright (c) 2017-2019 GMRV/URJC.
+ *
+ * Authors: Gonzalo Bayo Martinez <gonzalo.bayo@urjc.es>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "DataSetBuildThread.h"
+
+namespace vishnu
+{
+
+  DataSetBuildThread::DataSetBuildThread(
+    const DataSetBuilderPtr& dataSetBuilder, QObject* parent )
+    : QThread( parent )
+    , _dataSetBuilder( dataSetBuilder )
+    , _result( false )
+  {
+
+  }
+
+  DataSetBuildThread::~DataSetBuildThread( )
+  {
+    _dataSetBuilder->getProgress( )->cancel( );
+    wait( );
+  }
+
+  DataSetBuilderPtr DataSetBuildThread::getDataSetBuilder( ) const
+  {
+    return _dataSetBuilder;
+  }
+
+  bool DataSetBuildThread::getResult( ) const
+  {
+    return _result;
+  }
+
+  void DataSetBuildThread::run( )
+  {
+    _result = _dataSetBuilder->build( );
+  }
+
+}
@@ -0,0 +1,56 @@
+/*
+ * Vishnu
+ * Copyright (c) 2017-2019 GMRV/URJC.
+ *
+ * Authors: Gonzalo Bayo Martinez <gonzalo.bayo@urjc.es>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef VISHNU_DATASETBUILDTHREAD_H
+#define VISHNU_DATASETBUILDTHREAD_H
+
+#include <QThread>
+
+#include "pipeline/DataSetBuilder.h"
+
+namespace vishnu
+{
+
+  //Runs a dataset build off the GUI thread; finished( ) is emitted when done
+  class DataSetBuildThread : public QThread
+  {
+    public:
+
+      DataSetBuildThread( const DataSetBuilderPtr& dataSetBuilder,
+        QObject* parent = Q_NULLPTR );
+
+      ~DataSetBuildThread( );
+
+      DataSetBuilderPtr getDataSetBuilder( ) const;
+
+      bool getResult( ) const;
+
+    protected:
+
+      void run( ) override;
+
+    private:
+
+      DataSetBuilderPtr _dataSetBuilder;
+      bool _result;
+  };
+}
+
+#endif
@@ -20,21 +20,25 @@
 
 #include "DataSetWindow.h"
 
+#include <algorithm>
+
 #include <QCoreApplication>
+#include <QFileDialog>
 #include <QVBoxLayout>
 #include <QHBoxLayout>
 #include <QMessageBox>
 #include <QToolButton>
 
-#include <map>
-
 #include "Definitions.hpp"
 
 namespace vishnu
 {
 
-  DataSetWindow::DataSetWindow( QWidget* parent )
+  DataSetWindow::DataSetWindow( const UserPreferencesPtr& userPreferences,
+    QWidget* parent )
     : QDialog( parent )
+    , _userPreferences( userPreferences )
+    , _buildThread( nullptr )
   {
     //ToolBar
     _toolBar = new QToolBar( );
@@ -62,6 +66,9 @@ namespace vishnu
 
     //DataSetListWidget
     _dataSetListWidget.reset( new DataSetListWidget( ) );
+    _dataSetListWidget->setTypeInferenceRows( getSizePreference(
+      STR_TYPEINFERENCEROWS, TYPE_INFERENCE_SAMPLE_ROWS ) );
+    _dataSetListWidget->setCacheFolder( getCacheFolder( ) );
 
     qRegisterMetaType< std::vector< std::string > >("StringVector");
 
@@ -72,6 +79,94 @@ namespace vishnu
     //PropertiesTableWidget
     _propertiesTableWidget.reset( new PropertiesTableWidget( ) );
 
+    //Join mode
+    _joinCheckBox = new QCheckBox( "Join rows by primary key", this );
+    _joinCheckBox->setToolTip( "Write one row per primary key instead of "
+      "one row per source row" );
+
+    //Sparse mode
+    _sparseCheckBox = new QCheckBox( "Leave missing data empty", this );
+    _sparseCheckBox->setToolTip( "Write missing fields empty and mark them "
+      "in a null bitmap next to the CSV file" );
+
+    //Sort mode
+    _sortCheckBox = new QCheckBox( "Sort rows by primary key", this );
+    _sortCheckBox->setToolTip( "Sort the rows of the CSV file by their "
+      "primary keys, numbers before text" );
+
+    //Duplicate rows, by primary key (whole rows without primary keys)
+    _duplicatesComboBox = new QComboBox( this );
+    _duplicatesComboBox->addItem( "Keep duplicate rows", QString::fromStdString(
+      DuplicateFilter::toString( DuplicateFilter::Policy::KeepAll ) ) );
+    _duplicatesComboBox->addItem( "Keep first duplicate",
+      QString::fromStdString( DuplicateFilter::toString(
+      DuplicateFilter::Policy::KeepFirst ) ) );
+    _duplicatesComboBox->addItem( "Keep last duplicate",
+      QString::fromStdString( DuplicateFilter::toString(
+      DuplicateFilter::Policy::KeepLast ) ) );
+    _duplicatesComboBox->addItem( "Fail on duplicates",
+      QString::fromStdString( DuplicateFilter::toString(
+      DuplicateFilter::Policy::Fail ) ) );
+    _duplicatesComboBox->setToolTip( "Rows with the same primary key, listed "
+      "in a conflict report next to the CSV file when dropped" );
+    QObject::connect( _joinCheckBox, SIGNAL( toggled( bool ) ),
+      _duplicatesComboBox, SLOT( setDisabled( bool ) ) );
+
+    //Geometric data staging
+    _geometryStagingComboBox = new QComboBox( this );
+    _geometryStagingComboBox->addItem( "Copy geometry",
+      QString::fromStdString( GeometryStager::toString(
+      GeometryStager::Mode::Copy ) ) );
+    _geometryStagingComboBox->addItem( "Hard link geometry",
+      QString::fromStdString( GeometryStager::toString(
+      GeometryStager::Mode::HardLink ) ) );
+    _geometryStagingComboBox->addItem( "Reflink geometry",
+      QString::fromStdString( GeometryStager::toString(
+      GeometryStager::Mode::Reflink ) ) );
+    _geometryStagingComboBox->addItem( "Symlink geometry",
+      QString::fromStdString( GeometryStager::toString(
+      GeometryStager::Mode::Symlink ) ) );
+    _geometryStagingComboBox->setToolTip( "How geometric data files are "
+      "placed in the dataset. Links take no space; when not possible, "
+      "files are reflinked or copied instead" );
+    _geometrySyncCheckBox = new QCheckBox( "Sync geometry", this );
+    _geometrySyncCheckBox->setToolTip( "Only stage new or changed geometric "
+      "data files, and remove the ones no longer in the source" );
+    _geometryStoreCheckBox = new QCheckBox( "Share geometry", this );
+    _geometryStoreCheckBox->setToolTip( "Keep geometric data files once in "
+      "the shared geometry store of the user data folder and stage them from "
+      "there, so datasets with the same meshes share them" );
+    _geometryArchiveCheckBox = new QCheckBox( "Pack geometry", this );
+    _geometryArchiveCheckBox->setToolTip( "Pack geometric data files in one "
+      "archive read by viewers instead of the geometric data folder. Files "
+      "are then neither linked, synced nor shared" );
+
+    //Row filter
+    QLabel* rowFilterLabel = new QLabel( "Row filter:", this );
+    _rowFilterLineEdit = new QLineEdit( this );
+    _rowFilterLineEdit->setPlaceholderText(
+      "volume >= 10 AND type IN ( spine, dendrite )" );
+    _rowFilterLineEdit->setToolTip( "Only rows matching the expression are "
+      "written. Compare columns with <, <=, >, >=, = or != and lists with "
+      "IN or NOT IN, combined with AND, OR and parentheses" );
+    rowFilterLabel->setBuddy( _rowFilterLineEdit );
+
+    //Geometry source, the dataset geometric data folder itself when empty
+    QLabel* geometrySourceLabel = new QLabel( "Geometry source:", this );
+    _geometrySourceLineEdit = new QLineEdit( this );
+    _geometrySourceLineEdit->setPlaceholderText(
+      "Geometric data folder of the dataset" );
+    _geometrySourceLineEdit->setToolTip( "Folder the geometric data files "
+      "are staged from. Without one, files already in the dataset are used "
+      "as they are, so they can't be linked, synced or shared" );
+    geometrySourceLabel->setBuddy( _geometrySourceLineEdit );
+    _geometrySourceButton = new QPushButton( "Browse", this );
+    QObject::connect( _geometrySourceButton, SIGNAL( clicked( ) ), this,
+      SLOT( slotBrowseGeometrySource( ) ) );
+    QObject::connect( _geometrySourceLineEdit,
+      SIGNAL( textChanged( const QString& ) ), this,
+      SLOT( slotUpdateGeometryOptions( ) ) );
+
     //Buttons
     _cancelButton = new QPushButton("Cancel", this);
     QObject::connect( _cancelButton, SIGNAL( clicked( ) ), this,
@@ -80,7 +175,43 @@ namespace vishnu
     QObject::connect( _createButton, SIGNAL( clicked( ) ), this,
       SLOT( slotCreateButton( ) ) );
 
+    //Build progress
+    _progressLabel = new QLabel( this );
+    _progressBar = new QProgressBar( this );
+    _progressBar->setRange( 0, 1000 );
+    _progressBar->setTextVisible( false );
+    _progressBar->setVisible( false );
+    _progressTimer = new QTimer( this );
+    _progressTimer->setInterval( PROGRESS_POLL_INTERVAL );
+    QObject::connect( _progressTimer, SIGNAL( timeout( ) ), this,
+      SLOT( slotUpdateProgress( ) ) );
+
+    QHBoxLayout* progressHBoxLayout = new QHBoxLayout( );
+    progressHBoxLayout->addWidget( _progressLabel, 0, Qt::AlignLeft );
+    progressHBoxLayout->addWidget( _progressBar, 1 );
+
+    QHBoxLayout* rowFilterHBoxLayout = new QHBoxLayout( );
+    rowFilterHBoxLayout->addWidget( rowFilterLabel, 0, Qt::AlignLeft );
+    rowFilterHBoxLayout->addWidget( _rowFilterLineEdit, 1 );
+
+    QHBoxLayout* geometrySourceHBoxLayout = new QHBoxLayout( );
+    geometrySourceHBoxLayout->addWidget( geometrySourceLabel, 0,
+      Qt::AlignLeft );
+    geometrySourceHBoxLayout->addWidget( _geometrySourceLineEdit, 1 );
+    geometrySourceHBoxLayout->addWidget( _geometrySourceButton, 0,
+      Qt::AlignRight );
+
     QHBoxLayout* buttonsHBoxLayout = new QHBoxLayout( );
+    buttonsHBoxLayout->addWidget( _joinCheckBox, 0, Qt::AlignLeft );
+    buttonsHBoxLayout->addWidget( _sparseCheckBox, 0, Qt::AlignLeft );
+    buttonsHBoxLayout->addWidget( _sortCheckBox, 0, Qt::AlignLeft );
+    buttonsHBoxLayout->addWidget( _duplicatesComboBox, 0, Qt::AlignLeft );
+    buttonsHBoxLayout->addWidget( _geometryStagingComboBox, 0,
+      Qt::AlignLeft );
+    buttonsHBoxLayout->addWidget( _geometrySyncCheckBox, 0, Qt::AlignLeft );
+    buttonsHBoxLayout->addWidget( _geometryStoreCheckBox, 0, Qt::AlignLeft );
+    buttonsHBoxLayout->addWidget( _geometryArchiveCheckBox, 0,
+      Qt::AlignLeft );
     buttonsHBoxLayout->addStretch( 255 );
     buttonsHBoxLayout->addWidget( _cancelButton, 0, Qt::AlignRight );
     buttonsHBoxLayout->addWidget( _createButton, 0, Qt::AlignRight );
@@ -90,7 +221,11 @@ namespace vishnu
     widgetVBoxLayout->addWidget( _toolBar, 1 );
     widgetVBoxLayout->addWidget( _dataSetListWidget.get( ), 2 );
     widgetVBoxLayout->addWidget( _propertiesTableWidget.get( ), 3 );
+    widgetVBoxLayout->addLayout( rowFilterHBoxLayout );
+    widgetVBoxLayout->addLayout( geometrySourceHBoxLayout );
+    widgetVBoxLayout->addLayout( progressHBoxLayout );
     widgetVBoxLayout->addLayout( buttonsHBoxLayout );
+    slotUpdateGeometryOptions( );
   }
 
   DataSetWindow::~DataSetWindow()
@@ -137,6 +272,27 @@ namespace vishnu
       _dataSetListWidget->getCommonProperties( ) );
   }
 
+  void DataSetWindow::slotBrowseGeometrySource( void )
+  {
+    QString dir = QFileDialog::getExistingDirectory( this,
+      tr( "Browse Geometry Source" ), _geometrySourceLineEdit->text( ),
+      QFileDialog::ShowDirsOnly | QFileDialog::DontResolveSymlinks );
+    if ( !dir.isEmpty( ) )
+    {
+      _geometrySourceLineEdit->setText( dir );
+    }
+  }
+
+  void DataSetWindow::slotUpdateGeometryOptions( void )
+  {
+    //Files of the dataset itself are kept in place, only packing uses them
+    bool enabled = ( _buildThread == nullptr )
+      && !_geometrySourceLineEdit->text( ).trimmed( ).isEmpty( );
+    _geometryStagingComboBox->setEnabled( enabled );
+    _geometrySyncCheckBox->setEnabled( enabled );
+    _geometryStoreCheckBox->setEnabled( enabled );
+  }
+
   void DataSetWindow::slotCreateButton( void )
   {
     //TODO: Check for userdataset name (unique?)
@@ -167,323 +323,234 @@ namespace vishnu
     }
     else
     {
-      if ( vishnucommon::Files::exist( csvPath ) )
-      {
-        QMessageBox::StandardButton overwriteCsv = QMessageBox::warning( this,
-          "CSV File exists", QString::fromStdString( csvPath )
-          + " already exists. Do you want to overwrite it?'",
-          QMessageBox::Yes | QMessageBox::No );
-          if ( overwriteCsv == QMessageBox::No )
-          {
-            return;
-          }
-          if ( vishnucommon::Files::remove( csvPath ) )
-          {
-            vishnucommon::Error::throwError( vishnucommon::Error::ErrorType::Error,
-              "Can't remove existing CSV file (" + csvPath + ").", false );
-            return;
-          }
-      }
-      if ( vishnucommon::Files::exist( jsonPath ) )
+      //Existing outputs are not removed, the builder updates them from its
+      //manifest when possible and only replaces them once the whole build
+      //succeeded, so a canceled or failed build keeps them
+      if ( vishnucommon::Files::exist( csvPath )
+        || vishnucommon::Files::exist( jsonPath )
+        || vishnucommon::Files::exist( xmlPath ) )
       {
-        QMessageBox::StandardButton overwriteJson = QMessageBox::warning( this,
-          "JSON File exists", QString::fromStdString( jsonPath )
-          + " already exists. Do you want to overwrite it?'",
+        QMessageBox::StandardButton update = QMessageBox::warning( this,
+          "Dataset exists", QString::fromStdString( path )
+          + " already contains a dataset. Do you want to update it? Its "
+          "CSV, JSON and XML files are only replaced if the build succeeds.",
           QMessageBox::Yes | QMessageBox::No );
-          if ( overwriteJson == QMessageBox::No )
-          {
-            return;
-          }
-          if ( vishnucommon::Files::remove( jsonPath ) )
-          {
-            vishnucommon::Error::throwError( vishnucommon::Error::ErrorType::Error,
-              "Can't remove existing JSON file (" + jsonPath + ").", false );
-            return;
-          }
-      }
-      if ( vishnucommon::Files::exist( xmlPath ) )
-      {
-        QMessageBox::StandardButton overwriteXml = QMessageBox::warning( this,
-          "XML File exists", QString::fromStdString( xmlPath )
-          + " already exists. Do you want to overwrite it?'",
-          QMessageBox::Yes | QMessageBox::No );
-          if ( overwriteXml == QMessageBox::No )
-          {
-            return;
-          }
-          if ( vishnucommon::Files::remove( xmlPath ) )
-          {
-            vishnucommon::Error::throwError( vishnucommon::Error::ErrorType::Error,
-              "Can't remove existing XML file (" + xmlPath + ").", false );
-            return;
-          }
+        if ( update == QMessageBox::No )
+        {
+          return;
+        }
       }
     }
 
-    vishnucommon::DataSetsPtr resultDataSets =
-      _propertiesTableWidget->getDataSets( );
-    vishnucommon::DataSetPtr resultDataSet =
-      resultDataSets->getDataSets( ).at( 0 );
-    vishnucommon::PropertyGroupsPtr propertyGroups =
-      resultDataSets->getPropertyGroups( );
-
-    //Create CSV
-    if ( !createCSV( csvPath, propertyGroups ) )
+    //Sources are read from the data sets list before leaving the GUI thread
+    std::vector< std::string > sourcePaths;
+    vishnucommon::DataSetsPtr dataSets = _dataSetListWidget->getDataSets( );
+    for ( const auto& dataSet : dataSets->getDataSets( ) )
     {
-      vishnucommon::Error::throwError( vishnucommon::Error::ErrorType::Error,
-        "Can't create CSV file.", false );
-      return;
+      sourcePaths.emplace_back( dataSet->getPath( ) );
     }
 
-    //Create JSON
-    resultDataSets->getDataSets( ).at( 0 )->setPath( csvPath );
-    if ( !createJSON( jsonPath, resultDataSets ) )
+    DataSetBuilderPtr dataSetBuilder( new DataSetBuilder(
+      _propertiesTableWidget->getDataSets( ), sourcePaths, path, csvPath,
+      jsonPath, xmlPath ) );
+    dataSetBuilder->setJoin( _joinCheckBox->isChecked( ) );
+    dataSetBuilder->setSparse( _sparseCheckBox->isChecked( ) );
+    dataSetBuilder->setSort( _sortCheckBox->isChecked( ) );
+    std::string geometrySource =
+      _geometrySourceLineEdit->text( ).trimmed( ).toStdString( );
+    if ( !geometrySource.empty( ) )
     {
-      vishnucommon::Error::throwError( vishnucommon::Error::ErrorType::Error,
-        "Can't create JSON file.", false );
-      return;
+      dataSetBuilder->setGeometrySource( geometrySource );
     }
-
-    //Create XML
-    if ( !createXML( path, csvPath, xmlPath, resultDataSet, propertyGroups ) )
+    dataSetBuilder->setGeometryStaging( GeometryStager::toMode(
+      _geometryStagingComboBox->currentData( ).toString( ).toStdString( ) ) );
+    dataSetBuilder->setGeometryWorkers(
+      getSizePreference( STR_GEOMETRYWORKERS, GEOMETRY_STAGING_WORKERS ) );
+    dataSetBuilder->setGeometrySync( _geometrySyncCheckBox->isChecked( ) );
+    dataSetBuilder->setGeometryHash(
+      getSizePreference( STR_GEOMETRYHASH, 0 ) != 0 );
+    if ( _geometryStoreCheckBox->isChecked( ) )
     {
-      vishnucommon::Error::throwError( vishnucommon::Error::ErrorType::Error,
-        "Can't create XML file.", false );
-      return;
+      dataSetBuilder->setGeometryStore(
+        QCoreApplication::applicationDirPath( ).toStdString( )
+        + std::string( "/" ) + USER_DATA_FOLDER + GEOMETRY_STORE_FOLDER );
     }
+    dataSetBuilder->setGeometryArchive(
+      _geometryArchiveCheckBox->isChecked( ) );
+    dataSetBuilder->setGeometryCompression( static_cast< int >(
+      getSizePreference( STR_GEOMETRYCOMPRESSION, 0 ) ) );
+    dataSetBuilder->setRowFilter(
+      _rowFilterLineEdit->text( ).trimmed( ).toStdString( ) );
+    dataSetBuilder->setDuplicatePolicy( DuplicateFilter::toPolicy(
+      _duplicatesComboBox->currentData( ).toString( ).toStdString( ) ) );
+    dataSetBuilder->setCacheFolder( getCacheFolder( ) );
+    dataSetBuilder->setJoinMemoryBudget(
+      getSizePreference( STR_JOINMEMORYBUDGET, DEFAULT_JOIN_MEMORY_BUDGET ) );
+    dataSetBuilder->setSortMemoryBudget(
+      getSizePreference( STR_SORTMEMORYBUDGET, DEFAULT_SORT_MEMORY_BUDGET ) );
+    dataSetBuilder->setTempFolder( QDir::tempPath( ).toStdString( ) );
+
+    _buildThread = new DataSetBuildThread( dataSetBuilder, this );
+    QObject::connect( _buildThread, SIGNAL( finished( ) ), this,
+      SLOT( slotBuildFinished( ) ) );
+    setBuilding( true );
+    _buildThread->start( );
+  }
 
-    //Create geometric data
-    if ( !createGeometricData( path ) )
+  void DataSetWindow::slotCancelButton()
+  {
+    if ( _buildThread != nullptr )
     {
-      vishnucommon::Error::throwError( vishnucommon::Error::ErrorType::Error,
-        "Can't create geometric data.", false );
+      reject( );
       return;
     }
-
     close( );
-    setResult( QDialog::Accepted );
+    setResult( QDialog::Rejected );
   }
 
-  void DataSetWindow::slotCancelButton()
+  void DataSetWindow::reject( void )
   {
-    close( );
-    setResult( QDialog::Rejected );
+    if ( _buildThread != nullptr )
+    {
+      _buildThread->getDataSetBuilder( )->getProgress( )->cancel( );
+      _progressLabel->setText( "Canceling..." );
+      _cancelButton->setEnabled( false );
+      return;
+    }
+    QDialog::reject( );
   }
 
-   bool DataSetWindow::createCSV( const std::string& csvPath,
-    const vishnucommon::PropertyGroupsPtr& propertyGroups )
+  void DataSetWindow::slotBuildFinished( void )
   {
-    bool result = false;
+    DataSetBuilderPtr dataSetBuilder = _buildThread->getDataSetBuilder( );
+    bool result = _buildThread->getResult( );
+    _buildThread->deleteLater( );
+    _buildThread = nullptr;
+    setBuilding( false );
 
-    //Get headers (ordered, first pk headers, then non pk headers)
-    std::vector< std::string > selectedHeaders = propertyGroups->getHeaders( );
-    size_t selectedHeadersSize = selectedHeaders.size( );
-
-    //Write headers to csv
-    std::string joinedHeaders = vishnucommon::Strings::join(
-      selectedHeaders, std::string( "," ) );
-    result = vishnucommon::Files::writeLine( csvPath, joinedHeaders );
-
-    //Loop over files
-    vishnucommon::DataSetsPtr dataSets = _dataSetListWidget->getDataSets( );
-    for ( const auto& dataSet : dataSets->getDataSets( ) )
+    if ( result )
     {
-      vishnucommon::Matrix csvData =
-        vishnucommon::Files::readCsv( dataSet->getPath( ) );
-
-      //Remove csv columns not used
-      std::vector< std::string > oldCsvHeaders = dataSet->getPropertyNames( );
-      for ( unsigned int i = 0; i < oldCsvHeaders.size( ); ++i )
-      {
-        if ( vishnucommon::Vectors::find( selectedHeaders, oldCsvHeaders.at( i ) )
-          == -1 )
-        {
-          unsigned int index = static_cast< unsigned int >(
-            vishnucommon::Vectors::find( csvData.at( 0 ),
-            oldCsvHeaders.at( i ) ) );
-          vishnucommon::Matrices::removeColumn( csvData, index );
-        }
-      }
-
-      //Loop over global headers and map results
-      std::map< size_t, std::string > csvHeadersMap;
-      std::vector< std::string > csvHeaders = vishnucommon::Strings::split(
-        vishnucommon::Strings::joinAndTrim( csvData.at( 0 ), "," ), ',');
-      for ( size_t i = 0; i < selectedHeadersSize; ++i )
-      {
-        std::string header = selectedHeaders.at( i );
-        if ( vishnucommon::Vectors::find( csvHeaders, header ) != -1 )
-        {
-          csvHeadersMap[ i ] = selectedHeaders.at( i );
-        }
-      }
-
-      //Loop over all rows except headers
-      for ( size_t row = 1; row < csvData.size( ); ++row )
-      {
-          std::string line;
-          std::vector< std::string > csvRow = csvData.at( row );
-          //Loop over headers size instead of csv columns
-          for ( size_t col = 0; col < selectedHeadersSize; ++col )
-          {
-            if ( csvHeadersMap.find( col ) != csvHeadersMap.end( ) )
-            {
-              std::string field = vishnucommon::Strings::trim( csvRow.at( col ) );
-              line += ( line.empty( ) ) ? field
-                : std::string( "," ) + field;
-            }
-            else
-            {
-              line += ( line.empty( ) ) ? MISSING_DATA_FIELD
-                : std::string( "," ) + MISSING_DATA_FIELD;
-            }
-          }
-          result = vishnucommon::Files::writeLine( csvPath, line,
-            true );
-      }
+      close( );
+      setResult( QDialog::Accepted );
+    }
+    else if ( dataSetBuilder->isCanceled( ) )
+    {
+      _progressLabel->setText( "Canceled." );
+    }
+    else
+    {
+      _progressLabel->clear( );
+      vishnucommon::Error::throwError( vishnucommon::Error::ErrorType::Error,
+        dataSetBuilder->getError( ), false );
     }
-    return result;
   }
 
-  bool DataSetWindow::createXML( const std::string& path,
-    const std::string& csvPath, const std::string& xmlPath,
-    const vishnucommon::DataSetPtr& resultDataSet,
-    const vishnucommon::PropertyGroupsPtr& propertyGroups )
+  void DataSetWindow::slotUpdateProgress( void )
   {
-    bool result = false;
-
-    vishnucommon::Properties properties = resultDataSet->getProperties( );
-
-    //Features
-    std::string geometryColumn;
-
-    vishnucommon::FeaturesVector featuresVector;
-    for ( unsigned int i = 0; i < properties.size( ); ++i )
+    if ( _buildThread == nullptr )
     {
-      vishnucommon::PropertyPtr property = properties.at( i );
-      std::string name = property->getName( );
-      vishnucommon::DataCategory dataCategory = property->getDataCategory( );
-
-      //if PK do not include as pyramidal feature
-      if ( vishnucommon::Vectors::find( propertyGroups->getUsedPrimaryKeys( ),
-        name ) == -1 )
-      {
-        //if axes (geometric points xyz) do not include as pyramidal feature
-        if ( vishnucommon::Vectors::find( propertyGroups->getAxes( ), name )
-          == -1 )
-        {
-          featuresVector.emplace_back( vishnucommon::FeaturePtr(
-            new vishnucommon::Feature(
-            name,
-            name,
-            "mV",
-            dataCategory,
-            property->getDataStructureType( ) ) ) );
-        }
-      }
-
-      if ( dataCategory == vishnucommon::DataCategory::Geometric )
-      {
-        geometryColumn = name;
-      }
+      return;
+    }
+    BuildProgressPtr progress =
+      _buildThread->getDataSetBuilder( )->getProgress( );
+    if ( progress->isCanceled( ) )
+    {
+      return;
     }
 
-    vishnucommon::FeaturesPtr features( new vishnucommon::Features(
-      propertyGroups->getUsedPrimaryKeys( ), propertyGroups->getAxes( ),
-      geometryColumn, featuresVector ) );
-
-    //Set
-    vishnucommon::Sets sets;
-    sets.emplace_back( vishnucommon::SetPtr( new vishnucommon::Set( csvPath,
-      path + std::string( "/" ) + GEOMETRY_DATA_FOLDER ) ) );
-
-    //Data
-    vishnucommon::DataPtr dataPtr( new vishnucommon::Data( "customDataSet", "",
-      features, sets ) );
-
-    //Colors
-    vishnucommon::Vec3Ptr additionalMeshesColor(
-      new vishnucommon::Vec3( "60", "60", "60" ) );
-    vishnucommon::Vec3Ptr backgroundColor(
-      new vishnucommon::Vec3( "0", "0", "0" ) );
-    vishnucommon::ColorsPtr colors(
-      new vishnucommon::Colors( additionalMeshesColor, backgroundColor ) );
-
-    //Camera
-    vishnucommon::Vec3Ptr eye(
-      new vishnucommon::Vec3( "577.183", "1106.67", "290.011" ) );
-    vishnucommon::Vec3Ptr center(
-      new vishnucommon::Vec3( "479.859", "-26.1715", "670.239" ) );
-    vishnucommon::Vec3Ptr up(
-      new vishnucommon::Vec3( "0.0183558", "-0.319558", "-0.947389" ) );
-    vishnucommon::CameraPtr camera( new vishnucommon::Camera( eye, center, up ) );
-
-    //Configuration
-    vishnucommon::ConfigurationPtr configuration( new vishnucommon::Configuration(
-      "PyramidalExplorer", "0.2.0", "data", dataPtr, colors, camera ) );
-
-    //PyramidalXML
-    std::string dtd =
-      "<!DOCTYPE configuration SYSTEM \"http://gmrv.es/pyramidalexplorer/PyramidalExplorerData-0.2.0.dtd\">";
-    vishnucommon::PyramidalXMLPtr pyramidalXML(
-      new vishnucommon::PyramidalXML( dtd, configuration ) );
-
-    result = vishnucommon::XML::serialize( xmlPath, pyramidalXML );
-
-    return result;
+    size_t done = progress->getDone( );
+    size_t total = progress->getTotal( );
+    QString bytes = QString::number( done / 1048576.0, 'f', 1 ) + " / "
+      + QString::number( total / 1048576.0, 'f', 1 ) + " MB";
+    switch ( progress->getStage( ) )
+    {
+      case BuildProgress::Stage::CSV:
+        _progressLabel->setText( "Creating CSV file: "
+          + QString::number( progress->getRows( ) ) + " rows, " + bytes );
+        break;
+      case BuildProgress::Stage::Sort:
+        _progressLabel->setText( "Sorting CSV file: " + bytes );
+        break;
+      case BuildProgress::Stage::JSON:
+        _progressLabel->setText( "Creating JSON file" );
+        break;
+      case BuildProgress::Stage::XML:
+        _progressLabel->setText( "Creating XML file" );
+        break;
+      case BuildProgress::Stage::Geometry:
+        _progressLabel->setText( "Staging geometric data: "
+          + QString::number( progress->getFiles( ) ) + " / "
+          + QString::number( progress->getTotalFiles( ) ) + " files, "
+          + bytes );
+        break;
+      default:
+        break;
+    }
+    _progressBar->setValue( ( total == 0 ) ? 0 : static_cast< int >(
+      1000.0 * std::min( done, total ) / total ) );
   }
 
-  bool DataSetWindow::createJSON( const std::string& jsonPath,
-    vishnucommon::DataSetsPtr& dataSets )
+  void DataSetWindow::setBuilding( const bool& building )
   {
-    return vishnucommon::JSON::serialize( jsonPath, dataSets );
+    _toolBar->setEnabled( !building );
+    _pathsWidget->setEnabled( !building );
+    _dataSetListWidget->setEnabled( !building );
+    _propertiesTableWidget->setEnabled( !building );
+    _joinCheckBox->setEnabled( !building );
+    _sparseCheckBox->setEnabled( !building );
+    _sortCheckBox->setEnabled( !building );
+    _rowFilterLineEdit->setEnabled( !building );
+    _geometrySourceLineEdit->setEnabled( !building );
+    _geometrySourceButton->setEnabled( !building );
+    slotUpdateGeometryOptions( );
+    _geometryArchiveCheckBox->setEnabled( !building );
+    _duplicatesComboBox->setEnabled( !building
+      && !_joinCheckBox->isChecked( ) );
+    _createButton->setEnabled( !building );
+    _cancelButton->setEnabled( true );
+    _progressBar->setVisible( building );
+    _progressBar->setValue( 0 );
+    if ( building )
+    {
+      _progressLabel->setText( "Starting..." );
+      _progressTimer->start( );
+    }
+    else
+    {
+      _progressTimer->stop( );
+    }
   }
 
-  bool DataSetWindow::createGeometricData( const std::string& path )
+  size_t DataSetWindow::getSizePreference( const std::string& key,
+    const size_t& defaultValue ) const
   {
-    //Create geometric data folder
-    std::string geometryFolder = path + std::string( "/" )
-      + GEOMETRY_DATA_FOLDER;
-    QDir qGeometryFolder( QString::fromStdString( geometryFolder ) );
-    if ( !qGeometryFolder.mkpath( QString::fromStdString( geometryFolder ) ) )
+    if ( _userPreferences )
     {
-      vishnucommon::Error::throwError( vishnucommon::Error::ErrorType::Error,
-        "Can't create " + geometryFolder + " folder.", false );
-      return false;
-    }
-
-    //Copy geometry files
-    QString qPath = QString::fromStdString( path );
-    QDir qDir( qPath );
-    std::string sourceGeometryFolder = qDir.absolutePath( ).toStdString( )
-      + std::string( "/" ) + GEOMETRY_DATA_FOLDER;
-    QDir qSourceGeometryFolder(
-      QString::fromStdString( sourceGeometryFolder ) );
-
-    for( const QFileInfo& info : qSourceGeometryFolder.entryInfoList(
-      /*QDir::Dirs |*/ QDir::Files | QDir::NoDotAndDotDot ) ) {
-
-        QString srcFilePath =
-          qSourceGeometryFolder.absoluteFilePath( info.fileName( ) );
-        QString dstFilePath =
-          qGeometryFolder.absoluteFilePath( info.fileName( ) );
-
-        /*if ( info.isDir() )
+      std::string value = _userPreferences->getUserPreference( key );
+      if ( !value.empty( ) )
+      {
+        try
         {
-          //Recursive function to copy nested dirs...
-        } else */
-        if ( info.isFile( ) )
+          return static_cast< size_t >( std::stoull( value ) );
+        }
+        catch ( const std::exception& )
         {
-          if ( !QFile::copy( srcFilePath, dstFilePath ) )
-          {
-            vishnucommon::Error::throwError( vishnucommon::Error::ErrorType::Error,
-              "Can't copy " + info.fileName( ).toStdString( )
-              + " file.", false );
-            return false;
-          }
+          vishnucommon::Debug::consoleMessage( "Invalid " + key
+            + " preference, using default value." );
         }
+      }
+    }
+    return defaultValue;
+  }
+
+  std::string DataSetWindow::getCacheFolder( void ) const
+  {
+    if ( getSizePreference( STR_SOURCECACHE, 0 ) == 0 )
+    {
+      return std::string( );
     }
-    return true;
+    return QCoreApplication::applicationDirPath( ).toStdString( )
+      + std::string( "/" ) + USER_DATA_FOLDER + SOURCE_CACHE_FOLDER;
   }
 
 }
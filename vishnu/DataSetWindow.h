@@ -25,7 +25,13 @@
 #include <QAction>
 #include <QToolBar>
 #include <QPushButton>
+#include <QCheckBox>
+#include <QComboBox>
 #include <QDir>
+#include <QLabel>
+#include <QLineEdit>
+#include <QProgressBar>
+#include <QTimer>
 
 #include <string>
 #include <vector>
@@ -33,6 +39,8 @@
 #include "widgets/PathsWidget.h"
 #include "widgets/DataSetListWidget.h"
 #include "widgets/PropertiesTableWidget.h"
+#include "model/UserPreferences.h"
+#include "DataSetBuildThread.h"
 
 Q_DECLARE_METATYPE( std::vector< std::string > )
 
@@ -44,34 +52,55 @@ namespace vishnu
       Q_OBJECT
 
       public:
-        explicit DataSetWindow( QWidget *parent = Q_NULLPTR );
+        explicit DataSetWindow( const UserPreferencesPtr& userPreferences =
+          UserPreferencesPtr( ), QWidget *parent = Q_NULLPTR );
         ~DataSetWindow();
         UserDataSetPtr getResultUserDataSet( void );
 
+      public slots:
+        //Cancels the running build instead of closing
+        void reject( void ) override;
+
       private slots:
         void slotCreateButton( void );
         void slotCancelButton( void );
+        void slotBuildFinished( void );
+        void slotUpdateProgress( void );
         void slotAddFiles( const std::vector< std::string >& dropped =
           std::vector< std::string >( ) );
         void slotRemoveDataSet( );
+        void slotBrowseGeometrySource( void );
+        void slotUpdateGeometryOptions( void );
 
       private:
+        UserPreferencesPtr _userPreferences;
         QToolBar* _toolBar;
         PathsWidgetPtr _pathsWidget;
         DataSetListWidgetPtr _dataSetListWidget;
         PropertiesTableWidgetPtr _propertiesTableWidget;
+        QCheckBox* _joinCheckBox;
+        QCheckBox* _sparseCheckBox;
+        QCheckBox* _sortCheckBox;
+        QComboBox* _duplicatesComboBox;
+        QComboBox* _geometryStagingComboBox;
+        QCheckBox* _geometrySyncCheckBox;
+        QCheckBox* _geometryStoreCheckBox;
+        QCheckBox* _geometryArchiveCheckBox;
+        QLineEdit* _rowFilterLineEdit;
+        QLineEdit* _geometrySourceLineEdit;
+        QPushButton* _geometrySourceButton;
         QPushButton* _cancelButton;
         QPushButton* _createButton;
+        QLabel* _progressLabel;
+        QProgressBar* _progressBar;
+        QTimer* _progressTimer;
+        DataSetBuildThread* _buildThread;
 
-        bool createCSV( const std::string& csvPath,
-          const vishnucommon::PropertyGroupsPtr& propertyGroups );
-        bool createXML( const std::string& path, const std::string& csvPath,
-          const std::string& xmlPath,
-          const vishnucommon::DataSetPtr& resultDataSet,
-          const vishnucommon::PropertyGroupsPtr& propertyGroups );
-        bool createJSON( const std::string& jsonPath,
-          vishnucommon::DataSetsPtr& dataSets );
-        bool createGeometricData( const std::string& path );
+        void setBuilding( const bool& building );
+        size_t getSizePreference( const std::string& key,
+          const size_t& defaultValue ) const;
+        //Empty unless source caches are enabled in user preferences
+        std::string getCacheFolder( void ) const;
 
   };
 
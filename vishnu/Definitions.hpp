@@ -29,13 +29,27 @@
 
 #define STR_ZEQSESSION "zeqSession"
 #define STR_WORKINGDIRECTORY "workingDirectory"
+#define STR_JOINMEMORYBUDGET "joinMemoryBudget"
+#define STR_SOURCECACHE "sourceCache"
+#define STR_TYPEINFERENCEROWS "typeInferenceRows"
+#define STR_NULLBITMAP "nullBitmap"
+#define STR_SORTMEMORYBUDGET "sortMemoryBudget"
+#define STR_GEOMETRYWORKERS "geometryWorkers"
+#define STR_GEOMETRYHASH "geometryHash"
+#define STR_GEOMETRYSTORE "geometryStore"
+#define STR_GEOMETRYCOMPRESSION "geometryCompression"
 
 #define USER_DATA_FOLDER "userdata/"
 #define GEOMETRY_DATA_FOLDER "geometricData/"
+#define GEOMETRY_STORE_FOLDER "geometryStore/"
+#define SOURCE_CACHE_FOLDER "sourceCache/"
 #define DEFAULT_DATASET_FILENAME "dataSet"
 #define FILE_USER_PREFERENCES "UserPreferences.json"
 #define FILE_APPS_CONFIG "AppsConfig.json"
 #define FILE_DATASETS "DataSets.json"
+#define FILE_GEOMETRY_MANIFEST "geometricData.manifest"
+#define FILE_GEOMETRY_INDEX "geometricData.index"
+#define FILE_GEOMETRY_ARCHIVE "geometricData.pack"
 
 #define MAX_DATASET_NAME_LENGTH 10
 
@@ -49,7 +63,49 @@
 #define STR_EXT_JSON "json"
 #define STR_EXT_SEG "seg"
 #define STR_EXT_XML "xml"
+#define STR_EXT_CACHE "vcache"
+#define STR_EXT_MANIFEST "manifest"
+#define STR_EXT_NULLS "nulls"
+#define STR_EXT_CONFLICTS "conflicts"
 
 #define MISSING_DATA_FIELD "#!#Missing Data#!#"
 
+#define DEFAULT_WRITE_BUFFER_SIZE 8388608
+#define MERGE_BLOCK_SIZE 1048576
+#define MERGE_MAX_QUEUED_BLOCKS 4
+#define DEFAULT_JOIN_MEMORY_BUDGET 536870912
+#define JOIN_MIN_MEMORY_BUDGET 1048576
+#define JOIN_SPILL_PARTITIONS 64
+#define JOIN_MAX_SPILL_LEVELS 4
+#define FINGERPRINT_SAMPLE_SIZE 65536
+#define SOURCE_CACHE_MAGIC "VSHNCACH"
+#define SOURCE_CACHE_VERSION 2
+#define SOURCE_CACHE_HEADER_SIZE 48
+#define SOURCE_CACHE_ABSENT_FIELD 0xFFFFFFFFu
+#define SOURCE_CACHE_MAX_COLUMNS 1024
+#define SOURCE_CACHE_CHUNK_SIZE 67108864
+#define SOURCE_CACHE_MAX_DICTIONARY 4096
+#define SOURCE_CACHE_MAX_DIGITS 18
+#define PROGRESS_UPDATE_ROWS 4096
+#define PROGRESS_POLL_INTERVAL 100
+#define COPY_BUFFER_SIZE 8388608
+#define GEOMETRY_STAGING_WORKERS 8
+#define GEOMETRY_ARCHIVE_MAGIC "VSHNPACK"
+#define GEOMETRY_ARCHIVE_VERSION 1
+#define GEOMETRY_ARCHIVE_HEADER_SIZE 48
+#define GEOMETRY_ARCHIVE_ENTRY_SIZE 40
+#define GEOMETRY_ARCHIVE_ALIGNMENT 8
+#define GEOMETRY_ARCHIVE_BATCH_FILES 4
+#define ARENA_BLOCK_SIZE 1048576
+#define TYPE_INFERENCE_SAMPLE_ROWS 1000
+#define TYPE_INFERENCE_SAMPLE_BYTES 4194304
+#define TYPE_INFERENCE_MAX_CATEGORIES 32
+#define NULL_BITMAP_MAGIC "VSHNNULL"
+#define NULL_BITMAP_VERSION 1
+#define NULL_BITMAP_HEADER_SIZE 32
+#define NULL_BITMAP_BLOCK_ROWS 65536
+#define DEFAULT_SORT_MEMORY_BUDGET 536870912
+#define SORT_MIN_MEMORY_BUDGET 1048576
+#define SORT_MAX_MERGE_RUNS 64
+
 #endif
@@ -296,7 +296,7 @@ namespace vishnu
   {
     setBlurred( true );
 
-    DataSetWindow* dataSetWindow = new DataSetWindow();
+    DataSetWindow* dataSetWindow = new DataSetWindow( _userPreferences );
 
     dataSetWindow->setGeometry(
       QRect( 0, 0, APPLICATION_WIDTH, APPLICATION_HEIGHT ) );
@@ -0,0 +1,241 @@
+/*
+ * Vishnu
+ * Copyright (c) 2017-2019 GMRV/URJC.
+ *
+ * Authors: Gonzalo Bayo Martinez <gonzalo.bayo@urjc.es>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "BuildManifest.h"
+
+#include <QJsonArray>
+
+#include "ManifestJson.h"
+
+namespace vishnu
+{
+
+  BuildManifest::BuildManifest( void )
+    : _join( false )
+    , _sort( false )
+    , _geometryArchive( false )
+    , _geometryCompression( 0 )
+    , _headerSize( 0 )
+  {
+
+  }
+
+  BuildManifest::~BuildManifest( void )
+  {
+
+  }
+
+  BuildManifest::Sources BuildManifest::getSources( void ) const
+  {
+    return _sources;
+  }
+
+  void BuildManifest::setSources( const Sources& sources )
+  {
+    _sources = sources;
+  }
+
+  QJsonObject BuildManifest::getSchema( void ) const
+  {
+    return _schema;
+  }
+
+  void BuildManifest::setSchema( const QJsonObject& schema )
+  {
+    _schema = schema;
+  }
+
+  bool BuildManifest::getJoin( void ) const
+  {
+    return _join;
+  }
+
+  void BuildManifest::setJoin( const bool& join )
+  {
+    _join = join;
+  }
+
+  std::string BuildManifest::getDuplicatePolicy( void ) const
+  {
+    return _duplicatePolicy;
+  }
+
+  void BuildManifest::setDuplicatePolicy( const std::string& duplicatePolicy )
+  {
+    _duplicatePolicy = duplicatePolicy;
+  }
+
+  bool BuildManifest::getSort( void ) const
+  {
+    return _sort;
+  }
+
+  void BuildManifest::setSort( const bool& sort )
+  {
+    _sort = sort;
+  }
+
+  std::string BuildManifest::getRowFilter( void ) const
+  {
+    return _rowFilter;
+  }
+
+  void BuildManifest::setRowFilter( const std::string& rowFilter )
+  {
+    _rowFilter = rowFilter;
+  }
+
+  std::string BuildManifest::getGeometrySource( void ) const
+  {
+    return _geometrySource;
+  }
+
+  void BuildManifest::setGeometrySource( const std::string& geometrySource )
+  {
+    _geometrySource = geometrySource;
+  }
+
+  std::string BuildManifest::getGeometryStaging( void ) const
+  {
+    return _geometryStaging;
+  }
+
+  void BuildManifest::setGeometryStaging( const std::string& geometryStaging )
+  {
+    _geometryStaging = geometryStaging;
+  }
+
+  std::string BuildManifest::getGeometryStore( void ) const
+  {
+    return _geometryStore;
+  }
+
+  void BuildManifest::setGeometryStore( const std::string& geometryStore )
+  {
+    _geometryStore = geometryStore;
+  }
+
+  bool BuildManifest::getGeometryArchive( void ) const
+  {
+    return _geometryArchive;
+  }
+
+  void BuildManifest::setGeometryArchive( const bool& geometryArchive )
+  {
+    _geometryArchive = geometryArchive;
+  }
+
+  int BuildManifest::getGeometryCompression( void ) const
+  {
+    return _geometryCompression;
+  }
+
+  void BuildManifest::setGeometryCompression( const int& geometryCompression )
+  {
+    _geometryCompression = geometryCompression;
+  }
+
+  FileFingerprint BuildManifest::getCsvFingerprint( void ) const
+  {
+    return _csvFingerprint;
+  }
+
+  void BuildManifest::setCsvFingerprint(
+    const FileFingerprint& csvFingerprint )
+  {
+    _csvFingerprint = csvFingerprint;
+  }
+
+  uint64_t BuildManifest::getHeaderSize( void ) const
+  {
+    return _headerSize;
+  }
+
+  void BuildManifest::setHeaderSize( const uint64_t& headerSize )
+  {
+    _headerSize = headerSize;
+  }
+
+  void BuildManifest::deserialize( const QJsonObject &jsonObject )
+  {
+    _sources.clear( );
+    QJsonArray sources = jsonObject[ "sources" ].toArray( );
+    for ( int i = 0; i < sources.size( ); ++i )
+    {
+      QJsonObject sourceObject = sources.at( i ).toObject( );
+      Source source;
+      source.path = sourceObject[ "path" ].toString( ).toStdString( );
+      source.fingerprint = deserializeFingerprint(
+        sourceObject[ "fingerprint" ].toObject( ) );
+      source.offset = toUInt64( sourceObject[ "offset" ] );
+      source.size = toUInt64( sourceObject[ "size" ] );
+      _sources.emplace_back( source );
+    }
+    _schema = jsonObject[ "schema" ].toObject( );
+    _join = jsonObject[ "join" ].toBool( );
+    _duplicatePolicy =
+      jsonObject[ "duplicatePolicy" ].toString( ).toStdString( );
+    _sort = jsonObject[ "sort" ].toBool( );
+    _rowFilter = jsonObject[ "rowFilter" ].toString( ).toStdString( );
+    _geometrySource =
+      jsonObject[ "geometrySource" ].toString( ).toStdString( );
+    _geometryStaging =
+      jsonObject[ "geometryStaging" ].toString( ).toStdString( );
+    _geometryStore = jsonObject[ "geometryStore" ].toString( ).toStdString( );
+    _geometryArchive = jsonObject[ "geometryArchive" ].toBool( );
+    _geometryCompression = jsonObject[ "geometryCompression" ].toInt( );
+    _csvFingerprint = deserializeFingerprint(
+      jsonObject[ "csvFingerprint" ].toObject( ) );
+    _headerSize = toUInt64( jsonObject[ "headerSize" ] );
+  }
+
+  void BuildManifest::serialize( QJsonObject &jsonObject ) const
+  {
+    QJsonArray sources;
+    for ( const auto& source : _sources )
+    {
+      QJsonObject sourceObject;
+      sourceObject[ "path" ] = QString::fromStdString( source.path );
+      QJsonObject fingerprintObject;
+      serializeFingerprint( source.fingerprint, fingerprintObject );
+      sourceObject[ "fingerprint" ] = fingerprintObject;
+      sourceObject[ "offset" ] = toJsonString( source.offset );
+      sourceObject[ "size" ] = toJsonString( source.size );
+      sources.append( sourceObject );
+    }
+    jsonObject[ "sources" ] = sources;
+    jsonObject[ "schema" ] = _schema;
+    jsonObject[ "join" ] = _join;
+    jsonObject[ "duplicatePolicy" ] = QString::fromStdString( _duplicatePolicy );
+    jsonObject[ "sort" ] = _sort;
+    jsonObject[ "rowFilter" ] = QString::fromStdString( _rowFilter );
+    jsonObject[ "geometrySource" ] = QString::fromStdString( _geometrySource );
+    jsonObject[ "geometryStaging" ] =
+      QString::fromStdString( _geometryStaging );
+    jsonObject[ "geometryStore" ] = QString::fromStdString( _geometryStore );
+    jsonObject[ "geometryArchive" ] = _geometryArchive;
+    jsonObject[ "geometryCompression" ] = _geometryCompression;
+    QJsonObject csvFingerprintObject;
+    serializeFingerprint( _csvFingerprint, csvFingerprintObject );
+    jsonObject[ "csvFingerprint" ] = csvFingerprintObject;
+    jsonObject[ "headerSize" ] = toJsonString( _headerSize );
+  }
+
+}
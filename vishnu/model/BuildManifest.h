@@ -0,0 +1,124 @@
+/*
+ * Vishnu
+ * Copyright (c) 2017-2019 GMRV/URJC.
+ *
+ * Authors: Gonzalo Bayo Martinez <gonzalo.bayo@urjc.es>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef VISHNU_BUILDMANIFEST_H
+#define VISHNU_BUILDMANIFEST_H
+
+#include <QJsonObject>
+
+#include <string>
+#include <vector>
+#include <memory>
+
+#include "../pipeline/FileFingerprint.h"
+
+namespace vishnu
+{
+
+  class BuildManifest;
+  using BuildManifestPtr = std::shared_ptr< BuildManifest >;
+
+  /*
+   * Describes how a dataset was built: its sources with their fingerprints
+   * and the byte range of the result CSV that came from each of them, the
+   * schema (selected properties and property groups), the result CSV
+   * fingerprint and how the geometric data was placed (source folder,
+   * staging mode and store, or packed). Stored next to the dataset JSON to
+   * rebuild it incrementally.
+   */
+  class BuildManifest
+  {
+
+    public:
+
+      struct Source
+      {
+        std::string path;
+        FileFingerprint fingerprint;
+        uint64_t offset = 0;
+        uint64_t size = 0;
+      };
+      using Sources = std::vector< Source >;
+
+      BuildManifest( void );
+      ~BuildManifest( void );
+
+      Sources getSources( void ) const;
+      void setSources( const Sources& sources );
+
+      QJsonObject getSchema( void ) const;
+      void setSchema( const QJsonObject& schema );
+
+      bool getJoin( void ) const;
+      void setJoin( const bool& join );
+
+      std::string getDuplicatePolicy( void ) const;
+      void setDuplicatePolicy( const std::string& duplicatePolicy );
+
+      bool getSort( void ) const;
+      void setSort( const bool& sort );
+
+      std::string getRowFilter( void ) const;
+      void setRowFilter( const std::string& rowFilter );
+
+      std::string getGeometrySource( void ) const;
+      void setGeometrySource( const std::string& geometrySource );
+
+      std::string getGeometryStaging( void ) const;
+      void setGeometryStaging( const std::string& geometryStaging );
+
+      std::string getGeometryStore( void ) const;
+      void setGeometryStore( const std::string& geometryStore );
+
+      bool getGeometryArchive( void ) const;
+      void setGeometryArchive( const bool& geometryArchive );
+
+      int getGeometryCompression( void ) const;
+      void setGeometryCompression( const int& geometryCompression );
+
+      FileFingerprint getCsvFingerprint( void ) const;
+      void setCsvFingerprint( const FileFingerprint& csvFingerprint );
+
+      uint64_t getHeaderSize( void ) const;
+      void setHeaderSize( const uint64_t& headerSize );
+
+      void deserialize( const QJsonObject &jsonObject );
+      void serialize( QJsonObject &jsonObject ) const;
+
+    private:
+
+      Sources _sources;
+      QJsonObject _schema;
+      bool _join;
+      std::string _duplicatePolicy;
+      bool _sort;
+      std::string _rowFilter;
+      std::string _geometrySource;
+      std::string _geometryStaging;
+      std::string _geometryStore;
+      bool _geometryArchive;
+      int _geometryCompression;
+      FileFingerprint _csvFingerprint;
+      uint64_t _headerSize;
+  };
+
+}
+
+#endif
@@ -0,0 +1,404 @@
+/*
+ * Vishnu
+ * Copyright (c) 2017-2019 GMRV/URJC.
+ *
+ * Authors: Gonzalo Bayo Martinez <gonzalo.bayo@urjc.es>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "BuildRecipe.h"
+
+#include <QJsonArray>
+
+#include "../Definitions.hpp"
+#include "../pipeline/DataSetSchema.h"
+
+namespace vishnu
+{
+
+  BuildRecipe::BuildRecipe( void )
+    : _csvFilename( std::string( DEFAULT_DATASET_FILENAME ) + "." + STR_EXT_CSV )
+    , _jsonFilename( std::string( DEFAULT_DATASET_FILENAME ) + "."
+      + STR_EXT_JSON )
+    , _xmlFilename( std::string( DEFAULT_DATASET_FILENAME ) + "." + STR_EXT_XML )
+    , _join( false )
+    , _sparse( false )
+    , _sort( false )
+    , _geometrySync( false )
+    , _geometryHash( false )
+    , _geometryStore( false )
+    , _geometryArchive( false )
+    , _geometryCompression( 0 )
+    , _duplicates( "keepAll" )
+  {
+
+  }
+
+  BuildRecipe::~BuildRecipe( void )
+  {
+
+  }
+
+  std::string BuildRecipe::getName( void ) const
+  {
+    return _name;
+  }
+
+  void BuildRecipe::setName( const std::string& name )
+  {
+    _name = name;
+  }
+
+  std::vector< std::string > BuildRecipe::getInputs( void ) const
+  {
+    return _inputs;
+  }
+
+  void BuildRecipe::setInputs( const std::vector< std::string >& inputs )
+  {
+    _inputs = inputs;
+  }
+
+  BuildRecipe::Properties BuildRecipe::getProperties( void ) const
+  {
+    return _properties;
+  }
+
+  void BuildRecipe::setProperties( const Properties& properties )
+  {
+    _properties = properties;
+  }
+
+  std::string BuildRecipe::getPath( void ) const
+  {
+    return _path;
+  }
+
+  void BuildRecipe::setPath( const std::string& path )
+  {
+    _path = path;
+  }
+
+  std::string BuildRecipe::getCsvFilename( void ) const
+  {
+    return _csvFilename;
+  }
+
+  void BuildRecipe::setCsvFilename( const std::string& csvFilename )
+  {
+    _csvFilename = csvFilename;
+  }
+
+  std::string BuildRecipe::getJsonFilename( void ) const
+  {
+    return _jsonFilename;
+  }
+
+  void BuildRecipe::setJsonFilename( const std::string& jsonFilename )
+  {
+    _jsonFilename = jsonFilename;
+  }
+
+  std::string BuildRecipe::getXmlFilename( void ) const
+  {
+    return _xmlFilename;
+  }
+
+  void BuildRecipe::setXmlFilename( const std::string& xmlFilename )
+  {
+    _xmlFilename = xmlFilename;
+  }
+
+  std::string BuildRecipe::getGeometrySource( void ) const
+  {
+    return _geometrySource;
+  }
+
+  void BuildRecipe::setGeometrySource( const std::string& geometrySource )
+  {
+    _geometrySource = geometrySource;
+  }
+
+  bool BuildRecipe::getJoin( void ) const
+  {
+    return _join;
+  }
+
+  void BuildRecipe::setJoin( const bool& join )
+  {
+    _join = join;
+  }
+
+  bool BuildRecipe::getSparse( void ) const
+  {
+    return _sparse;
+  }
+
+  void BuildRecipe::setSparse( const bool& sparse )
+  {
+    _sparse = sparse;
+  }
+
+  bool BuildRecipe::getSort( void ) const
+  {
+    return _sort;
+  }
+
+  void BuildRecipe::setSort( const bool& sort )
+  {
+    _sort = sort;
+  }
+
+  std::string BuildRecipe::getDuplicates( void ) const
+  {
+    return _duplicates;
+  }
+
+  void BuildRecipe::setDuplicates( const std::string& duplicates )
+  {
+    _duplicates = duplicates;
+  }
+
+  std::string BuildRecipe::getFilter( void ) const
+  {
+    return _filter;
+  }
+
+  void BuildRecipe::setFilter( const std::string& filter )
+  {
+    _filter = filter;
+  }
+
+  std::string BuildRecipe::getGeometryStaging( void ) const
+  {
+    return _geometryStaging;
+  }
+
+  void BuildRecipe::setGeometryStaging( const std::string& geometryStaging )
+  {
+    _geometryStaging = geometryStaging;
+  }
+
+  bool BuildRecipe::getGeometrySync( void ) const
+  {
+    return _geometrySync;
+  }
+
+  void BuildRecipe::setGeometrySync( const bool& geometrySync )
+  {
+    _geometrySync = geometrySync;
+  }
+
+  bool BuildRecipe::getGeometryHash( void ) const
+  {
+    return _geometryHash;
+  }
+
+  void BuildRecipe::setGeometryHash( const bool& geometryHash )
+  {
+    _geometryHash = geometryHash;
+  }
+
+  bool BuildRecipe::getGeometryStore( void ) const
+  {
+    return _geometryStore;
+  }
+
+  void BuildRecipe::setGeometryStore( const bool& geometryStore )
+  {
+    _geometryStore = geometryStore;
+  }
+
+  bool BuildRecipe::getGeometryArchive( void ) const
+  {
+    return _geometryArchive;
+  }
+
+  void BuildRecipe::setGeometryArchive( const bool& geometryArchive )
+  {
+    _geometryArchive = geometryArchive;
+  }
+
+  int BuildRecipe::getGeometryCompression( void ) const
+  {
+    return _geometryCompression;
+  }
+
+  void BuildRecipe::setGeometryCompression( const int& geometryCompression )
+  {
+    _geometryCompression = geometryCompression;
+  }
+
+  vishnucommon::DataSetsPtr BuildRecipe::getDataSets( void ) const
+  {
+    DataSetSchema::Properties properties;
+    for ( const auto& recipeProperty : _properties )
+    {
+      DataSetSchema::Property property;
+      property.name = recipeProperty.name;
+      property.primaryKey = recipeProperty.primaryKey;
+      if ( !recipeProperty.dataCategory.empty( ) )
+      {
+        property.dataCategory =
+          vishnucommon::toDataCategory( recipeProperty.dataCategory );
+      }
+      if ( !recipeProperty.axis.empty( ) )
+      {
+        property.axisType = vishnucommon::toAxisType( recipeProperty.axis );
+      }
+      properties.emplace_back( property );
+    }
+    return DataSetSchema::createResultDataSets( properties );
+  }
+
+  void BuildRecipe::deserialize( const QJsonObject &jsonObject )
+  {
+    _name = jsonObject[ "name" ].toString( ).toStdString( );
+    _inputs.clear( );
+    QJsonArray inputs = jsonObject[ "inputs" ].toArray( );
+    for ( int i = 0; i < inputs.size( ); ++i )
+    {
+      _inputs.emplace_back( inputs.at( i ).toString( ).toStdString( ) );
+    }
+    _properties.clear( );
+    QJsonArray properties = jsonObject[ "properties" ].toArray( );
+    for ( int i = 0; i < properties.size( ); ++i )
+    {
+      QJsonObject propertyObject = properties.at( i ).toObject( );
+      Property property;
+      property.name = propertyObject[ "name" ].toString( ).toStdString( );
+      property.primaryKey = propertyObject[ "primaryKey" ].toBool( );
+      property.dataCategory =
+        propertyObject[ "dataCategory" ].toString( ).toStdString( );
+      property.axis = propertyObject[ "axis" ].toString( ).toStdString( );
+      _properties.emplace_back( property );
+    }
+    _path = jsonObject[ "path" ].toString( ).toStdString( );
+    if ( jsonObject.contains( "csvFilename" ) )
+    {
+      _csvFilename = jsonObject[ "csvFilename" ].toString( ).toStdString( );
+    }
+    if ( jsonObject.contains( "jsonFilename" ) )
+    {
+      _jsonFilename = jsonObject[ "jsonFilename" ].toString( ).toStdString( );
+    }
+    if ( jsonObject.contains( "xmlFilename" ) )
+    {
+      _xmlFilename = jsonObject[ "xmlFilename" ].toString( ).toStdString( );
+    }
+    _geometrySource =
+      jsonObject[ "geometrySource" ].toString( ).toStdString( );
+    _join = jsonObject[ "join" ].toBool( );
+    _sparse = jsonObject[ "sparse" ].toBool( );
+    _sort = jsonObject[ "sort" ].toBool( );
+    if ( jsonObject.contains( "duplicates" ) )
+    {
+      _duplicates = jsonObject[ "duplicates" ].toString( ).toStdString( );
+    }
+    _filter = jsonObject[ "filter" ].toString( ).toStdString( );
+    _geometryStaging =
+      jsonObject[ "geometryStaging" ].toString( ).toStdString( );
+    _geometrySync = jsonObject[ "geometrySync" ].toBool( );
+    _geometryHash = jsonObject[ "geometryHash" ].toBool( );
+    _geometryStore = jsonObject[ "geometryStore" ].toBool( );
+    _geometryArchive = jsonObject[ "geometryArchive" ].toBool( );
+    _geometryCompression = jsonObject[ "geometryCompression" ].toInt( );
+  }
+
+  void BuildRecipe::serialize( QJsonObject &jsonObject ) const
+  {
+    jsonObject[ "name" ] = QString::fromStdString( _name );
+    QJsonArray inputs;
+    for ( const auto& input : _inputs )
+    {
+      inputs.append( QString::fromStdString( input ) );
+    }
+    jsonObject[ "inputs" ] = inputs;
+    QJsonArray properties;
+    for ( const auto& property : _properties )
+    {
+      QJsonObject propertyObject;
+      propertyObject[ "name" ] = QString::fromStdString( property.name );
+      propertyObject[ "primaryKey" ] = property.primaryKey;
+      propertyObject[ "dataCategory" ] =
+        QString::fromStdString( property.dataCategory );
+      propertyObject[ "axis" ] = QString::fromStdString( property.axis );
+      properties.append( propertyObject );
+    }
+    jsonObject[ "properties" ] = properties;
+    jsonObject[ "path" ] = QString::fromStdString( _path );
+    jsonObject[ "csvFilename" ] = QString::fromStdString( _csvFilename );
+    jsonObject[ "jsonFilename" ] = QString::fromStdString( _jsonFilename );
+    jsonObject[ "xmlFilename" ] = QString::fromStdString( _xmlFilename );
+    jsonObject[ "geometrySource" ] = QString::fromStdString( _geometrySource );
+    jsonObject[ "join" ] = _join;
+    jsonObject[ "sparse" ] = _sparse;
+    jsonObject[ "sort" ] = _sort;
+    jsonObject[ "duplicates" ] = QString::fromStdString( _duplicates );
+    jsonObject[ "filter" ] = QString::fromStdString( _filter );
+    jsonObject[ "geometryStaging" ] =
+      QString::fromStdString( _geometryStaging );
+    jsonObject[ "geometrySync" ] = _geometrySync;
+    jsonObject[ "geometryHash" ] = _geometryHash;
+    jsonObject[ "geometryStore" ] = _geometryStore;
+    jsonObject[ "geometryArchive" ] = _geometryArchive;
+    jsonObject[ "geometryCompression" ] = _geometryCompression;
+  }
+
+  BuildRecipes::BuildRecipes( void )
+  {
+
+  }
+
+  BuildRecipes::~BuildRecipes( void )
+  {
+
+  }
+
+  BuildRecipeVector BuildRecipes::getBuildRecipes( void ) const
+  {
+    return _buildRecipes;
+  }
+
+  void BuildRecipes::setBuildRecipes( const BuildRecipeVector& buildRecipes )
+  {
+    _buildRecipes = buildRecipes;
+  }
+
+  void BuildRecipes::deserialize( const QJsonObject &jsonObject )
+  {
+    _buildRecipes.clear( );
+    QJsonArray buildRecipes = jsonObject[ "recipes" ].toArray( );
+    for ( int i = 0; i < buildRecipes.size( ); ++i )
+    {
+      BuildRecipePtr buildRecipe( new BuildRecipe( ) );
+      buildRecipe->deserialize( buildRecipes.at( i ).toObject( ) );
+      _buildRecipes.emplace_back( buildRecipe );
+    }
+  }
+
+  void BuildRecipes::serialize( QJsonObject &jsonObject ) const
+  {
+    QJsonArray buildRecipes;
+    for ( const auto& buildRecipe : _buildRecipes )
+    {
+      QJsonObject buildRecipeObject;
+      buildRecipe->serialize( buildRecipeObject );
+      buildRecipes.append( buildRecipeObject );
+    }
+    jsonObject[ "recipes" ] = buildRecipes;
+  }
+
+}
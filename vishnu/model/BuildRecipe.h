@@ -0,0 +1,178 @@
+/*
+ * Vishnu
+ * Copyright (c) 2017-2019 GMRV/URJC.
+ *
+ * Authors: Gonzalo Bayo Martinez <gonzalo.bayo@urjc.es>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef VISHNU_BUILDRECIPE_H
+#define VISHNU_BUILDRECIPE_H
+
+#include <QJsonObject>
+
+#include <string>
+#include <vector>
+#include <memory>
+
+#include <vishnucommon/vishnucommon.h>
+
+namespace vishnu
+{
+
+  class BuildRecipe;
+  using BuildRecipePtr = std::shared_ptr< BuildRecipe >;
+  using BuildRecipeVector = std::vector< BuildRecipePtr >;
+
+  /*
+   * Everything the dataset window asks for to build a dataset: input files,
+   * used properties with their primary key flag, data category and axis,
+   * output paths, join, sparse and sort modes, row filter and geometry
+   * staging and sync. Used to build datasets without a display.
+   */
+  class BuildRecipe
+  {
+
+    public:
+
+      struct Property
+      {
+        std::string name;
+        bool primaryKey = false;
+        std::string dataCategory;
+        std::string axis;
+      };
+      using Properties = std::vector< Property >;
+
+      BuildRecipe( void );
+      ~BuildRecipe( void );
+
+      std::string getName( void ) const;
+      void setName( const std::string& name );
+
+      std::vector< std::string > getInputs( void ) const;
+      void setInputs( const std::vector< std::string >& inputs );
+
+      Properties getProperties( void ) const;
+      void setProperties( const Properties& properties );
+
+      std::string getPath( void ) const;
+      void setPath( const std::string& path );
+
+      std::string getCsvFilename( void ) const;
+      void setCsvFilename( const std::string& csvFilename );
+
+      std::string getJsonFilename( void ) const;
+      void setJsonFilename( const std::string& jsonFilename );
+
+      std::string getXmlFilename( void ) const;
+      void setXmlFilename( const std::string& xmlFilename );
+
+      std::string getGeometrySource( void ) const;
+      void setGeometrySource( const std::string& geometrySource );
+
+      bool getJoin( void ) const;
+      void setJoin( const bool& join );
+
+      bool getSparse( void ) const;
+      void setSparse( const bool& sparse );
+
+      bool getSort( void ) const;
+      void setSort( const bool& sort );
+
+      //keepAll, keepFirst, keepLast or fail (see DuplicateFilter)
+      std::string getDuplicates( void ) const;
+      void setDuplicates( const std::string& duplicates );
+
+      //Expression of the rows to keep, see RowFilter
+      std::string getFilter( void ) const;
+      void setFilter( const std::string& filter );
+
+      //copy, hardLink, reflink or symlink (see GeometryStager)
+      std::string getGeometryStaging( void ) const;
+      void setGeometryStaging( const std::string& geometryStaging );
+
+      bool getGeometrySync( void ) const;
+      void setGeometrySync( const bool& geometrySync );
+
+      bool getGeometryHash( void ) const;
+      void setGeometryHash( const bool& geometryHash );
+
+      //Stage geometry through the shared geometry store (see GeometryStore)
+      bool getGeometryStore( void ) const;
+      void setGeometryStore( const bool& geometryStore );
+
+      //Pack geometry in one archive (see GeometryArchive)
+      bool getGeometryArchive( void ) const;
+      void setGeometryArchive( const bool& geometryArchive );
+
+      //zlib level of archive entries, 0 to store them as they are
+      int getGeometryCompression( void ) const;
+      void setGeometryCompression( const int& geometryCompression );
+
+      //Result schema, see DataSetSchema::createResultDataSets
+      vishnucommon::DataSetsPtr getDataSets( void ) const;
+
+      void deserialize( const QJsonObject &jsonObject );
+      void serialize( QJsonObject &jsonObject ) const;
+
+    private:
+
+      std::string _name;
+      std::vector< std::string > _inputs;
+      Properties _properties;
+      std::string _path;
+      std::string _csvFilename;
+      std::string _jsonFilename;
+      std::string _xmlFilename;
+      std::string _geometrySource;
+      bool _join;
+      bool _sparse;
+      bool _sort;
+      std::string _duplicates;
+      std::string _filter;
+      std::string _geometryStaging;
+      bool _geometrySync;
+      bool _geometryHash;
+      bool _geometryStore;
+      bool _geometryArchive;
+      int _geometryCompression;
+  };
+
+  class BuildRecipes;
+  using BuildRecipesPtr = std::shared_ptr< BuildRecipes >;
+
+  class BuildRecipes
+  {
+
+    public:
+
+      BuildRecipes( void );
+      ~BuildRecipes( void );
+
+      BuildRecipeVector getBuildRecipes( void ) const;
+      void setBuildRecipes( const BuildRecipeVector& buildRecipes );
+
+      void deserialize( const QJsonObject &jsonObject );
+      void serialize( QJsonObject &jsonObject ) const;
+
+    private:
+
+      BuildRecipeVector _buildRecipes;
+  };
+
+}
+
+#endif
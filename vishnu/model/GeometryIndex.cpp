@@ -0,0 +1,87 @@
+/*
+ * Vishnu
+ * Copyright (c) 2017-2019 GMRV/URJC.
+ *
+ * Authors: Gonzalo Bayo Martinez <gonzalo.bayo@urjc.es>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "GeometryIndex.h"
+
+#include <QJsonArray>
+
+namespace vishnu
+{
+
+  GeometryIndex::GeometryIndex( void )
+  {
+
+  }
+
+  GeometryIndex::~GeometryIndex( void )
+  {
+
+  }
+
+  std::string GeometryIndex::getStore( void ) const
+  {
+    return _store;
+  }
+
+  void GeometryIndex::setStore( const std::string& store )
+  {
+    _store = store;
+  }
+
+  GeometryIndex::Files GeometryIndex::getFiles( void ) const
+  {
+    return _files;
+  }
+
+  void GeometryIndex::setFiles( const Files& files )
+  {
+    _files = files;
+  }
+
+  void GeometryIndex::deserialize( const QJsonObject &jsonObject )
+  {
+    _store = jsonObject[ "store" ].toString( ).toStdString( );
+    _files.clear( );
+    QJsonArray files = jsonObject[ "files" ].toArray( );
+    for ( int i = 0; i < files.size( ); ++i )
+    {
+      QJsonObject fileObject = files.at( i ).toObject( );
+      File file;
+      file.path = fileObject[ "path" ].toString( ).toStdString( );
+      file.object = fileObject[ "object" ].toString( ).toStdString( );
+      _files.emplace_back( file );
+    }
+  }
+
+  void GeometryIndex::serialize( QJsonObject &jsonObject ) const
+  {
+    jsonObject[ "store" ] = QString::fromStdString( _store );
+    QJsonArray files;
+    for ( const auto& file : _files )
+    {
+      QJsonObject fileObject;
+      fileObject[ "path" ] = QString::fromStdString( file.path );
+      fileObject[ "object" ] = QString::fromStdString( file.object );
+      files.append( fileObject );
+    }
+    jsonObject[ "files" ] = files;
+  }
+
+}
@@ -0,0 +1,74 @@
+/*
+ * Vishnu
+ * Copyright (c) 2017-2019 GMRV/URJC.
+ *
+ * Authors: Gonzalo Bayo Martinez <gonzalo.bayo@urjc.es>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef VISHNU_GEOMETRYINDEX_H
+#define VISHNU_GEOMETRYINDEX_H
+
+#include <QJsonObject>
+
+#include <string>
+#include <vector>
+#include <memory>
+
+namespace vishnu
+{
+
+  class GeometryIndex;
+  using GeometryIndexPtr = std::shared_ptr< GeometryIndex >;
+
+  /*
+   * Maps the geometry files of a dataset to the objects of the shared
+   * geometry store they were staged from. Stored next to the geometric
+   * data folder.
+   */
+  class GeometryIndex
+  {
+
+    public:
+
+      struct File
+      {
+        //Relative to the geometric data folder
+        std::string path;
+        std::string object;
+      };
+      using Files = std::vector< File >;
+
+      GeometryIndex( void );
+      ~GeometryIndex( void );
+
+      std::string getStore( void ) const;
+      void setStore( const std::string& store );
+
+      Files getFiles( void ) const;
+      void setFiles( const Files& files );
+
+      void deserialize( const QJsonObject &jsonObject );
+      void serialize( QJsonObject &jsonObject ) const;
+
+    private:
+
+      std::string _store;
+      Files _files;
+  };
+
+}
+
+#endif
@@ -0,0 +1,116 @@
+/*
+ * Vishnu
+ * Copyright (c) 2017-2019 GMRV/URJC.
+ *
+ * Authors: Gonzalo Bayo Martinez <gonzalo.bayo@urjc.es>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "GeometryManifest.h"
+
+#include <QJsonArray>
+
+#include "ManifestJson.h"
+
+namespace vishnu
+{
+
+  GeometryManifest::GeometryManifest( void )
+  {
+
+  }
+
+  GeometryManifest::~GeometryManifest( void )
+  {
+
+  }
+
+  std::string GeometryManifest::getSource( void ) const
+  {
+    return _source;
+  }
+
+  void GeometryManifest::setSource( const std::string& source )
+  {
+    _source = source;
+  }
+
+  std::string GeometryManifest::getMode( void ) const
+  {
+    return _mode;
+  }
+
+  void GeometryManifest::setMode( const std::string& mode )
+  {
+    _mode = mode;
+  }
+
+  std::string GeometryManifest::getStore( void ) const
+  {
+    return _store;
+  }
+
+  void GeometryManifest::setStore( const std::string& store )
+  {
+    _store = store;
+  }
+
+  GeometryManifest::Files GeometryManifest::getFiles( void ) const
+  {
+    return _files;
+  }
+
+  void GeometryManifest::setFiles( const Files& files )
+  {
+    _files = files;
+  }
+
+  void GeometryManifest::deserialize( const QJsonObject &jsonObject )
+  {
+    _source = jsonObject[ "source" ].toString( ).toStdString( );
+    _mode = jsonObject[ "mode" ].toString( ).toStdString( );
+    _store = jsonObject[ "store" ].toString( ).toStdString( );
+    _files.clear( );
+    QJsonArray files = jsonObject[ "files" ].toArray( );
+    for ( int i = 0; i < files.size( ); ++i )
+    {
+      QJsonObject fileObject = files.at( i ).toObject( );
+      File file;
+      file.path = fileObject[ "path" ].toString( ).toStdString( );
+      file.fingerprint = deserializeFingerprint(
+        fileObject[ "fingerprint" ].toObject( ) );
+      _files.emplace_back( file );
+    }
+  }
+
+  void GeometryManifest::serialize( QJsonObject &jsonObject ) const
+  {
+    jsonObject[ "source" ] = QString::fromStdString( _source );
+    jsonObject[ "mode" ] = QString::fromStdString( _mode );
+    jsonObject[ "store" ] = QString::fromStdString( _store );
+    QJsonArray files;
+    for ( const auto& file : _files )
+    {
+      QJsonObject fileObject;
+      fileObject[ "path" ] = QString::fromStdString( file.path );
+      QJsonObject fingerprintObject;
+      serializeFingerprint( file.fingerprint, fingerprintObject );
+      fileObject[ "fingerprint" ] = fingerprintObject;
+      files.append( fileObject );
+    }
+    jsonObject[ "files" ] = files;
+  }
+
+}
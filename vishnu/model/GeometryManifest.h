@@ -0,0 +1,85 @@
+/*
+ * Vishnu
+ * Copyright (c) 2017-2019 GMRV/URJC.
+ *
+ * Authors: Gonzalo Bayo Martinez <gonzalo.bayo@urjc.es>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef VISHNU_GEOMETRYMANIFEST_H
+#define VISHNU_GEOMETRYMANIFEST_H
+
+#include <QJsonObject>
+
+#include <string>
+#include <vector>
+#include <memory>
+
+#include "../pipeline/FileFingerprint.h"
+
+namespace vishnu
+{
+
+  class GeometryManifest;
+  using GeometryManifestPtr = std::shared_ptr< GeometryManifest >;
+
+  /*
+   * Describes the geometric data staged into a dataset: the folder it came
+   * from, the staging mode, the geometry store, if any, and the fingerprint
+   * every source file had when it was staged. Stored next to the geometric
+   * data folder, so the next sync only compares the sources with it.
+   */
+  class GeometryManifest
+  {
+
+    public:
+
+      struct File
+      {
+        //Relative to the source folder
+        std::string path;
+        FileFingerprint fingerprint;
+      };
+      using Files = std::vector< File >;
+
+      GeometryManifest( void );
+      ~GeometryManifest( void );
+
+      std::string getSource( void ) const;
+      void setSource( const std::string& source );
+
+      std::string getMode( void ) const;
+      void setMode( const std::string& mode );
+
+      std::string getStore( void ) const;
+      void setStore( const std::string& store );
+
+      Files getFiles( void ) const;
+      void setFiles( const Files& files );
+
+      void deserialize( const QJsonObject &jsonObject );
+      void serialize( QJsonObject &jsonObject ) const;
+
+    private:
+
+      std::string _source;
+      std::string _mode;
+      std::string _store;
+      Files _files;
+  };
+
+}
+
+#endif
@@ -0,0 +1,66 @@
+/*
+ * Vishnu
+ * Copyright (c) 2017-2019 GMRV/URJC.
+ *
+ * Authors: Gonzalo Bayo Martinez <gonzalo.bayo@urjc.es>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef VISHNU_MANIFESTJSON_H
+#define VISHNU_MANIFESTJSON_H
+
+#include <QJsonObject>
+#include <QJsonValue>
+#include <QString>
+
+#include "../pipeline/FileFingerprint.h"
+
+namespace vishnu
+{
+
+  //64 bit values are stored as strings, JSON numbers are doubles
+  inline QString toJsonString( const uint64_t& value )
+  {
+    return QString::number( static_cast< qulonglong >( value ) );
+  }
+
+  inline uint64_t toUInt64( const QJsonValue& value )
+  {
+    return static_cast< uint64_t >( value.toString( ).toULongLong( ) );
+  }
+
+  inline void serializeFingerprint( const FileFingerprint& fingerprint,
+    QJsonObject& jsonObject )
+  {
+    jsonObject[ "size" ] = toJsonString( fingerprint.size );
+    jsonObject[ "modificationTime" ] = toJsonString(
+      static_cast< uint64_t >( fingerprint.modificationTime ) );
+    jsonObject[ "contentHash" ] = toJsonString( fingerprint.contentHash );
+  }
+
+  inline FileFingerprint deserializeFingerprint(
+    const QJsonObject& jsonObject )
+  {
+    FileFingerprint fingerprint;
+    fingerprint.size = toUInt64( jsonObject[ "size" ] );
+    fingerprint.modificationTime = static_cast< int64_t >(
+      toUInt64( jsonObject[ "modificationTime" ] ) );
+    fingerprint.contentHash = toUInt64( jsonObject[ "contentHash" ] );
+    return fingerprint;
+  }
+
+}
+
+#endif
@@ -0,0 +1,125 @@
+/*
+ * Vishnu
+ * Copyright (c) 2017-2019 GMRV/URJC.
+ *
+ * Authors: Gonzalo Bayo Martinez <gonzalo.bayo@urjc.es>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "Arena.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+
+namespace vishnu
+{
+
+  namespace
+  {
+    //Every allocation is aligned for any fundamental type
+    const size_t ALIGNMENT = alignof( std::max_align_t );
+
+    size_t align( const size_t& size )
+    {
+      return ( size + ALIGNMENT - 1 ) & ~( ALIGNMENT - 1 );
+    }
+  }
+
+  Arena::Arena( const size_t& blockSize )
+    : _blockSize( align( std::max( blockSize, ALIGNMENT ) ) )
+    , _block( 0 )
+    , _offset( 0 )
+    , _bytes( 0 )
+    , _allocations( 0 )
+    , _heapAllocations( 0 )
+    , _largeCapacity( 0 )
+  {
+
+  }
+
+  Arena::~Arena( void )
+  {
+
+  }
+
+  char* Arena::allocate( const size_t& size )
+  {
+    size_t alignedSize = align( std::max( size, static_cast< size_t >( 1 ) ) );
+    _bytes += size;
+    ++_allocations;
+
+    if ( alignedSize > _blockSize )
+    {
+      _largeBlocks.emplace_back( new char[ alignedSize ] );
+      _largeCapacity += alignedSize;
+      ++_heapAllocations;
+      return _largeBlocks.back( ).get( );
+    }
+
+    if ( _block < _blocks.size( ) && _offset + alignedSize > _blockSize )
+    {
+      ++_block;
+      _offset = 0;
+    }
+    if ( _block == _blocks.size( ) )
+    {
+      _blocks.emplace_back( new char[ _blockSize ] );
+      ++_heapAllocations;
+    }
+    char* data = _blocks[ _block ].get( ) + _offset;
+    _offset += alignedSize;
+    return data;
+  }
+
+  StringView Arena::copy( const StringView& data )
+  {
+    char* copied = allocate( data.size );
+    std::memcpy( copied, data.data, data.size );
+    return StringView( copied, data.size );
+  }
+
+  void Arena::reset( void )
+  {
+    _largeBlocks.clear( );
+    _largeCapacity = 0;
+    _block = 0;
+    _offset = 0;
+    _bytes = 0;
+    _allocations = 0;
+    _heapAllocations = 0;
+  }
+
+  size_t Arena::getBytes( void ) const
+  {
+    return _bytes;
+  }
+
+  size_t Arena::getAllocations( void ) const
+  {
+    return _allocations;
+  }
+
+  size_t Arena::getHeapAllocations( void ) const
+  {
+    return _heapAllocations;
+  }
+
+  size_t Arena::getCapacity( void ) const
+  {
+    return _blocks.size( ) * _blockSize + _largeCapacity;
+  }
+
+}
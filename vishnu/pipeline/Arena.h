@@ -0,0 +1,88 @@
+/*
+ * Vishnu
+ * Copyright (c) 2017-2019 GMRV/URJC.
+ *
+ * Authors: Gonzalo Bayo Martinez <gonzalo.bayo@urjc.es>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef VISHNU_ARENA_H
+#define VISHNU_ARENA_H
+
+#include <string>
+#include <vector>
+#include <memory>
+
+#include "StringView.h"
+#include "../Definitions.hpp"
+
+namespace vishnu
+{
+
+  class Arena;
+  using ArenaPtr = std::shared_ptr< Arena >;
+
+  /*
+   * Bump allocator for parse state that is freed all at once, like the rows
+   * of a batch. Memory is taken from blocks that are kept across resets, so
+   * once warmed up a batch does no heap allocation. Allocations larger than
+   * a block get a block of their own, released on reset.
+   */
+  class Arena
+  {
+
+    public:
+
+      explicit Arena( const size_t& blockSize = ARENA_BLOCK_SIZE );
+      ~Arena( void );
+
+      Arena( const Arena& ) = delete;
+      Arena& operator=( const Arena& ) = delete;
+
+      //Uninitialized memory, valid until the next reset
+      char* allocate( const size_t& size );
+
+      //Copy of data in the arena
+      StringView copy( const StringView& data );
+
+      //Forgets every allocation, keeping the blocks for the next batch
+      void reset( void );
+
+      //Bytes and allocations handed out since the last reset
+      size_t getBytes( void ) const;
+      size_t getAllocations( void ) const;
+
+      //Blocks taken from the heap since the last reset
+      size_t getHeapAllocations( void ) const;
+
+      //Bytes held in blocks
+      size_t getCapacity( void ) const;
+
+    private:
+
+      size_t _blockSize;
+      std::vector< std::unique_ptr< char[ ] > > _blocks;
+      std::vector< std::unique_ptr< char[ ] > > _largeBlocks;
+      size_t _block;
+      size_t _offset;
+      size_t _bytes;
+      size_t _allocations;
+      size_t _heapAllocations;
+      size_t _largeCapacity;
+  };
+
+}
+
+#endif
@@ -0,0 +1,155 @@
+/*
+ * Vishnu
+ * Copyright (c) 2017-2019 GMRV/URJC.
+ *
+ * Authors: Gonzalo Bayo Martinez <gonzalo.bayo@urjc.es>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef VISHNU_BINARYIO_H
+#define VISHNU_BINARYIO_H
+
+#include <cstdint>
+#include <istream>
+#include <ostream>
+#include <string>
+
+namespace vishnu
+{
+
+  //Little endian integers for the binary files written by the pipeline
+
+  inline bool writeUInt32( std::ostream& stream, const uint32_t& value )
+  {
+    unsigned char bytes[ 4 ];
+    for ( unsigned int i = 0; i < 4; ++i )
+    {
+      bytes[ i ] = static_cast< unsigned char >( value >> ( 8 * i ) );
+    }
+    return static_cast< bool >(
+      stream.write( reinterpret_cast< const char* >( bytes ), 4 ) );
+  }
+
+  inline bool writeUInt64( std::ostream& stream, const uint64_t& value )
+  {
+    unsigned char bytes[ 8 ];
+    for ( unsigned int i = 0; i < 8; ++i )
+    {
+      bytes[ i ] = static_cast< unsigned char >( value >> ( 8 * i ) );
+    }
+    return static_cast< bool >(
+      stream.write( reinterpret_cast< const char* >( bytes ), 8 ) );
+  }
+
+  inline void encodeUInt32( char* data, const uint32_t& value )
+  {
+    for ( unsigned int i = 0; i < 4; ++i )
+    {
+      data[ i ] = static_cast< char >( ( value >> ( 8 * i ) ) & 0xFF );
+    }
+  }
+
+  inline void encodeUInt64( char* data, const uint64_t& value )
+  {
+    for ( unsigned int i = 0; i < 8; ++i )
+    {
+      data[ i ] = static_cast< char >( ( value >> ( 8 * i ) ) & 0xFF );
+    }
+  }
+
+  inline void appendUInt32( std::string& data, const uint32_t& value )
+  {
+    char bytes[ 4 ];
+    encodeUInt32( bytes, value );
+    data.append( bytes, 4 );
+  }
+
+  //Variable length integers: 7 bits per byte, lowest first, with the high
+  //bit set on every byte but the last
+
+  inline void appendVarUInt64( std::string& data, uint64_t value )
+  {
+    while ( value >= 0x80 )
+    {
+      data.push_back( static_cast< char >( ( value & 0x7F ) | 0x80 ) );
+      value >>= 7;
+    }
+    data.push_back( static_cast< char >( value ) );
+  }
+
+  //Moves data past the integer, false if it is truncated or too long
+  inline bool decodeVarUInt64( const char*& data, const char* end,
+    uint64_t& value )
+  {
+    value = 0;
+    for ( unsigned int shift = 0; shift < 64 && data < end; shift += 7 )
+    {
+      unsigned char byte = static_cast< unsigned char >( *data++ );
+      value |= static_cast< uint64_t >( byte & 0x7F ) << shift;
+      if ( ( byte & 0x80 ) == 0 )
+      {
+        return true;
+      }
+    }
+    return false;
+  }
+
+  inline uint32_t decodeUInt32( const char* data )
+  {
+    const unsigned char* bytes = reinterpret_cast< const unsigned char* >( data );
+    uint32_t value = 0;
+    for ( unsigned int i = 0; i < 4; ++i )
+    {
+      value |= static_cast< uint32_t >( bytes[ i ] ) << ( 8 * i );
+    }
+    return value;
+  }
+
+  inline uint64_t decodeUInt64( const char* data )
+  {
+    const unsigned char* bytes = reinterpret_cast< const unsigned char* >( data );
+    uint64_t value = 0;
+    for ( unsigned int i = 0; i < 8; ++i )
+    {
+      value |= static_cast< uint64_t >( bytes[ i ] ) << ( 8 * i );
+    }
+    return value;
+  }
+
+  inline bool readUInt32( std::istream& stream, uint32_t& value )
+  {
+    char bytes[ 4 ];
+    if ( !stream.read( bytes, 4 ) )
+    {
+      return false;
+    }
+    value = decodeUInt32( bytes );
+    return true;
+  }
+
+  inline bool readUInt64( std::istream& stream, uint64_t& value )
+  {
+    char bytes[ 8 ];
+    if ( !stream.read( bytes, 8 ) )
+    {
+      return false;
+    }
+    value = decodeUInt64( bytes );
+    return true;
+  }
+
+}
+
+#endif
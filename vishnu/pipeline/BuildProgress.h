@@ -0,0 +1,203 @@
+/*
+ * Vishnu
+ * Copyright (c) 2017-2019 GMRV/URJC.
+ *
+ * Authors: Gonzalo Bayo Martinez <gonzalo.bayo@urjc.es>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef VISHNU_BUILDPROGRESS_H
+#define VISHNU_BUILDPROGRESS_H
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+
+namespace vishnu
+{
+
+  class BuildProgress;
+  using BuildProgressPtr = std::shared_ptr< BuildProgress >;
+
+  /*
+   * Progress and cancellation state of a dataset build, shared between the
+   * thread running the build and the one showing it. Done and total are
+   * bytes of the current stage. Stage times are written by the building
+   * thread only, so read them once the build finished. Stages handling
+   * whole files, like geometry staging, also count files.
+   */
+  class BuildProgress
+  {
+
+    public:
+
+      enum class Stage
+      {
+        Idle,
+        CSV,
+        Sort,
+        JSON,
+        XML,
+        Geometry,
+        Finished
+      };
+
+      BuildProgress( void )
+        : _stage( Stage::Idle )
+        , _done( 0 )
+        , _total( 0 )
+        , _rows( 0 )
+        , _files( 0 )
+        , _totalFiles( 0 )
+        , _batches( 0 )
+        , _batchBytes( 0 )
+        , _batchAllocations( 0 )
+        , _canceled( false )
+        , _stageStart( std::chrono::steady_clock::now( ) )
+      {
+        for ( auto& stageTime : _stageTimes )
+        {
+          stageTime = 0.0;
+        }
+      }
+
+      void setStage( const Stage& stage, const size_t& total )
+      {
+        std::chrono::steady_clock::time_point now =
+          std::chrono::steady_clock::now( );
+        _stageTimes[ static_cast< size_t >( _stage.load( ) ) ] +=
+          std::chrono::duration< double >( now - _stageStart ).count( );
+        _stageStart = now;
+        _done = 0;
+        _total = total;
+        _files = 0;
+        _totalFiles = 0;
+        _stage = stage;
+      }
+
+      void setTotal( const size_t& total )
+      {
+        _total = total;
+      }
+
+      Stage getStage( void ) const
+      {
+        return _stage;
+      }
+
+      void addDone( const size_t& done )
+      {
+        _done += done;
+      }
+
+      size_t getDone( void ) const
+      {
+        return _done;
+      }
+
+      size_t getTotal( void ) const
+      {
+        return _total;
+      }
+
+      void addRows( const size_t& rows )
+      {
+        _rows += rows;
+      }
+
+      size_t getRows( void ) const
+      {
+        return _rows;
+      }
+
+      void setTotalFiles( const size_t& totalFiles )
+      {
+        _totalFiles = totalFiles;
+      }
+
+      void addFiles( const size_t& files )
+      {
+        _files += files;
+      }
+
+      size_t getFiles( void ) const
+      {
+        return _files;
+      }
+
+      size_t getTotalFiles( void ) const
+      {
+        return _totalFiles;
+      }
+
+      //Parse batches (merged blocks, join indexes, sort runs): bytes held and
+      //heap allocations needed, zero once their buffers are reused
+      void addBatch( const size_t& bytes, const size_t& allocations )
+      {
+        ++_batches;
+        _batchBytes += bytes;
+        _batchAllocations += allocations;
+      }
+
+      size_t getBatches( void ) const
+      {
+        return _batches;
+      }
+
+      size_t getBatchBytes( void ) const
+      {
+        return _batchBytes;
+      }
+
+      size_t getBatchAllocations( void ) const
+      {
+        return _batchAllocations;
+      }
+
+      void cancel( void )
+      {
+        _canceled = true;
+      }
+
+      bool isCanceled( void ) const
+      {
+        return _canceled;
+      }
+
+      //Seconds spent in a stage
+      double getStageTime( const Stage& stage ) const
+      {
+        return _stageTimes[ static_cast< size_t >( stage ) ];
+      }
+
+    private:
+
+      std::atomic< Stage > _stage;
+      std::atomic< size_t > _done;
+      std::atomic< size_t > _total;
+      std::atomic< size_t > _rows;
+      std::atomic< size_t > _files;
+      std::atomic< size_t > _totalFiles;
+      std::atomic< size_t > _batches;
+      std::atomic< size_t > _batchBytes;
+      std::atomic< size_t > _batchAllocations;
+      std::atomic< bool > _canceled;
+      std::chrono::steady_clock::time_point _stageStart;
+      double _stageTimes[ static_cast< size_t >( Stage::Finished ) + 1 ];
+  };
+
+}
+
+#endif
@@ -0,0 +1,351 @@
+/*
+ * Vishnu
+ * Copyright (c) 2017-2019 GMRV/URJC.
+ *
+ * Authors: Gonzalo Bayo Martinez <gonzalo.bayo@urjc.es>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "CacheReader.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include "BinaryIO.h"
+#include "../Definitions.hpp"
+
+namespace vishnu
+{
+
+  CacheReader::CacheReader( const std::string& cachePath )
+    : _file( cachePath )
+    , _open( false )
+    , _rows( 0 )
+    , _row( 0 )
+    , _projected( false )
+  {
+    _open = _file.isOpen( ) && parseHeader( );
+  }
+
+  CacheReader::~CacheReader( void )
+  {
+
+  }
+
+  bool CacheReader::isOpen( void ) const
+  {
+    return _open;
+  }
+
+  bool CacheReader::readHeaders( std::vector< std::string >& headers )
+  {
+    if ( !_open || _headers.empty( ) )
+    {
+      return false;
+    }
+    headers = _headers;
+    return true;
+  }
+
+  void CacheReader::setProjection( const std::vector< int >& columns,
+    const std::string& missingValue )
+  {
+    _projected = true;
+    _projection = columns;
+    _missingValue = missingValue;
+
+    _usedColumns.clear( );
+    for ( const auto& column : columns )
+    {
+      if ( column >= 0 && static_cast< size_t >( column ) < _headers.size( ) )
+      {
+        _usedColumns.emplace_back( static_cast< size_t >( column ) );
+      }
+    }
+    std::sort( _usedColumns.begin( ), _usedColumns.end( ) );
+    _usedColumns.erase( std::unique( _usedColumns.begin( ),
+      _usedColumns.end( ) ), _usedColumns.end( ) );
+  }
+
+  bool CacheReader::readRecord( std::vector< StringView >& fields )
+  {
+    if ( !_open || _row >= _rows )
+    {
+      return false;
+    }
+
+    if ( !_projected )
+    {
+      //Like a short CSV record, fields stop at the first absent one
+      fields.clear( );
+      for ( size_t column = 0; column < _headers.size( ); ++column )
+      {
+        if ( !readValue( column ) )
+        {
+          return false;
+        }
+        if ( _present[ column ] && fields.size( ) == column )
+        {
+          fields.emplace_back( _values[ column ] );
+        }
+      }
+      ++_row;
+      return true;
+    }
+
+    for ( const auto& column : _usedColumns )
+    {
+      if ( !readValue( column ) )
+      {
+        return false;
+      }
+    }
+    fields.resize( _projection.size( ) );
+    for ( size_t i = 0; i < _projection.size( ); ++i )
+    {
+      int column = _projection[ i ];
+      if ( column >= 0 && static_cast< size_t >( column ) < _headers.size( )
+        && _present[ column ] )
+      {
+        fields[ i ] = _values[ column ];
+      }
+      else
+      {
+        fields[ i ] = StringView( _missingValue );
+      }
+    }
+    ++_row;
+    return true;
+  }
+
+  size_t CacheReader::getPosition( void ) const
+  {
+    //Reported relative to the source size
+    return ( _rows == 0 ) ? 0 : static_cast< size_t >(
+      static_cast< double >( _row ) / _rows * _sourceFingerprint.size );
+  }
+
+  size_t CacheReader::getSize( void ) const
+  {
+    return static_cast< size_t >( _sourceFingerprint.size );
+  }
+
+  FileFingerprint CacheReader::getSourceFingerprint( void ) const
+  {
+    return _sourceFingerprint;
+  }
+
+  size_t CacheReader::getRows( void ) const
+  {
+    return static_cast< size_t >( _rows );
+  }
+
+  bool CacheReader::parseHeader( void )
+  {
+    const char* data = _file.getData( );
+    const char* end = data + _file.getSize( );
+    if ( data == nullptr || end - data < SOURCE_CACHE_HEADER_SIZE
+      || std::memcmp( data, SOURCE_CACHE_MAGIC, 8 ) != 0
+      || decodeUInt32( data + 8 ) != SOURCE_CACHE_VERSION )
+    {
+      return false;
+    }
+
+    uint32_t columns = decodeUInt32( data + 12 );
+    _rows = decodeUInt64( data + 16 );
+    _sourceFingerprint.size = decodeUInt64( data + 24 );
+    _sourceFingerprint.modificationTime =
+      static_cast< int64_t >( decodeUInt64( data + 32 ) );
+    _sourceFingerprint.contentHash = decodeUInt64( data + 40 );
+
+    const char* current = data + SOURCE_CACHE_HEADER_SIZE;
+    for ( uint32_t column = 0; column < columns; ++column )
+    {
+      if ( end - current < 4 )
+      {
+        return false;
+      }
+      uint32_t length = decodeUInt32( current );
+      current += 4;
+      if ( static_cast< size_t >( end - current ) < length )
+      {
+        return false;
+      }
+      _headers.emplace_back( current, length );
+      current += length;
+    }
+
+    //Column table: offset and size of every column block
+    for ( uint32_t column = 0; column < columns; ++column )
+    {
+      if ( end - current < 16 )
+      {
+        return false;
+      }
+      uint64_t offset = decodeUInt64( current );
+      uint64_t size = decodeUInt64( current + 8 );
+      current += 16;
+      if ( offset > _file.getSize( ) || size > _file.getSize( ) - offset )
+      {
+        return false;
+      }
+      Column cacheColumn;
+      cacheColumn.cursor = data + offset;
+      cacheColumn.end = data + offset + size;
+      cacheColumn.values = 0;
+      cacheColumn.encoding = Encoding::Plain;
+      _columns.emplace_back( cacheColumn );
+    }
+
+    _values.resize( columns );
+    _present.resize( columns, false );
+    return true;
+  }
+
+  bool CacheReader::readValue( const size_t& column )
+  {
+    Column& cacheColumn = _columns[ column ];
+    uint64_t tag;
+    if ( ( cacheColumn.values == 0 && !readSegment( cacheColumn ) )
+      || !decodeVarUInt64( cacheColumn.cursor, cacheColumn.end, tag ) )
+    {
+      _open = false;
+      return false;
+    }
+    --cacheColumn.values;
+
+    //Every value starts with a tag, 0 for absent fields
+    if ( tag == 0 )
+    {
+      _present[ column ] = false;
+      return true;
+    }
+    switch( cacheColumn.encoding )
+    {
+      case Encoding::Numeric:
+      {
+        uint64_t zigzag;
+        if ( tag - 1 > SOURCE_CACHE_MAX_DIGITS || !decodeVarUInt64(
+          cacheColumn.cursor, cacheColumn.end, zigzag ) )
+        {
+          _open = false;
+          return false;
+        }
+        int64_t mantissa = static_cast< int64_t >( zigzag >> 1 )
+          ^ -static_cast< int64_t >( zigzag & 1 );
+        formatNumber( mantissa, tag - 1, cacheColumn.text );
+        _values[ column ] = StringView( cacheColumn.text );
+        break;
+      }
+      case Encoding::Dictionary:
+        if ( tag - 1 >= cacheColumn.dictionary.size( ) )
+        {
+          _open = false;
+          return false;
+        }
+        _values[ column ] = cacheColumn.dictionary[ tag - 1 ];
+        break;
+      default:
+        if ( static_cast< uint64_t >( cacheColumn.end - cacheColumn.cursor )
+          < tag - 1 )
+        {
+          _open = false;
+          return false;
+        }
+        _values[ column ] = StringView( cacheColumn.cursor, tag - 1 );
+        cacheColumn.cursor += tag - 1;
+        break;
+    }
+    _present[ column ] = true;
+    return true;
+  }
+
+  bool CacheReader::readSegment( Column& column )
+  {
+    //Encoding, values and, for dictionaries, the length prefixed entries
+    if ( column.cursor >= column.end
+      || static_cast< unsigned char >( *column.cursor )
+        > static_cast< unsigned char >( Encoding::Dictionary ) )
+    {
+      return false;
+    }
+    column.encoding = static_cast< Encoding >( *column.cursor++ );
+    if ( !decodeVarUInt64( column.cursor, column.end, column.values )
+      || column.values == 0 )
+    {
+      return false;
+    }
+
+    column.dictionary.clear( );
+    if ( column.encoding == Encoding::Dictionary )
+    {
+      uint64_t entries;
+      if ( !decodeVarUInt64( column.cursor, column.end, entries )
+        || entries > SOURCE_CACHE_MAX_DICTIONARY )
+      {
+        return false;
+      }
+      for ( uint64_t entry = 0; entry < entries; ++entry )
+      {
+        uint64_t length;
+        if ( !decodeVarUInt64( column.cursor, column.end, length )
+          || static_cast< uint64_t >( column.end - column.cursor ) < length )
+        {
+          return false;
+        }
+        column.dictionary.emplace_back( column.cursor,
+          static_cast< size_t >( length ) );
+        column.cursor += length;
+      }
+    }
+    return true;
+  }
+
+  void CacheReader::formatNumber( const int64_t& mantissa,
+    const uint64_t& scale, std::string& text )
+  {
+    //Digits from the lowest, padded so there is one before the point
+    char digits[ SOURCE_CACHE_MAX_DIGITS + 2 ];
+    uint64_t magnitude = ( mantissa < 0 )
+      ? 0 - static_cast< uint64_t >( mantissa )
+      : static_cast< uint64_t >( mantissa );
+    size_t size = 0;
+    do
+    {
+      digits[ size++ ] = static_cast< char >( '0' + magnitude % 10 );
+      magnitude /= 10;
+    }
+    while ( magnitude != 0 && size < sizeof( digits ) );
+    while ( size <= scale && size < sizeof( digits ) )
+    {
+      digits[ size++ ] = '0';
+    }
+
+    text.clear( );
+    if ( mantissa < 0 )
+    {
+      text.push_back( '-' );
+    }
+    for ( size_t i = size; i-- > 0; )
+    {
+      text.push_back( digits[ i ] );
+      if ( i == scale && scale != 0 )
+      {
+        text.push_back( '.' );
+      }
+    }
+  }
+
+}
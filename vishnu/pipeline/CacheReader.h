@@ -0,0 +1,114 @@
+/*
+ * Vishnu
+ * Copyright (c) 2017-2019 GMRV/URJC.
+ *
+ * Authors: Gonzalo Bayo Martinez <gonzalo.bayo@urjc.es>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef VISHNU_CACHEREADER_H
+#define VISHNU_CACHEREADER_H
+
+#include <string>
+#include <vector>
+#include <memory>
+
+#include "FileFingerprint.h"
+#include "MappedFile.h"
+#include "RecordReader.h"
+
+namespace vishnu
+{
+
+  class CacheReader;
+  using CacheReaderPtr = std::shared_ptr< CacheReader >;
+
+  /*
+   * Reads records from a columnar source cache written by SourceCache. Only
+   * the columns used by the projection are touched.
+   */
+  class CacheReader : public RecordReader
+  {
+
+    public:
+
+      //Encoding of a column segment, see SourceCache
+      enum class Encoding
+      {
+        Plain,
+        Numeric,
+        Dictionary
+      };
+
+      explicit CacheReader( const std::string& cachePath );
+      ~CacheReader( void ) override;
+
+      bool isOpen( void ) const override;
+
+      bool readHeaders( std::vector< std::string >& headers ) override;
+
+      void setProjection( const std::vector< int >& columns,
+        const std::string& missingValue ) override;
+
+      bool readRecord( std::vector< StringView >& fields ) override;
+
+      size_t getPosition( void ) const override;
+      size_t getSize( void ) const override;
+
+      //Source version the cache was built from
+      FileFingerprint getSourceFingerprint( void ) const;
+
+      size_t getRows( void ) const;
+
+      //Text of a numeric value: mantissa with scale decimal digits
+      static void formatNumber( const int64_t& mantissa, const uint64_t& scale,
+        std::string& text );
+
+    private:
+
+      struct Column
+      {
+        const char* cursor;
+        const char* end;
+        //Values left in the current segment
+        uint64_t values;
+        Encoding encoding;
+        std::vector< StringView > dictionary;
+        //Text of the last numeric value
+        std::string text;
+      };
+
+      MappedFile _file;
+      bool _open;
+      FileFingerprint _sourceFingerprint;
+      uint64_t _rows;
+      uint64_t _row;
+      std::vector< std::string > _headers;
+      std::vector< Column > _columns;
+      bool _projected;
+      std::vector< int > _projection;
+      std::vector< size_t > _usedColumns;
+      std::string _missingValue;
+      std::vector< StringView > _values;
+      std::vector< bool > _present;
+
+      bool parseHeader( void );
+      bool readValue( const size_t& column );
+      bool readSegment( Column& column );
+  };
+
+}
+
+#endif
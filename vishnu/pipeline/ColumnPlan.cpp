@@ -0,0 +1,65 @@
+/*
+ * Vishnu
+ * Copyright (c) 2017-2019 GMRV/URJC.
+ *
+ * Authors: Gonzalo Bayo Martinez <gonzalo.bayo@urjc.es>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "ColumnPlan.h"
+
+#include <unordered_map>
+
+namespace vishnu
+{
+
+  ColumnPlan::ColumnPlan( const std::vector< std::string >& headers,
+    const std::vector< std::string >& sourceHeaders )
+    : _matchedColumns( 0 )
+  {
+    std::unordered_map< std::string, int > sourceColumns;
+    sourceColumns.reserve( sourceHeaders.size( ) );
+    for ( size_t col = 0; col < sourceHeaders.size( ); ++col )
+    {
+      sourceColumns.emplace( sourceHeaders[ col ], static_cast< int >( col ) );
+    }
+
+    _columns.reserve( headers.size( ) );
+    for ( const auto& header : headers )
+    {
+      auto it = sourceColumns.find( header );
+      if ( it != sourceColumns.end( ) )
+      {
+        _columns.emplace_back( it->second );
+        ++_matchedColumns;
+      }
+      else
+      {
+        _columns.emplace_back( -1 );
+      }
+    }
+  }
+
+  const std::vector< int >& ColumnPlan::getColumns( void ) const
+  {
+    return _columns;
+  }
+
+  size_t ColumnPlan::getMatchedColumns( void ) const
+  {
+    return _matchedColumns;
+  }
+
+}
@@ -0,0 +1,57 @@
+/*
+ * Vishnu
+ * Copyright (c) 2017-2019 GMRV/URJC.
+ *
+ * Authors: Gonzalo Bayo Martinez <gonzalo.bayo@urjc.es>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef VISHNU_COLUMNPLAN_H
+#define VISHNU_COLUMNPLAN_H
+
+#include <string>
+#include <vector>
+
+namespace vishnu
+{
+
+  /*
+   * Source column of every output header, compiled once per source file
+   * with a hashed lookup of the source headers. Readers gather each record
+   * through it (see RecordReader::setProjection).
+   */
+  class ColumnPlan
+  {
+
+    public:
+
+      //Headers repeated in the source resolve to their first column
+      ColumnPlan( const std::vector< std::string >& headers,
+        const std::vector< std::string >& sourceHeaders );
+
+      //-1 for output headers the source has not
+      const std::vector< int >& getColumns( void ) const;
+
+      size_t getMatchedColumns( void ) const;
+
+    private:
+
+      std::vector< int > _columns;
+      size_t _matchedColumns;
+  };
+
+}
+
+#endif
@@ -0,0 +1,79 @@
+/*
+ * Vishnu
+ * Copyright (c) 2017-2019 GMRV/URJC.
+ *
+ * Authors: Gonzalo Bayo Martinez <gonzalo.bayo@urjc.es>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef VISHNU_CSVFORMAT_H
+#define VISHNU_CSVFORMAT_H
+
+#include <string>
+#include <vector>
+
+#include "StringView.h"
+
+namespace vishnu
+{
+
+  //Appends a field to a CSV line, quoting it if it contains separators,
+  //quotes or line breaks
+  inline void appendCsvField( std::string& line, const StringView& field,
+    const char& separator = ',' )
+  {
+    bool quote = false;
+    for ( size_t i = 0; i < field.size && !quote; ++i )
+    {
+      char c = field.data[ i ];
+      quote = ( c == separator || c == '"' || c == '\n' || c == '\r' );
+    }
+    if ( !quote )
+    {
+      line.append( field.data, field.size );
+      return;
+    }
+
+    line += '"';
+    for ( size_t i = 0; i < field.size; ++i )
+    {
+      if ( field.data[ i ] == '"' )
+      {
+        line += '"';
+      }
+      line += field.data[ i ];
+    }
+    line += '"';
+  }
+
+  //Builds a CSV line (without line break) from the given fields
+  inline std::string joinCsvFields( const std::vector< std::string >& fields,
+    const char& separator = ',' )
+  {
+    std::string line;
+    for ( size_t i = 0; i < fields.size( ); ++i )
+    {
+      if ( i != 0 )
+      {
+        line += separator;
+      }
+      appendCsvField( line, StringView( fields[ i ] ), separator );
+    }
+    return line;
+  }
+
+}
+
+#endif
@@ -0,0 +1,600 @@
+/*
+ * Vishnu
+ * Copyright (c) 2017-2019 GMRV/URJC.
+ *
+ * Authors: Gonzalo Bayo Martinez <gonzalo.bayo@urjc.es>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "CsvJoiner.h"
+
+#include <QCoreApplication>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+
+#include "BinaryIO.h"
+#include "ColumnPlan.h"
+#include "CsvFormat.h"
+#include "FileFingerprint.h"
+#include "SourceCache.h"
+#include "../Definitions.hpp"
+
+namespace vishnu
+{
+
+  namespace
+  {
+    const char KEY_SEPARATOR = '\x1f';
+    const StringView MISSING_FIELD( MISSING_DATA_FIELD,
+      sizeof( MISSING_DATA_FIELD ) - 1 );
+
+    const size_t MIN_INDEX_SLOTS = 1024;
+
+    //Packed rows: length prefixed fields, one after the other
+    void packRow( const std::vector< StringView >& fields, std::string& row )
+    {
+      row.clear( );
+      for ( const auto& field : fields )
+      {
+        appendUInt32( row, static_cast< uint32_t >( field.size ) );
+        row.append( field.data, field.size );
+      }
+    }
+
+    StringView packRow( const std::vector< StringView >& fields, Arena& arena )
+    {
+      size_t size = 0;
+      for ( const auto& field : fields )
+      {
+        size += 4 + field.size;
+      }
+      char* row = arena.allocate( size );
+      char* current = row;
+      for ( const auto& field : fields )
+      {
+        encodeUInt32( current, static_cast< uint32_t >( field.size ) );
+        std::memcpy( current + 4, field.data, field.size );
+        current += 4 + field.size;
+      }
+      return StringView( row, size );
+    }
+
+    //Views into row, valid while it is not modified
+    void unpackRow( const StringView& row, std::vector< StringView >& fields )
+    {
+      fields.clear( );
+      for ( size_t i = 0; i + 4 <= row.size; )
+      {
+        size_t size = decodeUInt32( row.data + i );
+        fields.emplace_back( row.data + i + 4, size );
+        i += 4 + size;
+      }
+    }
+
+    //Partition records: packed row size followed by the packed row
+    bool readRow( std::ifstream& file, std::string& row )
+    {
+      uint32_t size;
+      if ( !readUInt32( file, size ) )
+      {
+        return false;
+      }
+      row.resize( size );
+      return size == 0 || static_cast< bool >( file.read( &row[ 0 ], size ) );
+    }
+  }
+
+  CsvJoiner::CsvJoiner( const std::vector< std::string >& headers,
+    const std::vector< std::string >& primaryKeys,
+    const size_t& memoryBudget, const std::string& tempFolder )
+    : _headers( headers )
+    , _memoryBudget( std::max( memoryBudget,
+        static_cast< size_t >( JOIN_MIN_MEMORY_BUDGET ) ) )
+    , _tempFolder( tempFolder )
+    , _partitionCounter( 0 )
+  {
+    for ( const auto& primaryKey : primaryKeys )
+    {
+      for ( size_t col = 0; col < _headers.size( ); ++col )
+      {
+        if ( _headers[ col ] == primaryKey )
+        {
+          _keyColumns.emplace_back( col );
+          break;
+        }
+      }
+    }
+  }
+
+  CsvJoiner::~CsvJoiner( void )
+  {
+
+  }
+
+  bool CsvJoiner::join( const std::vector< std::string >& sourcePaths,
+    DataSetWriter& writer )
+  {
+    _error.clear( );
+
+    //Write headers
+    writer.writeLine( joinCsvFields( _headers ) );
+
+    Index& index = _index;
+    resetIndex( index );
+    Partitions partitions;
+    bool result = true;
+
+    for ( size_t s = 0; s < sourcePaths.size( ) && result; ++s )
+    {
+      const std::string& sourcePath = sourcePaths.at( s );
+      RecordReaderPtr reader = SourceCache::open( sourcePath, _cacheFolder );
+      if ( !reader->isOpen( ) )
+      {
+        _error = "Can't open " + sourcePath + " file.";
+        result = false;
+        break;
+      }
+
+      std::vector< std::string > sourceHeaders;
+      if ( !reader->readHeaders( sourceHeaders ) )
+      {
+        continue;
+      }
+
+      ColumnPlan plan( _headers, sourceHeaders );
+      reader->setProjection( plan.getColumns( ), MISSING_DATA_FIELD );
+
+      std::vector< StringView > fields;
+      size_t rows = 0;
+      size_t position = reader->getPosition( );
+      while ( reader->readRecord( fields ) )
+      {
+        if ( ++rows % PROGRESS_UPDATE_ROWS == 0 )
+        {
+          if ( _progress )
+          {
+            _progress->addDone( reader->getPosition( ) - position );
+            position = reader->getPosition( );
+          }
+          if ( isCanceled( ) )
+          {
+            result = false;
+            break;
+          }
+        }
+
+        for ( auto& field : fields )
+        {
+          field.trim( );
+        }
+
+        if ( !partitions.paths.empty( ) )
+        {
+          //Already spilled, rows go straight to their partition
+          packRow( fields, _row );
+          result = appendToPartition( partitions, _row, getKey( fields ), 0 );
+        }
+        else
+        {
+          insert( index, fields );
+          if ( getMemory( index ) > _memoryBudget )
+          {
+            result = spill( index, partitions, 0 );
+          }
+        }
+        if ( !result )
+        {
+          break;
+        }
+      }
+      if ( _progress )
+      {
+        _progress->addDone( reader->getSize( ) - position );
+      }
+    }
+
+    if ( result )
+    {
+      if ( partitions.paths.empty( ) )
+      {
+        writeRows( index, writer );
+        resetIndex( index );
+      }
+      else if ( closePartitions( partitions ) )
+      {
+        for ( const auto& partitionPath : partitions.paths )
+        {
+          if ( isCanceled( ) || !joinPartition( partitionPath, 1, writer ) )
+          {
+            result = false;
+            break;
+          }
+        }
+      }
+      else
+      {
+        result = false;
+      }
+    }
+    removePartitions( partitions );
+
+    if ( result && writer.hasError( ) )
+    {
+      _error = writer.getError( );
+      result = false;
+    }
+    if ( result && _nullBitmap && _nullBitmap->hasError( ) )
+    {
+      _error = _nullBitmap->getError( );
+      result = false;
+    }
+    return result;
+  }
+
+  std::string CsvJoiner::getError( void ) const
+  {
+    return _error;
+  }
+
+  void CsvJoiner::setCacheFolder( const std::string& cacheFolder )
+  {
+    _cacheFolder = cacheFolder;
+  }
+
+  void CsvJoiner::setProgress( const BuildProgressPtr& progress )
+  {
+    _progress = progress;
+  }
+
+  void CsvJoiner::setNullBitmap( const NullBitmapWriterPtr& nullBitmap )
+  {
+    _nullBitmap = nullBitmap;
+  }
+
+  void CsvJoiner::setRowFilter( const RowFilterPtr& rowFilter )
+  {
+    _rowFilter = rowFilter;
+  }
+
+  bool CsvJoiner::isCanceled( void )
+  {
+    if ( _progress && _progress->isCanceled( ) )
+    {
+      _error = "Canceled.";
+      return true;
+    }
+    return false;
+  }
+
+  const std::string& CsvJoiner::getKey(
+    const std::vector< StringView >& fields )
+  {
+    _key.clear( );
+    for ( const auto& keyColumn : _keyColumns )
+    {
+      _key.append( fields[ keyColumn ].data, fields[ keyColumn ].size );
+      _key += KEY_SEPARATOR;
+    }
+    return _key;
+  }
+
+  void CsvJoiner::insert( Index& index,
+    const std::vector< StringView >& fields )
+  {
+    const StringView key( getKey( fields ) );
+    uint64_t hash = FileFingerprint::hash( key.data, key.size );
+    if ( 2 * ( index.entries.size( ) + 1 ) > index.slots.size( ) )
+    {
+      growSlots( index );
+    }
+    size_t mask = index.slots.size( ) - 1;
+    size_t slot = static_cast< size_t >( hash ) & mask;
+    while ( index.slots[ slot ] != 0 )
+    {
+      Entry& entry = index.entries[ index.slots[ slot ] - 1 ];
+      if ( entry.hash == hash && entry.key == key )
+      {
+        //Same entity, fill the fields still missing. The previous row
+        //stays in the arena until the next reset
+        unpackRow( entry.row, _fields );
+        bool filled = false;
+        for ( size_t col = 0; col < _fields.size( ); ++col )
+        {
+          if ( _fields[ col ] == MISSING_FIELD
+            && fields[ col ] != MISSING_FIELD )
+          {
+            _fields[ col ] = fields[ col ];
+            filled = true;
+          }
+        }
+        if ( filled )
+        {
+          entry.row = packRow( _fields, index.arena );
+        }
+        return;
+      }
+      slot = ( slot + 1 ) & mask;
+    }
+
+    Entry entry;
+    entry.hash = hash;
+    entry.key = index.arena.copy( key );
+    entry.row = packRow( fields, index.arena );
+    if ( index.entries.size( ) == index.entries.capacity( ) )
+    {
+      ++index.allocations;
+    }
+    index.entries.emplace_back( entry );
+    index.slots[ slot ] = index.entries.size( );
+  }
+
+  void CsvJoiner::growSlots( Index& index ) const
+  {
+    size_t size = std::max( MIN_INDEX_SLOTS, 2 * index.slots.size( ) );
+    if ( size > index.slots.capacity( ) )
+    {
+      ++index.allocations;
+    }
+    index.slots.assign( size, 0 );
+    size_t mask = size - 1;
+    for ( size_t i = 0; i < index.entries.size( ); ++i )
+    {
+      size_t slot = static_cast< size_t >( index.entries[ i ].hash ) & mask;
+      while ( index.slots[ slot ] != 0 )
+      {
+        slot = ( slot + 1 ) & mask;
+      }
+      index.slots[ slot ] = i + 1;
+    }
+  }
+
+  size_t CsvJoiner::getMemory( const Index& index ) const
+  {
+    return index.arena.getBytes( ) + index.entries.size( ) * sizeof( Entry )
+      + index.slots.size( ) * sizeof( size_t );
+  }
+
+  void CsvJoiner::resetIndex( Index& index )
+  {
+    if ( _progress && !index.entries.empty( ) )
+    {
+      _progress->addBatch( getMemory( index ),
+        index.arena.getHeapAllocations( ) + index.allocations );
+    }
+    index.arena.reset( );
+    index.entries.clear( );
+    std::fill( index.slots.begin( ), index.slots.end( ), 0 );
+    index.allocations = 0;
+  }
+
+  bool CsvJoiner::joinPartition( const std::string& partitionPath,
+    const unsigned int& level, DataSetWriter& writer )
+  {
+    std::ifstream partition( partitionPath, std::ios::binary );
+    if ( !partition.is_open( ) )
+    {
+      _error = "Can't open " + partitionPath + " file.";
+      return false;
+    }
+
+    Index& index = _index;
+    Partitions partitions;
+    bool result = true;
+    std::string row;
+    std::vector< StringView > fields;
+    size_t rows = 0;
+    while ( result && readRow( partition, row ) )
+    {
+      if ( ++rows % PROGRESS_UPDATE_ROWS == 0 && isCanceled( ) )
+      {
+        result = false;
+        break;
+      }
+      unpackRow( row, fields );
+      if ( !partitions.paths.empty( ) )
+      {
+        result = appendToPartition( partitions, row, StringView(
+          getKey( fields ) ), level );
+        continue;
+      }
+      insert( index, fields );
+      //Keys that can't be split further are joined in memory
+      if ( getMemory( index ) > _memoryBudget
+        && level < JOIN_MAX_SPILL_LEVELS )
+      {
+        result = spill( index, partitions, level );
+      }
+    }
+    partition.close( );
+    std::remove( partitionPath.c_str( ) );
+
+    if ( result )
+    {
+      if ( partitions.paths.empty( ) )
+      {
+        writeRows( index, writer );
+        resetIndex( index );
+      }
+      else if ( closePartitions( partitions ) )
+      {
+        for ( const auto& subPartitionPath : partitions.paths )
+        {
+          if ( isCanceled( )
+            || !joinPartition( subPartitionPath, level + 1, writer ) )
+          {
+            result = false;
+            break;
+          }
+        }
+      }
+      else
+      {
+        result = false;
+      }
+    }
+    removePartitions( partitions );
+    return result;
+  }
+
+  bool CsvJoiner::spill( Index& index, Partitions& partitions,
+    const unsigned int& level )
+  {
+    for ( size_t partition = 0; partition < JOIN_SPILL_PARTITIONS;
+      ++partition )
+    {
+      std::string partitionPath = getPartitionPath( level, partition );
+      std::shared_ptr< std::ofstream > file( new std::ofstream(
+        partitionPath, std::ios::binary | std::ios::trunc ) );
+      if ( !file->is_open( ) )
+      {
+        _error = "Can't create " + partitionPath + " file.";
+        return false;
+      }
+      partitions.paths.emplace_back( partitionPath );
+      partitions.files.emplace_back( file );
+    }
+
+    //Rows keep their order of appearance inside every partition
+    for ( const auto& entry : index.entries )
+    {
+      if ( !appendToPartition( partitions, entry.row, entry.key, level ) )
+      {
+        return false;
+      }
+    }
+
+    resetIndex( index );
+    return true;
+  }
+
+  bool CsvJoiner::appendToPartition( Partitions& partitions,
+    const StringView& row, const StringView& key, const unsigned int& level )
+  {
+    size_t partition = getPartition( key, level );
+    std::ofstream& file = *partitions.files.at( partition );
+    bool result = writeUInt32( file, static_cast< uint32_t >( row.size ) )
+      && file.write( row.data, row.size );
+    if ( !result )
+    {
+      _error = "Can't write " + partitions.paths.at( partition ) + " file.";
+    }
+    return result;
+  }
+
+  bool CsvJoiner::closePartitions( Partitions& partitions )
+  {
+    bool result = true;
+    for ( size_t i = 0; i < partitions.files.size( ); ++i )
+    {
+      partitions.files.at( i )->close( );
+      if ( partitions.files.at( i )->fail( ) && result )
+      {
+        _error = "Can't write " + partitions.paths.at( i ) + " file.";
+        result = false;
+      }
+    }
+    partitions.files.clear( );
+    return result;
+  }
+
+  void CsvJoiner::removePartitions( Partitions& partitions )
+  {
+    partitions.files.clear( );
+    for ( const auto& partitionPath : partitions.paths )
+    {
+      std::remove( partitionPath.c_str( ) );
+    }
+  }
+
+  size_t CsvJoiner::getPartition( const StringView& key,
+    const unsigned int& level ) const
+  {
+    //FNV-1a seeded with the spill level, so every level splits differently
+    uint64_t hash = 14695981039346656037ULL ^ ( level * 0x9E3779B97F4A7C15ULL );
+    for ( size_t i = 0; i < key.size; ++i )
+    {
+      hash ^= static_cast< unsigned char >( key.data[ i ] );
+      hash *= 1099511628211ULL;
+    }
+    return static_cast< size_t >( hash % JOIN_SPILL_PARTITIONS );
+  }
+
+  std::string CsvJoiner::getPartitionPath( const unsigned int& level,
+    const size_t& partition )
+  {
+    //Processes sharing the temporary folder never pick the same name
+    return _tempFolder + std::string( "/vishnu-join-" )
+      + std::to_string( QCoreApplication::applicationPid( ) )
+      + std::string( "-" )
+      + std::to_string( std::chrono::steady_clock::now( )
+        .time_since_epoch( ).count( ) )
+      + std::string( "-" ) + std::to_string( level )
+      + std::string( "-" ) + std::to_string( partition )
+      + std::string( "-" ) + std::to_string( _partitionCounter++ )
+      + std::string( ".tmp" );
+  }
+
+  void CsvJoiner::writeRows( const Index& index, DataSetWriter& writer )
+  {
+    std::string line;
+    std::vector< uint8_t > nulls;
+    size_t writtenRows = 0;
+    for ( const auto& entry : index.entries )
+    {
+      unpackRow( entry.row, _fields );
+      if ( _rowFilter && !_rowFilter->accept( _fields ) )
+      {
+        continue;
+      }
+      line.clear( );
+      nulls.clear( );
+      for ( size_t col = 0; col < _fields.size( ); ++col )
+      {
+        if ( col != 0 )
+        {
+          line += ",";
+        }
+        if ( _nullBitmap && _fields[ col ] == MISSING_FIELD )
+        {
+          NullBitmapWriter::setNull( nulls, col );
+          //A blank line would not be read back as a record
+          if ( _fields.size( ) == 1 )
+          {
+            line += "\"\"";
+          }
+          continue;
+        }
+        appendCsvField( line, _fields[ col ] );
+      }
+      line += "\n";
+      writer.write( line );
+      if ( _nullBitmap )
+      {
+        _nullBitmap->addRows( 1, nulls );
+      }
+      ++writtenRows;
+    }
+    if ( _progress )
+    {
+      _progress->addRows( writtenRows );
+    }
+  }
+
+}
@@ -0,0 +1,158 @@
+/*
+ * Vishnu
+ * Copyright (c) 2017-2019 GMRV/URJC.
+ *
+ * Authors: Gonzalo Bayo Martinez <gonzalo.bayo@urjc.es>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef VISHNU_CSVJOINER_H
+#define VISHNU_CSVJOINER_H
+
+#include <fstream>
+#include <string>
+#include <vector>
+#include <memory>
+
+#include "Arena.h"
+#include "BuildProgress.h"
+#include "DataSetWriter.h"
+#include "NullBitmapWriter.h"
+#include "RowFilter.h"
+#include "StringView.h"
+
+namespace vishnu
+{
+
+  class CsvJoiner;
+  using CsvJoinerPtr = std::shared_ptr< CsvJoiner >;
+
+  /*
+   * Joins several CSV files on their primary keys, writing one row per key
+   * with the fields found for that key in every source. Rows are indexed in
+   * a hash table; when the index grows over the memory budget it is spilled
+   * to partition files in the temporary folder, which are joined one by one
+   * afterwards.
+   *
+   * Rows are kept packed, as their length prefixed fields one after the
+   * other, and handled as views into them. Indexed keys and rows live in an
+   * arena that is reset after every spill, so once its blocks are warmed up
+   * indexing does no heap allocation.
+   */
+  class CsvJoiner
+  {
+
+    public:
+
+      CsvJoiner( const std::vector< std::string >& headers,
+        const std::vector< std::string >& primaryKeys,
+        const size_t& memoryBudget = DEFAULT_JOIN_MEMORY_BUDGET,
+        const std::string& tempFolder = std::string( "." ) );
+      ~CsvJoiner( void );
+
+      bool join( const std::vector< std::string >& sourcePaths,
+        DataSetWriter& writer );
+
+      std::string getError( void ) const;
+
+      //Read sources through their columnar cache in this folder (see
+      //SourceCache), directly when empty
+      void setCacheFolder( const std::string& cacheFolder );
+
+      //Source bytes read and rows written are added to progress, and join
+      //stops early when it is canceled
+      void setProgress( const BuildProgressPtr& progress );
+
+      //Missing fields are written empty and recorded in the bitmap instead
+      void setNullBitmap( const NullBitmapWriterPtr& nullBitmap );
+
+      //Only joined rows accepted by the filter are written
+      void setRowFilter( const RowFilterPtr& rowFilter );
+
+    private:
+
+      //Indexed row, key and packed fields in the index arena
+      struct Entry
+      {
+        uint64_t hash;
+        StringView key;
+        StringView row;
+      };
+
+      //In memory index of joined rows, in order of first appearance. Slots
+      //are an open addressing table of entry positions plus one (0 when
+      //free). Entries and slots keep their capacity across resets
+      struct Index
+      {
+        Arena arena;
+        std::vector< Entry > entries;
+        std::vector< size_t > slots;
+        //Buffers grown since the last reset
+        size_t allocations = 0;
+      };
+
+      //Spill files of one level, kept open while rows are being spilled
+      struct Partitions
+      {
+        std::vector< std::string > paths;
+        std::vector< std::shared_ptr< std::ofstream > > files;
+      };
+
+      std::vector< std::string > _headers;
+      std::vector< size_t > _keyColumns;
+      size_t _memoryBudget;
+      std::string _tempFolder;
+      std::string _error;
+      std::string _cacheFolder;
+      size_t _partitionCounter;
+      BuildProgressPtr _progress;
+      NullBitmapWriterPtr _nullBitmap;
+      RowFilterPtr _rowFilter;
+
+      //Only one index holds rows at a time: spilled levels are empty before
+      //their partitions are joined
+      Index _index;
+
+      //Buffers reused between rows
+      std::string _key;
+      std::string _row;
+      std::vector< StringView > _fields;
+
+      bool isCanceled( void );
+
+      const std::string& getKey( const std::vector< StringView >& fields );
+      void insert( Index& index, const std::vector< StringView >& fields );
+      void growSlots( Index& index ) const;
+      size_t getMemory( const Index& index ) const;
+      void resetIndex( Index& index );
+
+      bool joinPartition( const std::string& partitionPath,
+        const unsigned int& level, DataSetWriter& writer );
+      bool spill( Index& index, Partitions& partitions,
+        const unsigned int& level );
+      bool appendToPartition( Partitions& partitions, const StringView& row,
+        const StringView& key, const unsigned int& level );
+      bool closePartitions( Partitions& partitions );
+      void removePartitions( Partitions& partitions );
+      size_t getPartition( const StringView& key,
+        const unsigned int& level ) const;
+      std::string getPartitionPath( const unsigned int& level,
+        const size_t& partition );
+      void writeRows( const Index& index, DataSetWriter& writer );
+  };
+
+}
+
+#endif
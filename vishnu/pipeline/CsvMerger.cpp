@@ -0,0 +1,609 @@
+/*
+ * Vishnu
+ * Copyright (c) 2017-2019 GMRV/URJC.
+ *
+ * Authors: Gonzalo Bayo Martinez <gonzalo.bayo@urjc.es>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "CsvMerger.h"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+
+#include "ColumnPlan.h"
+#include "CsvFormat.h"
+#include "FileFingerprint.h"
+#include "SourceCache.h"
+#include "../Definitions.hpp"
+
+namespace vishnu
+{
+
+  //Merged rows, with their missing fields in sparse mode
+  struct CsvMerger::Block
+  {
+    std::string text;
+    size_t rows = 0;
+    std::vector< uint8_t > nulls;
+    //Only filled when filtering duplicates. Source rows are not contiguous
+    //when a row filter drops some of them
+    std::vector< uint64_t > sourceRows;
+    std::vector< size_t > rowEnds;
+    std::vector< uint64_t > fingerprints;
+    //Buffer capacities when the block was started
+    std::array< size_t, 5 > capacities = { { 0, 0, 0, 0, 0 } };
+
+    //Empties the block, keeping its buffers
+    void start( void )
+    {
+      text.clear( );
+      rows = 0;
+      nulls.clear( );
+      sourceRows.clear( );
+      rowEnds.clear( );
+      fingerprints.clear( );
+      capacities = getCapacities( );
+      text.reserve( MERGE_BLOCK_SIZE );
+    }
+
+    std::array< size_t, 5 > getCapacities( void ) const
+    {
+      return { { text.capacity( ), nulls.capacity( ), sourceRows.capacity( ),
+        rowEnds.capacity( ), fingerprints.capacity( ) } };
+    }
+
+    //Buffers allocated or grown since the block was started
+    size_t getAllocations( void ) const
+    {
+      std::array< size_t, 5 > current = getCapacities( );
+      size_t allocations = 0;
+      for ( size_t i = 0; i < current.size( ); ++i )
+      {
+        allocations += ( current[ i ] > capacities[ i ] ) ? 1 : 0;
+      }
+      return allocations;
+    }
+  };
+
+  //Written blocks, reused by the workers so that their buffers are only
+  //allocated once per merge pass
+  struct CsvMerger::BlockPool
+  {
+    std::mutex mutex;
+    std::vector< Block > blocks;
+
+    void take( Block& block )
+    {
+      {
+        std::lock_guard< std::mutex > lock( mutex );
+        if ( !blocks.empty( ) )
+        {
+          block = std::move( blocks.back( ) );
+          blocks.pop_back( );
+        }
+      }
+      block.start( );
+    }
+
+    void recycle( Block& block )
+    {
+      std::lock_guard< std::mutex > lock( mutex );
+      blocks.emplace_back( std::move( block ) );
+    }
+  };
+
+  //Merged rows of one source waiting to be written
+  struct CsvMerger::SourceBlocks
+  {
+    std::mutex mutex;
+    std::condition_variable condition;
+    std::deque< Block > blocks;
+    bool finished = false;
+    std::string error;
+    std::atomic< bool >* abort = nullptr;
+    BlockPool* pool = nullptr;
+
+    //Blocks the producer while the queue is full
+    void push( Block& block )
+    {
+      std::unique_lock< std::mutex > lock( mutex );
+      condition.wait( lock, [ this ]( )
+      {
+        return blocks.size( ) < MERGE_MAX_QUEUED_BLOCKS || *abort;
+      } );
+      blocks.emplace_back( std::move( block ) );
+      block = Block( );
+      condition.notify_all( );
+    }
+
+    void finish( const std::string& message = std::string( ) )
+    {
+      std::lock_guard< std::mutex > lock( mutex );
+      error = message;
+      finished = true;
+      condition.notify_all( );
+    }
+  };
+
+  CsvMerger::CsvMerger( const std::vector< std::string >& headers,
+    const size_t& workers )
+    : _headers( headers )
+    , _workers( workers )
+    , _writeHeaders( true )
+  {
+    if ( _workers == 0 )
+    {
+      _workers = std::max( 1u, std::thread::hardware_concurrency( ) );
+    }
+  }
+
+  CsvMerger::~CsvMerger( void )
+  {
+
+  }
+
+  bool CsvMerger::merge( const std::vector< std::string >& sourcePaths,
+    DataSetWriter& writer )
+  {
+    _error.clear( );
+    _sourceSizes.assign( sourcePaths.size( ), 0 );
+
+    //Write headers
+    if ( _writeHeaders )
+    {
+      writer.writeLine( joinCsvFields( _headers ) );
+    }
+
+    if ( _conflictReport )
+    {
+      std::vector< std::string > reportHeaders( { "source", "row",
+        "keptSource", "keptRow" } );
+      reportHeaders.insert( reportHeaders.end( ), _headers.begin( ),
+        _headers.end( ) );
+      _conflictReport->writeLine( joinCsvFields( reportHeaders ) );
+    }
+
+    if ( isFiltered( )
+      && _duplicateFilter->getPolicy( ) == DuplicateFilter::Policy::KeepLast
+      && !mergePass( sourcePaths, nullptr ) )
+    {
+      return false;
+    }
+    return mergePass( sourcePaths, &writer );
+  }
+
+  bool CsvMerger::mergePass( const std::vector< std::string >& sourcePaths,
+    DataSetWriter* writer )
+  {
+    std::atomic< bool > abort( false );
+    BlockPool pool;
+    std::vector< std::unique_ptr< SourceBlocks > > sources;
+    for ( size_t i = 0; i < sourcePaths.size( ); ++i )
+    {
+      sources.emplace_back( new SourceBlocks( ) );
+      sources.back( )->abort = &abort;
+      sources.back( )->pool = &pool;
+    }
+
+    //Sources are taken in list order, so the source being written is always
+    //already assigned to a worker
+    std::atomic< size_t > nextSource( 0 );
+    std::vector< std::thread > workers;
+    size_t workersSize = std::min( _workers, sourcePaths.size( ) );
+    for ( size_t i = 0; i < workersSize; ++i )
+    {
+      workers.emplace_back( [ & ]( )
+      {
+        size_t index;
+        while ( !abort && ( index = nextSource++ ) < sourcePaths.size( ) )
+        {
+          projectSource( sourcePaths.at( index ), *sources.at( index ) );
+        }
+      } );
+    }
+
+    //Ordered write
+    bool result = true;
+    for ( size_t i = 0; i < sources.size( ) && result; ++i )
+    {
+      SourceBlocks& source = *sources.at( i );
+      while ( result )
+      {
+        Block block;
+        {
+          std::unique_lock< std::mutex > lock( source.mutex );
+          source.condition.wait( lock, [ &source ]( )
+          {
+            return !source.blocks.empty( ) || source.finished;
+          } );
+          if ( source.blocks.empty( ) )
+          {
+            if ( !source.error.empty( ) )
+            {
+              _error = source.error;
+              result = false;
+            }
+            break;
+          }
+          block = std::move( source.blocks.front( ) );
+          source.blocks.pop_front( );
+          source.condition.notify_all( );
+        }
+        result = writeBlock( sourcePaths, i, block, writer );
+        pool.recycle( block );
+      }
+      if ( !result || writer == nullptr )
+      {
+        continue;
+      }
+      if ( writer->hasError( ) )
+      {
+        _error = writer->getError( );
+        result = false;
+      }
+      else if ( _nullBitmap && _nullBitmap->hasError( ) )
+      {
+        _error = _nullBitmap->getError( );
+        result = false;
+      }
+      else if ( _conflictReport && _conflictReport->hasError( ) )
+      {
+        _error = _conflictReport->getError( );
+        result = false;
+      }
+    }
+
+    if ( !result )
+    {
+      abort = true;
+      for ( auto& source : sources )
+      {
+        std::lock_guard< std::mutex > lock( source->mutex );
+        source->condition.notify_all( );
+      }
+    }
+    for ( auto& worker : workers )
+    {
+      worker.join( );
+    }
+    return result;
+  }
+
+  bool CsvMerger::writeBlock( const std::vector< std::string >& sourcePaths,
+    const size_t& source, const Block& block, DataSetWriter* writer )
+  {
+    if ( !isFiltered( ) )
+    {
+      writer->write( block.text );
+      _sourceSizes[ source ] += block.text.size( );
+      if ( _nullBitmap )
+      {
+        _nullBitmap->addRows( block.rows, block.nulls );
+      }
+      return true;
+    }
+
+    DuplicateFilter::RowId rowId;
+    rowId.source = static_cast< uint32_t >( source );
+    if ( writer == nullptr )
+    {
+      for ( size_t row = 0; row < block.rows; ++row )
+      {
+        rowId.row = block.sourceRows[ row ];
+        _duplicateFilter->recordLast( block.fingerprints[ row ], rowId );
+      }
+      return true;
+    }
+
+    //Rows are written one by one, with their null bits
+    std::vector< uint8_t > nulls;
+    size_t writtenRows = 0;
+    size_t begin = 0;
+    for ( size_t row = 0; row < block.rows; ++row )
+    {
+      size_t end = block.rowEnds[ row ];
+      rowId.row = block.sourceRows[ row ];
+      DuplicateFilter::RowId keptRow;
+      if ( _duplicateFilter->accept( block.fingerprints[ row ], rowId,
+        keptRow ) )
+      {
+        writer->write( block.text.data( ) + begin, end - begin );
+        _sourceSizes[ source ] += end - begin;
+        if ( _nullBitmap )
+        {
+          for ( size_t col = 0; col < _headers.size( ); ++col )
+          {
+            if ( NullBitmapWriter::isNull( block.nulls,
+              row * _headers.size( ) + col ) )
+            {
+              NullBitmapWriter::setNull( nulls,
+                writtenRows * _headers.size( ) + col );
+            }
+          }
+        }
+        ++writtenRows;
+      }
+      else
+      {
+        if ( _conflictReport )
+        {
+          _conflictReport->write( joinCsvFields( { sourcePaths.at( source ),
+            std::to_string( rowId.row + 1 ),
+            sourcePaths.at( keptRow.source ),
+            std::to_string( keptRow.row + 1 ) } ) + std::string( "," ) );
+          _conflictReport->write( block.text.data( ) + begin, end - begin );
+        }
+        if ( _duplicateFilter->getPolicy( ) == DuplicateFilter::Policy::Fail )
+        {
+          _error = "Row " + std::to_string( rowId.row + 1 ) + " of "
+            + sourcePaths.at( source ) + " duplicates row "
+            + std::to_string( keptRow.row + 1 ) + " of "
+            + sourcePaths.at( keptRow.source ) + ".";
+          return false;
+        }
+      }
+      begin = end;
+    }
+    if ( _nullBitmap )
+    {
+      _nullBitmap->addRows( writtenRows, nulls );
+    }
+    return true;
+  }
+
+  std::string CsvMerger::getError( void ) const
+  {
+    return _error;
+  }
+
+  void CsvMerger::setCacheFolder( const std::string& cacheFolder )
+  {
+    _cacheFolder = cacheFolder;
+  }
+
+  void CsvMerger::setProgress( const BuildProgressPtr& progress )
+  {
+    _progress = progress;
+  }
+
+  void CsvMerger::setWriteHeaders( const bool& writeHeaders )
+  {
+    _writeHeaders = writeHeaders;
+  }
+
+  void CsvMerger::setNullBitmap( const NullBitmapWriterPtr& nullBitmap )
+  {
+    _nullBitmap = nullBitmap;
+  }
+
+  void CsvMerger::setDuplicateFilter(
+    const DuplicateFilterPtr& duplicateFilter,
+    const std::vector< std::string >& primaryKeys )
+  {
+    _duplicateFilter = duplicateFilter;
+    _keyColumns.clear( );
+    for ( const auto& primaryKey : primaryKeys )
+    {
+      for ( size_t col = 0; col < _headers.size( ); ++col )
+      {
+        if ( _headers[ col ] == primaryKey )
+        {
+          _keyColumns.emplace_back( col );
+          break;
+        }
+      }
+    }
+  }
+
+  void CsvMerger::setConflictReport( const DataSetWriterPtr& conflictReport )
+  {
+    _conflictReport = conflictReport;
+  }
+
+  void CsvMerger::setRowFilter( const RowFilterPtr& rowFilter )
+  {
+    _rowFilter = rowFilter;
+  }
+
+  std::vector< size_t > CsvMerger::getSourceSizes( void ) const
+  {
+    return _sourceSizes;
+  }
+
+  bool CsvMerger::isCanceled( void ) const
+  {
+    return _progress && _progress->isCanceled( );
+  }
+
+  bool CsvMerger::isFiltered( void ) const
+  {
+    return _duplicateFilter
+      && _duplicateFilter->getPolicy( ) != DuplicateFilter::Policy::KeepAll;
+  }
+
+  void CsvMerger::projectSource( const std::string& sourcePath,
+    SourceBlocks& sourceBlocks )
+  {
+    if ( isCanceled( ) )
+    {
+      sourceBlocks.finish( "Canceled." );
+      return;
+    }
+
+    RecordReaderPtr reader = SourceCache::open( sourcePath, _cacheFolder );
+    if ( !reader->isOpen( ) )
+    {
+      sourceBlocks.finish( "Can't open " + sourcePath + " file." );
+      return;
+    }
+
+    std::vector< std::string > sourceHeaders;
+    if ( !reader->readHeaders( sourceHeaders ) )
+    {
+      //Empty file, nothing to merge
+      sourceBlocks.finish( );
+      return;
+    }
+
+    ColumnPlan plan( _headers, sourceHeaders );
+    reader->setProjection( plan.getColumns( ), MISSING_DATA_FIELD );
+
+    std::vector< StringView > fields;
+    const StringView missing( MISSING_DATA_FIELD,
+      sizeof( MISSING_DATA_FIELD ) - 1 );
+    bool filtered = isFiltered( );
+    const char keySeparator = '\x1f';
+    Block block;
+    sourceBlocks.pool->take( block );
+    uint64_t sourceRow = 0;
+    size_t rejectedRows = 0;
+    size_t position = reader->getPosition( );
+    while ( reader->readRecord( fields ) )
+    {
+      for ( auto& field : fields )
+      {
+        field.trim( );
+      }
+      if ( _rowFilter && !_rowFilter->accept( fields ) )
+      {
+        ++sourceRow;
+        //Rejected rows produce no blocks, so progress and cancelation are
+        //checked here too
+        if ( ++rejectedRows % PROGRESS_UPDATE_ROWS == 0 )
+        {
+          if ( _progress )
+          {
+            _progress->addDone( reader->getPosition( ) - position );
+            position = reader->getPosition( );
+          }
+          if ( isCanceled( ) )
+          {
+            sourceBlocks.finish( "Canceled." );
+            return;
+          }
+          if ( *sourceBlocks.abort )
+          {
+            break;
+          }
+        }
+        continue;
+      }
+
+      size_t rowBegin = block.text.size( );
+      for ( size_t col = 0; col < fields.size( ); ++col )
+      {
+        if ( col != 0 )
+        {
+          block.text += ",";
+        }
+        if ( _nullBitmap && fields[ col ] == missing )
+        {
+          NullBitmapWriter::setNull( block.nulls,
+            block.rows * _headers.size( ) + col );
+          //A blank line would not be read back as a record
+          if ( fields.size( ) == 1 )
+          {
+            block.text += "\"\"";
+          }
+          continue;
+        }
+        appendCsvField( block.text, fields[ col ] );
+      }
+      if ( filtered )
+      {
+        //Primary key fields, or the whole row without primary keys
+        uint64_t fingerprint;
+        if ( _keyColumns.empty( ) )
+        {
+          fingerprint = FileFingerprint::hash( block.text.data( ) + rowBegin,
+            block.text.size( ) - rowBegin );
+        }
+        else
+        {
+          fingerprint = FileFingerprint::hash( &keySeparator, 1 );
+          for ( const auto& keyColumn : _keyColumns )
+          {
+            fingerprint = FileFingerprint::hash( fields[ keyColumn ].data,
+              fields[ keyColumn ].size, fingerprint );
+            fingerprint = FileFingerprint::hash( &keySeparator, 1,
+              fingerprint );
+          }
+        }
+        block.fingerprints.emplace_back( fingerprint );
+        block.sourceRows.emplace_back( sourceRow );
+      }
+      block.text += "\n";
+      ++block.rows;
+      ++sourceRow;
+      if ( filtered )
+      {
+        block.rowEnds.emplace_back( block.text.size( ) );
+      }
+
+      if ( block.text.size( ) >= MERGE_BLOCK_SIZE )
+      {
+        size_t blockRows = block.rows;
+        size_t blockBytes = block.text.size( );
+        size_t blockAllocations = block.getAllocations( );
+        sourceBlocks.push( block );
+        sourceBlocks.pool->take( block );
+        if ( _progress )
+        {
+          _progress->addBatch( blockBytes, blockAllocations );
+          _progress->addRows( blockRows );
+          _progress->addDone( reader->getPosition( ) - position );
+          position = reader->getPosition( );
+        }
+        if ( isCanceled( ) )
+        {
+          sourceBlocks.finish( "Canceled." );
+          return;
+        }
+        if ( *sourceBlocks.abort )
+        {
+          break;
+        }
+      }
+    }
+    size_t blockRows = block.rows;
+    size_t blockBytes = block.text.size( );
+    size_t blockAllocations = block.getAllocations( );
+    if ( !block.text.empty( ) )
+    {
+      sourceBlocks.push( block );
+    }
+    else
+    {
+      sourceBlocks.pool->recycle( block );
+    }
+    if ( _progress )
+    {
+      if ( blockRows != 0 )
+      {
+        _progress->addBatch( blockBytes, blockAllocations );
+      }
+      _progress->addRows( blockRows );
+      _progress->addDone( reader->getSize( ) - position );
+    }
+    sourceBlocks.finish( );
+  }
+
+}
@@ -0,0 +1,128 @@
+/*
+ * Vishnu
+ * Copyright (c) 2017-2019 GMRV/URJC.
+ *
+ * Authors: Gonzalo Bayo Martinez <gonzalo.bayo@urjc.es>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef VISHNU_CSVMERGER_H
+#define VISHNU_CSVMERGER_H
+
+#include <string>
+#include <vector>
+#include <memory>
+
+#include "BuildProgress.h"
+#include "DataSetWriter.h"
+#include "DuplicateFilter.h"
+#include "NullBitmapWriter.h"
+#include "RowFilter.h"
+
+namespace vishnu
+{
+
+  class CsvMerger;
+  using CsvMergerPtr = std::shared_ptr< CsvMerger >;
+
+  /*
+   * Merges several CSV files into one with the given headers. Every source
+   * is streamed record by record and projected onto the headers by a worker
+   * thread, producing blocks of merged rows. Blocks are written into the
+   * writer in source order, so the result does not depend on scheduling.
+   * Columns not present in a source are filled with MISSING_DATA_FIELD, or
+   * left empty and recorded in a null bitmap (see setNullBitmap). Rows
+   * describing the same entity can be filtered by a DuplicateFilter, and
+   * rows not matching a RowFilter are dropped before being projected.
+   */
+  class CsvMerger
+  {
+
+    public:
+
+      //A workers value of 0 uses one worker per hardware thread
+      explicit CsvMerger( const std::vector< std::string >& headers,
+        const size_t& workers = 0 );
+      ~CsvMerger( void );
+
+      bool merge( const std::vector< std::string >& sourcePaths,
+        DataSetWriter& writer );
+
+      std::string getError( void ) const;
+
+      //Read sources through their columnar cache in this folder (see
+      //SourceCache), directly when empty
+      void setCacheFolder( const std::string& cacheFolder );
+
+      //Source bytes read and rows merged are added to progress, and merge
+      //stops early when it is canceled
+      void setProgress( const BuildProgressPtr& progress );
+
+      //Headers are written before the rows unless disabled, e.g. when
+      //appending to an existing result
+      void setWriteHeaders( const bool& writeHeaders );
+
+      //Missing fields are written empty and recorded in the bitmap instead
+      void setNullBitmap( const NullBitmapWriterPtr& nullBitmap );
+
+      //Rows with the same primary key fields (every field without primary
+      //keys) are kept or dropped by the filter policy
+      void setDuplicateFilter( const DuplicateFilterPtr& duplicateFilter,
+        const std::vector< std::string >& primaryKeys );
+
+      //Rows dropped by the duplicate filter are written to the report,
+      //after their source and row and the ones of the row kept instead
+      void setConflictReport( const DataSetWriterPtr& conflictReport );
+
+      //Only rows accepted by the filter, evaluated on the merged columns,
+      //are written. Row numbers in reports still count dropped rows
+      void setRowFilter( const RowFilterPtr& rowFilter );
+
+      //Bytes written for every source in the last merge
+      std::vector< size_t > getSourceSizes( void ) const;
+
+    private:
+
+      struct Block;
+      struct SourceBlocks;
+      struct BlockPool;
+
+      std::vector< std::string > _headers;
+      size_t _workers;
+      std::string _error;
+      std::string _cacheFolder;
+      BuildProgressPtr _progress;
+      bool _writeHeaders;
+      std::vector< size_t > _sourceSizes;
+      NullBitmapWriterPtr _nullBitmap;
+      DuplicateFilterPtr _duplicateFilter;
+      std::vector< size_t > _keyColumns;
+      DataSetWriterPtr _conflictReport;
+      RowFilterPtr _rowFilter;
+
+      bool isCanceled( void ) const;
+      bool isFiltered( void ) const;
+      //Without writer, only records the rows of a KeepLast filter
+      bool mergePass( const std::vector< std::string >& sourcePaths,
+        DataSetWriter* writer );
+      bool writeBlock( const std::vector< std::string >& sourcePaths,
+        const size_t& source, const Block& block, DataSetWriter* writer );
+      void projectSource( const std::string& sourcePath,
+        SourceBlocks& sourceBlocks );
+  };
+
+}
+
+#endif
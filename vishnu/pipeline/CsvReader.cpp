@@ -0,0 +1,416 @@
+/*
+ * Vishnu
+ * Copyright (c) 2017-2019 GMRV/URJC.
+ *
+ * Authors: Gonzalo Bayo Martinez <gonzalo.bayo@urjc.es>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "CsvReader.h"
+
+#include <cstring>
+#include <limits>
+
+//AVX2 is used when enabled at compile time or, on x86 compilers that can
+//target it per function, when the CPU supports it at run time
+#if defined( __AVX2__ )
+  #include <immintrin.h>
+  #define VISHNU_CSV_AVX2
+#elif ( defined( __GNUC__ ) && ( defined( __x86_64__ ) \
+  || defined( __i386__ ) ) ) || defined( _M_X64 )
+  #include <immintrin.h>
+  #define VISHNU_CSV_AVX2
+  #define VISHNU_CSV_AVX2_DISPATCH
+#endif
+#if defined( __SSE2__ ) || defined( _M_X64 ) \
+  || ( defined( _M_IX86_FP ) && _M_IX86_FP >= 2 )
+  #include <emmintrin.h>
+  #define VISHNU_CSV_SSE2
+#endif
+#ifdef _MSC_VER
+  #include <intrin.h>
+#endif
+
+#if defined( VISHNU_CSV_AVX2_DISPATCH ) && defined( __GNUC__ )
+  #define VISHNU_CSV_AVX2_TARGET __attribute__( ( target( "avx2" ) ) )
+#else
+  #define VISHNU_CSV_AVX2_TARGET
+#endif
+
+namespace vishnu
+{
+
+  namespace
+  {
+    inline unsigned int firstBit( const unsigned int& mask )
+    {
+#ifdef _MSC_VER
+      unsigned long index;
+      _BitScanForward( &index, mask );
+      return static_cast< unsigned int >( index );
+#else
+      return static_cast< unsigned int >( __builtin_ctz( mask ) );
+#endif
+    }
+
+#ifdef VISHNU_CSV_AVX2
+    bool hasAvx2( void )
+    {
+#if !defined( VISHNU_CSV_AVX2_DISPATCH )
+      return true;
+#elif defined( _MSC_VER )
+      //Supported by the CPU (leaf 7) and its registers saved by the OS
+      int info[ 4 ];
+      __cpuid( info, 0 );
+      if ( info[ 0 ] < 7 )
+      {
+        return false;
+      }
+      __cpuid( info, 1 );
+      bool osSaved = ( info[ 2 ] & ( 1 << 27 ) ) != 0
+        && ( info[ 2 ] & ( 1 << 28 ) ) != 0 && ( _xgetbv( 0 ) & 6 ) == 6;
+      __cpuidex( info, 7, 0 );
+      return osSaved && ( info[ 1 ] & ( 1 << 5 ) ) != 0;
+#else
+      //Run during static initialization, before the CPU model is set up
+      __builtin_cpu_init( );
+      return __builtin_cpu_supports( "avx2" ) != 0;
+#endif
+    }
+
+    const bool CPU_AVX2 = hasAvx2( );
+
+    //Scans 32 bytes at a time while they fit, moving current to the first
+    //match (returning true) or to the unscanned tail
+    VISHNU_CSV_AVX2_TARGET bool findAnyAvx2( const char*& current,
+      const char* end, const char a, const char b, const char c )
+    {
+      const __m256i a32 = _mm256_set1_epi8( a );
+      const __m256i b32 = _mm256_set1_epi8( b );
+      const __m256i c32 = _mm256_set1_epi8( c );
+      while ( end - current >= 32 )
+      {
+        __m256i chunk = _mm256_loadu_si256(
+          reinterpret_cast< const __m256i* >( current ) );
+        __m256i matches = _mm256_or_si256(
+          _mm256_or_si256( _mm256_cmpeq_epi8( chunk, a32 ),
+          _mm256_cmpeq_epi8( chunk, b32 ) ),
+          _mm256_cmpeq_epi8( chunk, c32 ) );
+        unsigned int mask = static_cast< unsigned int >(
+          _mm256_movemask_epi8( matches ) );
+        if ( mask != 0 )
+        {
+          current += firstBit( mask );
+          return true;
+        }
+        current += 32;
+      }
+      return false;
+    }
+#endif
+
+    //First character in [begin, end) equal to a, b or c (end if none)
+    const char* findAny( const char* begin, const char* end, const char a,
+      const char b, const char c )
+    {
+      const char* current = begin;
+#ifdef VISHNU_CSV_AVX2
+      if ( CPU_AVX2 && findAnyAvx2( current, end, a, b, c ) )
+      {
+        return current;
+      }
+#endif
+#ifdef VISHNU_CSV_SSE2
+      const __m128i a16 = _mm_set1_epi8( a );
+      const __m128i b16 = _mm_set1_epi8( b );
+      const __m128i c16 = _mm_set1_epi8( c );
+      while ( end - current >= 16 )
+      {
+        __m128i chunk = _mm_loadu_si128(
+          reinterpret_cast< const __m128i* >( current ) );
+        __m128i matches = _mm_or_si128(
+          _mm_or_si128( _mm_cmpeq_epi8( chunk, a16 ),
+          _mm_cmpeq_epi8( chunk, b16 ) ),
+          _mm_cmpeq_epi8( chunk, c16 ) );
+        unsigned int mask = static_cast< unsigned int >(
+          _mm_movemask_epi8( matches ) );
+        if ( mask != 0 )
+        {
+          return current + firstBit( mask );
+        }
+        current += 16;
+      }
+#endif
+      while ( current < end && *current != a && *current != b
+        && *current != c )
+      {
+        ++current;
+      }
+      return current;
+    }
+
+    //First c in [begin, end) (end if none). memchr is already vectorized
+    //by the C library for the running CPU
+    const char* find( const char* begin, const char* end, const char c )
+    {
+      const void* found = std::memchr( begin, c,
+        static_cast< size_t >( end - begin ) );
+      return ( found == nullptr ) ? end : static_cast< const char* >( found );
+    }
+  }
+
+  CsvReader::CsvReader( const std::string& path, const char& separator )
+    : _file( path )
+    , _position( nullptr )
+    , _end( nullptr )
+    , _separator( separator )
+    , _recordNumber( 0 )
+    , _projected( false )
+    , _usedColumns( 0 )
+    , _unescapedUsed( 0 )
+  {
+    if ( _file.isOpen( ) && _file.getData( ) != nullptr )
+    {
+      _position = _file.getData( );
+      _end = _position + _file.getSize( );
+
+      //Skip UTF-8 byte order mark
+      if ( _end - _position >= 3 && _position[ 0 ] == '\xEF'
+        && _position[ 1 ] == '\xBB' && _position[ 2 ] == '\xBF' )
+      {
+        _position += 3;
+      }
+    }
+  }
+
+  CsvReader::~CsvReader( void )
+  {
+
+  }
+
+  bool CsvReader::isOpen( void ) const
+  {
+    return _file.isOpen( );
+  }
+
+  bool CsvReader::readRecord( std::vector< StringView >& fields )
+  {
+    if ( !_projected )
+    {
+      return parseRecord( fields, std::numeric_limits< size_t >::max( ) );
+    }
+
+    if ( !parseRecord( _record, _usedColumns ) )
+    {
+      return false;
+    }
+    fields.resize( _projection.size( ) );
+    for ( size_t i = 0; i < _projection.size( ); ++i )
+    {
+      int column = _projection[ i ];
+      if ( column >= 0 && static_cast< size_t >( column ) < _record.size( ) )
+      {
+        fields[ i ] = _record[ column ];
+      }
+      else
+      {
+        fields[ i ] = StringView( _missingValue );
+      }
+    }
+    return true;
+  }
+
+  bool CsvReader::readRecord( std::vector< std::string >& fields )
+  {
+    std::vector< StringView > views;
+    if ( !readRecord( views ) )
+    {
+      return false;
+    }
+    fields.resize( views.size( ) );
+    for ( size_t i = 0; i < views.size( ); ++i )
+    {
+      fields[ i ].assign( views[ i ].data, views[ i ].size );
+    }
+    return true;
+  }
+
+  bool CsvReader::readHeaders( std::vector< std::string >& headers )
+  {
+    std::vector< StringView > fields;
+    if ( !parseRecord( fields, std::numeric_limits< size_t >::max( ) ) )
+    {
+      return false;
+    }
+    headers.resize( fields.size( ) );
+    for ( size_t i = 0; i < fields.size( ); ++i )
+    {
+      fields[ i ].trim( );
+      headers[ i ] = fields[ i ].str( );
+    }
+    return true;
+  }
+
+  void CsvReader::setProjection( const std::vector< int >& columns,
+    const std::string& missingValue )
+  {
+    _projected = true;
+    _projection = columns;
+    _missingValue = missingValue;
+
+    //Fields after the last used column are not stored
+    _usedColumns = 0;
+    for ( const auto& column : columns )
+    {
+      if ( column >= 0 && static_cast< size_t >( column ) >= _usedColumns )
+      {
+        _usedColumns = static_cast< size_t >( column ) + 1;
+      }
+    }
+  }
+
+  size_t CsvReader::getRecordNumber( void ) const
+  {
+    return _recordNumber;
+  }
+
+  size_t CsvReader::getPosition( void ) const
+  {
+    return ( _position == nullptr ) ? 0
+      : static_cast< size_t >( _position - _file.getData( ) );
+  }
+
+  size_t CsvReader::getSize( void ) const
+  {
+    return _file.getSize( );
+  }
+
+  void CsvReader::trim( std::string& field )
+  {
+    const char* whitespaces = " \t\n\r\f\v";
+    size_t last = field.find_last_not_of( whitespaces );
+    if ( last == std::string::npos )
+    {
+      field.clear( );
+      return;
+    }
+    field.erase( last + 1 );
+    field.erase( 0, field.find_first_not_of( whitespaces ) );
+  }
+
+  bool CsvReader::parseRecord( std::vector< StringView >& fields,
+    const size_t& maxFields )
+  {
+    fields.clear( );
+    _unescapedUsed = 0;
+
+    //Skip empty lines
+    while ( _position < _end && ( *_position == '\n' || *_position == '\r' ) )
+    {
+      ++_position;
+    }
+    if ( _position >= _end )
+    {
+      return false;
+    }
+    ++_recordNumber;
+
+    size_t fieldsCount = 0;
+    while ( true )
+    {
+      bool store = ( fieldsCount < maxFields );
+      if ( _position < _end && *_position == '"' )
+      {
+        const char* begin = ++_position;
+        const char* fieldEnd = _end;
+        bool escaped = false;
+        while ( true )
+        {
+          const char* quote = find( _position, _end, '"' );
+          if ( quote == _end )
+          {
+            //Unterminated quoted field
+            _position = _end;
+            break;
+          }
+          if ( quote + 1 < _end && quote[ 1 ] == '"' )
+          {
+            escaped = true;
+            _position = quote + 2;
+            continue;
+          }
+          fieldEnd = quote;
+          _position = quote + 1;
+          break;
+        }
+        if ( store )
+        {
+          StringView field( begin, static_cast< size_t >( fieldEnd - begin ) );
+          fields.emplace_back( escaped ? unescape( field ) : field );
+        }
+        //Characters between closing quote and separator are ignored
+        _position = findAny( _position, _end, _separator, '\n', '\r' );
+      }
+      else
+      {
+        const char* fieldEnd = findAny( _position, _end, _separator, '\n',
+          '\r' );
+        if ( store )
+        {
+          fields.emplace_back( _position,
+            static_cast< size_t >( fieldEnd - _position ) );
+        }
+        _position = fieldEnd;
+      }
+      ++fieldsCount;
+
+      if ( _position >= _end )
+      {
+        return true;
+      }
+      char terminator = *_position++;
+      if ( terminator == _separator )
+      {
+        continue;
+      }
+      if ( terminator == '\r' && _position < _end && *_position == '\n' )
+      {
+        ++_position;
+      }
+      return true;
+    }
+  }
+
+  StringView CsvReader::unescape( const StringView& field )
+  {
+    if ( _unescapedUsed == _unescaped.size( ) )
+    {
+      _unescaped.emplace_back( );
+    }
+    std::string& unescaped = _unescaped[ _unescapedUsed++ ];
+    unescaped.clear( );
+    for ( size_t i = 0; i < field.size; ++i )
+    {
+      unescaped += field.data[ i ];
+      if ( field.data[ i ] == '"' && i + 1 < field.size
+        && field.data[ i + 1 ] == '"' )
+      {
+        ++i;
+      }
+    }
+    return StringView( unescaped );
+  }
+
+}
@@ -0,0 +1,102 @@
+/*
+ * Vishnu
+ * Copyright (c) 2017-2019 GMRV/URJC.
+ *
+ * Authors: Gonzalo Bayo Martinez <gonzalo.bayo@urjc.es>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef VISHNU_CSVREADER_H
+#define VISHNU_CSVREADER_H
+
+#include <deque>
+#include <string>
+#include <vector>
+#include <memory>
+
+#include "MappedFile.h"
+#include "RecordReader.h"
+
+namespace vishnu
+{
+
+  class CsvReader;
+  using CsvReaderPtr = std::shared_ptr< CsvReader >;
+
+  /*
+   * Sequential CSV reader over a memory mapped file. Field and record
+   * boundaries are found with vectorized scanning: AVX2 when enabled at
+   * compile time or supported by the CPU at run time (on x86 with GCC,
+   * Clang or MSVC), SSE2 when available, scalar otherwise. Quoted fields
+   * may contain separators, line breaks and escaped ("") quotes.
+   */
+  class CsvReader : public RecordReader
+  {
+
+    public:
+
+      explicit CsvReader( const std::string& path,
+        const char& separator = ',' );
+      ~CsvReader( void ) override;
+
+      bool isOpen( void ) const override;
+
+      //Reads next non empty record. Views point into the mapped file and are
+      //valid until the next read. Returns false at end of file
+      bool readRecord( std::vector< StringView >& fields ) override;
+
+      //Same as above, copying fields into fields storage
+      bool readRecord( std::vector< std::string >& fields );
+
+      //Reads first record with trimmed fields
+      bool readHeaders( std::vector< std::string >& headers ) override;
+
+      //Restricts next records to the given source columns, in that order.
+      //Columns set to -1 or not present in a record get missingValue. Other
+      //columns are skipped without being copied
+      void setProjection( const std::vector< int >& columns,
+        const std::string& missingValue ) override;
+
+      size_t getRecordNumber( void ) const;
+
+      //Bytes consumed and total bytes of the file
+      size_t getPosition( void ) const override;
+      size_t getSize( void ) const override;
+
+      static void trim( std::string& field );
+
+    private:
+
+      MappedFile _file;
+      const char* _position;
+      const char* _end;
+      char _separator;
+      size_t _recordNumber;
+      bool _projected;
+      std::vector< int > _projection;
+      size_t _usedColumns;
+      std::string _missingValue;
+      std::vector< StringView > _record;
+      std::deque< std::string > _unescaped;
+      size_t _unescapedUsed;
+
+      bool parseRecord( std::vector< StringView >& fields,
+        const size_t& maxFields );
+      StringView unescape( const StringView& field );
+  };
+
+}
+
+#endif
@@ -0,0 +1,1288 @@
+/*
+ * Vishnu
+ * Copyright (c) 2017-2019 GMRV/URJC.
+ *
+ * Authors: Gonzalo Bayo Martinez <gonzalo.bayo@urjc.es>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "DataSetBuilder.h"
+
+#include <algorithm>
+#include <cstdio>
+
+#include <QDir>
+#include <QDirIterator>
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QXmlStreamWriter>
+
+#include "CsvFormat.h"
+#include "CsvJoiner.h"
+#include "CsvMerger.h"
+#include "ExternalSorter.h"
+#include "MappedFile.h"
+#include "../Definitions.hpp"
+
+namespace vishnu
+{
+
+  DataSetBuilder::DataSetBuilder(
+    const vishnucommon::DataSetsPtr& resultDataSets,
+    const std::vector< std::string >& sourcePaths, const std::string& path,
+    const std::string& csvPath, const std::string& jsonPath,
+    const std::string& xmlPath )
+    : _resultDataSets( resultDataSets )
+    , _sourcePaths( sourcePaths )
+    , _path( path )
+    , _csvPath( csvPath )
+    , _jsonPath( jsonPath )
+    , _xmlPath( xmlPath )
+    , _manifestPath( jsonPath + std::string( "." ) + STR_EXT_MANIFEST )
+    , _geometryManifestPath( path + std::string( "/" )
+        + FILE_GEOMETRY_MANIFEST )
+    , _geometryIndexPath( path + std::string( "/" ) + FILE_GEOMETRY_INDEX )
+    , _geometryArchivePath( path + std::string( "/" )
+        + FILE_GEOMETRY_ARCHIVE )
+    , _nullBitmapPath( csvPath + std::string( "." ) + STR_EXT_NULLS )
+    , _conflictReportPath( csvPath + std::string( "." ) + STR_EXT_CONFLICTS
+        + std::string( "." ) + STR_EXT_CSV )
+    , _progress( new BuildProgress( ) )
+    , _join( false )
+    , _joinMemoryBudget( DEFAULT_JOIN_MEMORY_BUDGET )
+    , _tempFolder( QDir::tempPath( ).toStdString( ) )
+    , _sparse( false )
+    , _duplicatePolicy( DuplicateFilter::Policy::KeepAll )
+    , _sort( false )
+    , _sortMemoryBudget( DEFAULT_SORT_MEMORY_BUDGET )
+    , _geometryStaging( GeometryStager::Mode::Copy )
+    , _geometryWorkers( 0 )
+    , _geometrySync( false )
+    , _geometryHash( false )
+    , _geometryArchive( false )
+    , _geometryCompression( 0 )
+    , _headerSize( 0 )
+    , _csvAppended( false )
+    , _csvAppendOffset( 0 )
+    , _geometryRestage( false )
+  {
+
+  }
+
+  DataSetBuilder::~DataSetBuilder( void )
+  {
+
+  }
+
+  bool DataSetBuilder::build( void )
+  {
+    _error.clear( );
+    _createdFiles.clear( );
+    _outputs.clear( );
+    _csvAppended = false;
+
+    _sourceFingerprints.assign( _sourcePaths.size( ), FileFingerprint( ) );
+    for ( size_t i = 0; i < _sourcePaths.size( ); ++i )
+    {
+      FileFingerprint::compute( _sourcePaths.at( i ),
+        _sourceFingerprints.at( i ) );
+    }
+    _resultDataSets->getDataSets( ).at( 0 )->setPath( _csvPath );
+    _schema = QJsonObject( );
+    _resultDataSets->serialize( _schema );
+    if ( _sparse )
+    {
+      _schema.insert( STR_NULLBITMAP, QString::fromStdString( _nullBitmapPath ) );
+    }
+
+    readManifest( );
+    _geometryRestage = _manifest && !isGeometryUpToDate( );
+    if ( isUpToDate( ) )
+    {
+      //Geometry files aren't listed in the manifest, synced files are
+      //checked anyway. The XML file and the geometric data are written
+      //again when their source, staging mode, store or packing changed,
+      //keeping the CSV file
+      bool result = true;
+      if ( !isGeometryUpToDate( ) )
+      {
+        _manifestSources = _manifest->getSources( );
+        _headerSize = _manifest->getHeaderSize( );
+        result = createXML( ) && createGeometricData( ) && commitOutputs( )
+          && writeManifest( );
+      }
+      else if ( _geometrySync )
+      {
+        result = createGeometricData( );
+      }
+      if ( !result )
+      {
+        removeCreatedFiles( );
+        if ( isCanceled( ) )
+        {
+          _error = "Dataset creation canceled.";
+        }
+      }
+      _progress->setStage( BuildProgress::Stage::Finished, 0 );
+      return result;
+    }
+    bool result = createCSV( ) && createJSON( ) && createXML( )
+      && createGeometricData( ) && commitOutputs( ) && writeManifest( );
+    if ( !result )
+    {
+      removeCreatedFiles( );
+      if ( isCanceled( ) )
+      {
+        _error = "Dataset creation canceled.";
+      }
+    }
+    _progress->setStage( BuildProgress::Stage::Finished, 0 );
+    return result;
+  }
+
+  std::string DataSetBuilder::getError( void ) const
+  {
+    return _error;
+  }
+
+  bool DataSetBuilder::isCanceled( void ) const
+  {
+    return _progress->isCanceled( );
+  }
+
+  void DataSetBuilder::setProgress( const BuildProgressPtr& progress )
+  {
+    _progress = progress;
+  }
+
+  BuildProgressPtr DataSetBuilder::getProgress( void ) const
+  {
+    return _progress;
+  }
+
+  void DataSetBuilder::setJoin( const bool& join )
+  {
+    _join = join;
+  }
+
+  void DataSetBuilder::setCacheFolder( const std::string& cacheFolder )
+  {
+    _cacheFolder = cacheFolder;
+  }
+
+  void DataSetBuilder::setJoinMemoryBudget( const size_t& joinMemoryBudget )
+  {
+    _joinMemoryBudget = joinMemoryBudget;
+  }
+
+  void DataSetBuilder::setTempFolder( const std::string& tempFolder )
+  {
+    _tempFolder = tempFolder;
+  }
+
+  void DataSetBuilder::setSparse( const bool& sparse )
+  {
+    _sparse = sparse;
+  }
+
+  void DataSetBuilder::setDuplicatePolicy(
+    const DuplicateFilter::Policy& duplicatePolicy )
+  {
+    _duplicatePolicy = duplicatePolicy;
+  }
+
+  void DataSetBuilder::setSort( const bool& sort )
+  {
+    _sort = sort;
+  }
+
+  void DataSetBuilder::setSortMemoryBudget( const size_t& sortMemoryBudget )
+  {
+    _sortMemoryBudget = sortMemoryBudget;
+  }
+
+  void DataSetBuilder::setRowFilter( const std::string& rowFilter )
+  {
+    _rowFilterExpression = rowFilter;
+  }
+
+  void DataSetBuilder::setGeometrySource( const std::string& geometrySource )
+  {
+    _geometrySource = geometrySource;
+  }
+
+  void DataSetBuilder::setGeometryStaging(
+    const GeometryStager::Mode& geometryStaging )
+  {
+    _geometryStaging = geometryStaging;
+  }
+
+  void DataSetBuilder::setGeometryWorkers( const size_t& geometryWorkers )
+  {
+    _geometryWorkers = geometryWorkers;
+  }
+
+  void DataSetBuilder::setGeometrySync( const bool& geometrySync )
+  {
+    _geometrySync = geometrySync;
+  }
+
+  void DataSetBuilder::setGeometryHash( const bool& geometryHash )
+  {
+    _geometryHash = geometryHash;
+  }
+
+  void DataSetBuilder::setGeometryStore( const std::string& geometryStore )
+  {
+    _geometryStore = geometryStore;
+  }
+
+  void DataSetBuilder::setGeometryArchive( const bool& geometryArchive )
+  {
+    _geometryArchive = geometryArchive;
+  }
+
+  void DataSetBuilder::setGeometryCompression( const int& geometryCompression )
+  {
+    _geometryCompression = geometryCompression;
+  }
+
+  bool DataSetBuilder::isJoined( void ) const
+  {
+    return _join
+      && !_resultDataSets->getPropertyGroups( )->getUsedPrimaryKeys( ).empty( );
+  }
+
+  bool DataSetBuilder::isFiltered( void ) const
+  {
+    return !isJoined( ) && _duplicatePolicy != DuplicateFilter::Policy::KeepAll;
+  }
+
+  bool DataSetBuilder::isSorted( void ) const
+  {
+    return _sort
+      && !_resultDataSets->getPropertyGroups( )->getUsedPrimaryKeys( ).empty( );
+  }
+
+  bool DataSetBuilder::canReuseRows( void ) const
+  {
+    //The null bitmap has no source ranges, duplicates depend on every
+    //previous row and sorted rows are no longer grouped by source
+    return !_sparse && !isFiltered( ) && !isSorted( );
+  }
+
+  std::string DataSetBuilder::getMergePath( void ) const
+  {
+    return isSorted( ) ? _csvPath + std::string( ".unsorted.tmp" )
+      : getTempPath( _csvPath );
+  }
+
+  std::string DataSetBuilder::getTempPath( const std::string& path ) const
+  {
+    return path + std::string( ".tmp" );
+  }
+
+  void DataSetBuilder::readManifest( void )
+  {
+    _manifest.reset( );
+    if ( !vishnucommon::Files::exist( _manifestPath ) )
+    {
+      return;
+    }
+    BuildManifestPtr manifest =
+      vishnucommon::JSON::deserialize< BuildManifest >( _manifestPath );
+
+    //Only usable if it describes the CSV file as it is now
+    DuplicateFilter::Policy duplicatePolicy = isFiltered( )
+      ? _duplicatePolicy : DuplicateFilter::Policy::KeepAll;
+    FileFingerprint csvFingerprint;
+    if ( !manifest || manifest->getJoin( ) != isJoined( )
+      || manifest->getSort( ) != isSorted( )
+      || manifest->getRowFilter( ) != _rowFilterExpression
+      || DuplicateFilter::toPolicy( manifest->getDuplicatePolicy( ) )
+        != duplicatePolicy
+      || manifest->getSchema( ) != _schema
+      || !FileFingerprint::compute( _csvPath, csvFingerprint )
+      || csvFingerprint != manifest->getCsvFingerprint( ) )
+    {
+      return;
+    }
+    if ( !manifest->getJoin( ) && !manifest->getSort( ) )
+    {
+      uint64_t size = manifest->getHeaderSize( );
+      for ( const auto& source : manifest->getSources( ) )
+      {
+        if ( source.offset != size )
+        {
+          return;
+        }
+        size += source.size;
+      }
+      if ( size != csvFingerprint.size )
+      {
+        return;
+      }
+    }
+    _manifest = manifest;
+  }
+
+  bool DataSetBuilder::isUpToDate( void ) const
+  {
+    if ( !_manifest || !vishnucommon::Files::exist( _jsonPath )
+      || !vishnucommon::Files::exist( _xmlPath )
+      || ( _sparse && !vishnucommon::Files::exist( _nullBitmapPath ) ) )
+    {
+      return false;
+    }
+    BuildManifest::Sources sources = _manifest->getSources( );
+    if ( sources.size( ) != _sourcePaths.size( ) )
+    {
+      return false;
+    }
+    for ( size_t i = 0; i < sources.size( ); ++i )
+    {
+      if ( sources.at( i ).path != _sourcePaths.at( i )
+        || sources.at( i ).fingerprint != _sourceFingerprints.at( i ) )
+      {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  bool DataSetBuilder::isGeometryUpToDate( void ) const
+  {
+    if ( !_manifest || _manifest->getGeometryArchive( ) != _geometryArchive
+      || _manifest->getGeometrySource( ) != _geometrySource )
+    {
+      return false;
+    }
+    if ( _geometryArchive )
+    {
+      return _manifest->getGeometryCompression( ) == _geometryCompression
+        && vishnucommon::Files::exist( _geometryArchivePath );
+    }
+    //Staging modes and the store don't apply to archives
+    return _manifest->getGeometryStaging( )
+      == GeometryStager::toString( _geometryStaging )
+      && _manifest->getGeometryStore( ) == _geometryStore;
+  }
+
+  bool DataSetBuilder::writeManifest( void )
+  {
+    FileFingerprint csvFingerprint;
+    if ( !FileFingerprint::compute( _csvPath, csvFingerprint ) )
+    {
+      _error = "Can't read " + _csvPath + " file.";
+      return false;
+    }
+
+    BuildManifestPtr manifest( new BuildManifest( ) );
+    manifest->setSources( _manifestSources );
+    manifest->setSchema( _schema );
+    manifest->setJoin( isJoined( ) );
+    manifest->setSort( isSorted( ) );
+    manifest->setRowFilter( _rowFilterExpression );
+    manifest->setGeometrySource( _geometrySource );
+    manifest->setGeometryStaging(
+      GeometryStager::toString( _geometryStaging ) );
+    manifest->setGeometryStore( _geometryStore );
+    manifest->setGeometryArchive( _geometryArchive );
+    manifest->setGeometryCompression( _geometryCompression );
+    if ( isFiltered( ) )
+    {
+      manifest->setDuplicatePolicy(
+        DuplicateFilter::toString( _duplicatePolicy ) );
+    }
+    manifest->setHeaderSize( _headerSize );
+    manifest->setCsvFingerprint( csvFingerprint );
+    _createdFiles.emplace_back( _manifestPath );
+    if ( !vishnucommon::JSON::serialize( _manifestPath, manifest ) )
+    {
+      _error = "Can't create " + _manifestPath + " file.";
+      return false;
+    }
+    return true;
+  }
+
+  bool DataSetBuilder::createCSV( void )
+  {
+    size_t total = 0;
+    for ( const auto& sourceFingerprint : _sourceFingerprints )
+    {
+      total += static_cast< size_t >( sourceFingerprint.size );
+    }
+    //Keeping the last duplicates reads every source twice
+    if ( isFiltered( )
+      && _duplicatePolicy == DuplicateFilter::Policy::KeepLast )
+    {
+      total *= 2;
+    }
+    _progress->setStage( BuildProgress::Stage::CSV, total );
+    _manifestSources.clear( );
+    _headerSize = 0;
+
+    //Get headers (ordered, first pk headers, then non pk headers)
+    vishnucommon::PropertyGroupsPtr propertyGroups =
+      _resultDataSets->getPropertyGroups( );
+    std::vector< std::string > selectedHeaders = propertyGroups->getHeaders( );
+
+    _rowFilter.reset( );
+    if ( _rowFilterExpression.find_first_not_of( " \t\r\n" )
+      != std::string::npos )
+    {
+      _rowFilter.reset( new RowFilter( ) );
+      if ( !_rowFilter->parse( _rowFilterExpression, selectedHeaders ) )
+      {
+        _error = "Invalid row filter: " + _rowFilter->getError( );
+        return false;
+      }
+    }
+
+    if ( _sparse )
+    {
+      _nullBitmap.reset( new NullBitmapWriter(
+        getTempPath( _nullBitmapPath ), selectedHeaders.size( ) ) );
+      _createdFiles.emplace_back( getTempPath( _nullBitmapPath ) );
+    }
+    bool result = isJoined( ) ? joinCSV( selectedHeaders )
+      : mergeCSV( selectedHeaders );
+    if ( result && isSorted( ) )
+    {
+      result = sortCSV( selectedHeaders );
+    }
+    if ( _nullBitmap )
+    {
+      if ( !_nullBitmap->close( ) && result )
+      {
+        _error = _nullBitmap->getError( );
+        result = false;
+      }
+      _nullBitmap.reset( );
+    }
+    if ( result && !_csvAppended )
+    {
+      _outputs.emplace_back( _csvPath );
+      if ( _sparse )
+      {
+        _outputs.emplace_back( _nullBitmapPath );
+      }
+      if ( isFiltered( ) )
+      {
+        _outputs.emplace_back( _conflictReportPath );
+      }
+    }
+    return result;
+  }
+
+  bool DataSetBuilder::joinCSV( const std::vector< std::string >& headers )
+  {
+    //Joined rows depend on every source, so they are always joined again
+    for ( size_t i = 0; i < _sourcePaths.size( ); ++i )
+    {
+      BuildManifest::Source source;
+      source.path = _sourcePaths.at( i );
+      source.fingerprint = _sourceFingerprints.at( i );
+      _manifestSources.emplace_back( source );
+    }
+
+    DataSetWriter writer( getMergePath( ) );
+    _createdFiles.emplace_back( getMergePath( ) );
+    CsvJoiner csvJoiner( headers,
+      _resultDataSets->getPropertyGroups( )->getUsedPrimaryKeys( ),
+      _joinMemoryBudget, _tempFolder );
+    csvJoiner.setCacheFolder( _cacheFolder );
+    csvJoiner.setProgress( _progress );
+    csvJoiner.setRowFilter( _rowFilter );
+    if ( !isSorted( ) )
+    {
+      csvJoiner.setNullBitmap( _nullBitmap );
+    }
+    if ( !csvJoiner.join( _sourcePaths, writer ) )
+    {
+      writer.close( );
+      _error = csvJoiner.getError( );
+      return false;
+    }
+    return closeWriter( writer );
+  }
+
+  bool DataSetBuilder::mergeCSV( const std::vector< std::string >& headers )
+  {
+    //Previous rows of every source that is still there and didn't change
+    bool reusable = canReuseRows( );
+    BuildManifest::Sources oldSources;
+    if ( _manifest && reusable )
+    {
+      oldSources = _manifest->getSources( );
+    }
+    std::vector< const BuildManifest::Source* > reused(
+      _sourcePaths.size( ), nullptr );
+    bool reuse = false;
+    for ( size_t i = 0; i < _sourcePaths.size( ); ++i )
+    {
+      for ( const auto& oldSource : oldSources )
+      {
+        if ( oldSource.path == _sourcePaths.at( i )
+          && oldSource.fingerprint == _sourceFingerprints.at( i ) )
+        {
+          reused.at( i ) = &oldSource;
+          reuse = true;
+          break;
+        }
+      }
+    }
+    size_t kept = 0;
+    while ( kept < oldSources.size( ) && kept < _sourcePaths.size( )
+      && reused.at( kept ) == &oldSources.at( kept ) )
+    {
+      ++kept;
+    }
+    for ( size_t i = 0; i < _sourcePaths.size( ); ++i )
+    {
+      if ( reused.at( i ) != nullptr )
+      {
+        _progress->addDone(
+          static_cast< size_t >( _sourceFingerprints.at( i ).size ) );
+      }
+    }
+
+    //Only sources were added: their rows are appended to the result
+    if ( _manifest && reusable && kept == oldSources.size( ) )
+    {
+      _headerSize = _manifest->getHeaderSize( );
+      _manifestSources = oldSources;
+
+      //Appended rows are truncated away on failure. Until then the CSV
+      //fingerprint no longer matches the manifest
+      _csvAppended = true;
+      _csvAppendOffset = _manifest->getCsvFingerprint( ).size;
+      DataSetWriter writer( _csvPath, DEFAULT_WRITE_BUFFER_SIZE, true );
+      if ( !mergeSources( headers, kept, _sourcePaths.size( ),
+        _manifest->getCsvFingerprint( ).size, writer ) )
+      {
+        writer.close( );
+        return false;
+      }
+      return closeWriter( writer );
+    }
+
+    //Otherwise the result is rewritten, copying the rows of unchanged
+    //sources from the previous one
+    std::string csvPath = getMergePath( );
+    std::unique_ptr< MappedFile > oldCsv;
+    if ( reuse )
+    {
+      oldCsv.reset( new MappedFile( _csvPath ) );
+      if ( !oldCsv->isOpen( ) )
+      {
+        _error = "Can't open " + _csvPath + " file.";
+        return false;
+      }
+    }
+
+    DataSetWriter writer( csvPath );
+    _createdFiles.emplace_back( csvPath );
+    writer.writeLine( joinCsvFields( headers ) );
+    _headerSize = writer.getBytesWritten( );
+    size_t i = 0;
+    while ( i < _sourcePaths.size( ) )
+    {
+      if ( reused.at( i ) != nullptr )
+      {
+        BuildManifest::Source source = *reused.at( i );
+        writer.write( oldCsv->getData( ) + source.offset,
+          static_cast< size_t >( source.size ) );
+        source.offset = writer.getBytesWritten( ) - source.size;
+        _manifestSources.emplace_back( source );
+        ++i;
+        continue;
+      }
+      size_t end = i;
+      while ( end < _sourcePaths.size( ) && reused.at( end ) == nullptr )
+      {
+        ++end;
+      }
+      if ( !mergeSources( headers, i, end, 0, writer ) )
+      {
+        writer.close( );
+        return false;
+      }
+      i = end;
+    }
+    return closeWriter( writer );
+  }
+
+  bool DataSetBuilder::sortCSV( const std::vector< std::string >& headers )
+  {
+    //Every merged byte is read once and written once
+    std::string mergePath = getMergePath( );
+    FileFingerprint mergeFingerprint;
+    FileFingerprint::stat( mergePath, mergeFingerprint );
+    _progress->setStage( BuildProgress::Stage::Sort,
+      2 * static_cast< size_t >( mergeFingerprint.size ) );
+
+    DataSetWriter writer( getTempPath( _csvPath ) );
+    _createdFiles.emplace_back( getTempPath( _csvPath ) );
+    ExternalSorter externalSorter( headers,
+      _resultDataSets->getPropertyGroups( )->getUsedPrimaryKeys( ),
+      _sortMemoryBudget, _tempFolder );
+    externalSorter.setProgress( _progress );
+    externalSorter.setNullBitmap( _nullBitmap );
+    bool result = externalSorter.sort( mergePath, writer );
+    std::remove( mergePath.c_str( ) );
+    if ( !result )
+    {
+      writer.close( );
+      _error = externalSorter.getError( );
+      return false;
+    }
+    return closeWriter( writer );
+  }
+
+  bool DataSetBuilder::mergeSources( const std::vector< std::string >& headers,
+    const size_t& begin, const size_t& end, const uint64_t& baseOffset,
+    DataSetWriter& writer )
+  {
+    std::vector< std::string > sourcePaths( _sourcePaths.begin( ) + begin,
+      _sourcePaths.begin( ) + end );
+    uint64_t offset = baseOffset + writer.getBytesWritten( );
+
+    CsvMerger csvMerger( headers );
+    csvMerger.setCacheFolder( _cacheFolder );
+    csvMerger.setProgress( _progress );
+    csvMerger.setWriteHeaders( false );
+    csvMerger.setRowFilter( _rowFilter );
+    if ( !isSorted( ) )
+    {
+      csvMerger.setNullBitmap( _nullBitmap );
+    }
+    DataSetWriterPtr conflictReport;
+    if ( isFiltered( ) )
+    {
+      conflictReport.reset( new DataSetWriter(
+        getTempPath( _conflictReportPath ) ) );
+      _createdFiles.emplace_back( getTempPath( _conflictReportPath ) );
+      csvMerger.setDuplicateFilter( DuplicateFilterPtr(
+        new DuplicateFilter( _duplicatePolicy ) ),
+        _resultDataSets->getPropertyGroups( )->getUsedPrimaryKeys( ) );
+      csvMerger.setConflictReport( conflictReport );
+    }
+    if ( !csvMerger.merge( sourcePaths, writer ) )
+    {
+      if ( conflictReport )
+      {
+        conflictReport->close( );
+      }
+      _error = csvMerger.getError( );
+      return false;
+    }
+    if ( conflictReport && !closeWriter( *conflictReport ) )
+    {
+      return false;
+    }
+
+    std::vector< size_t > sourceSizes = csvMerger.getSourceSizes( );
+    for ( size_t i = 0; i < sourcePaths.size( ); ++i )
+    {
+      BuildManifest::Source source;
+      source.path = sourcePaths.at( i );
+      source.fingerprint = _sourceFingerprints.at( begin + i );
+      source.offset = offset;
+      source.size = sourceSizes.at( i );
+      offset += source.size;
+      _manifestSources.emplace_back( source );
+    }
+    return true;
+  }
+
+  bool DataSetBuilder::createJSON( void )
+  {
+    if ( isCanceled( ) )
+    {
+      return false;
+    }
+    _progress->setStage( BuildProgress::Stage::JSON, 1 );
+
+    QByteArray jsonData = QJsonDocument( _schema ).toJson( );
+
+    DataSetWriter writer( getTempPath( _jsonPath ) );
+    _createdFiles.emplace_back( getTempPath( _jsonPath ) );
+    writer.write( jsonData.constData( ),
+      static_cast< size_t >( jsonData.size( ) ) );
+    _progress->addDone( 1 );
+    _outputs.emplace_back( _jsonPath );
+    return closeWriter( writer );
+  }
+
+  bool DataSetBuilder::createXML( void )
+  {
+    if ( isCanceled( ) )
+    {
+      return false;
+    }
+    _progress->setStage( BuildProgress::Stage::XML, 1 );
+
+    vishnucommon::DataSetPtr resultDataSet =
+      _resultDataSets->getDataSets( ).at( 0 );
+    vishnucommon::PropertyGroupsPtr propertyGroups =
+      _resultDataSets->getPropertyGroups( );
+    vishnucommon::Properties properties = resultDataSet->getProperties( );
+
+    //Features
+    std::string geometryColumn;
+
+    vishnucommon::FeaturesVector featuresVector;
+    for ( unsigned int i = 0; i < properties.size( ); ++i )
+    {
+      vishnucommon::PropertyPtr property = properties.at( i );
+      std::string name = property->getName( );
+      vishnucommon::DataCategory dataCategory = property->getDataCategory( );
+
+      //if PK do not include as pyramidal feature
+      if ( vishnucommon::Vectors::find( propertyGroups->getUsedPrimaryKeys( ),
+        name ) == -1 )
+      {
+        //if axes (geometric points xyz) do not include as pyramidal feature
+        if ( vishnucommon::Vectors::find( propertyGroups->getAxes( ), name )
+          == -1 )
+        {
+          featuresVector.emplace_back( vishnucommon::FeaturePtr(
+            new vishnucommon::Feature(
+            name,
+            name,
+            "mV",
+            dataCategory,
+            property->getDataStructureType( ) ) ) );
+        }
+      }
+
+      if ( dataCategory == vishnucommon::DataCategory::Geometric )
+      {
+        geometryColumn = name;
+      }
+    }
+
+    vishnucommon::FeaturesPtr features( new vishnucommon::Features(
+      propertyGroups->getUsedPrimaryKeys( ), propertyGroups->getAxes( ),
+      geometryColumn, featuresVector ) );
+
+    //Set, geometry is read from the archive when packed
+    vishnucommon::Sets sets;
+    sets.emplace_back( vishnucommon::SetPtr( new vishnucommon::Set( _csvPath,
+      _geometryArchive ? _geometryArchivePath
+      : _path + std::string( "/" ) + GEOMETRY_DATA_FOLDER ) ) );
+
+    //Data
+    vishnucommon::DataPtr dataPtr( new vishnucommon::Data( "customDataSet", "",
+      features, sets ) );
+
+    //Colors
+    vishnucommon::Vec3Ptr additionalMeshesColor(
+      new vishnucommon::Vec3( "60", "60", "60" ) );
+    vishnucommon::Vec3Ptr backgroundColor(
+      new vishnucommon::Vec3( "0", "0", "0" ) );
+    vishnucommon::ColorsPtr colors(
+      new vishnucommon::Colors( additionalMeshesColor, backgroundColor ) );
+
+    //Camera
+    vishnucommon::Vec3Ptr eye(
+      new vishnucommon::Vec3( "577.183", "1106.67", "290.011" ) );
+    vishnucommon::Vec3Ptr center(
+      new vishnucommon::Vec3( "479.859", "-26.1715", "670.239" ) );
+    vishnucommon::Vec3Ptr up(
+      new vishnucommon::Vec3( "0.0183558", "-0.319558", "-0.947389" ) );
+    vishnucommon::CameraPtr camera( new vishnucommon::Camera( eye, center, up ) );
+
+    //Configuration
+    vishnucommon::ConfigurationPtr configuration( new vishnucommon::Configuration(
+      "PyramidalExplorer", "0.2.0", "data", dataPtr, colors, camera ) );
+
+    //PyramidalXML
+    std::string dtd =
+      "<!DOCTYPE configuration SYSTEM \"http://gmrv.es/pyramidalexplorer/PyramidalExplorerData-0.2.0.dtd\">";
+    vishnucommon::PyramidalXMLPtr pyramidalXML(
+      new vishnucommon::PyramidalXML( dtd, configuration ) );
+
+    QByteArray xmlData;
+    QXmlStreamWriter xmlWriter( &xmlData );
+    xmlWriter.setAutoFormatting( true );
+    xmlWriter.writeStartDocument( );
+    pyramidalXML->serialize( xmlWriter );
+    xmlWriter.writeEndDocument( );
+
+    DataSetWriter writer( getTempPath( _xmlPath ) );
+    _createdFiles.emplace_back( getTempPath( _xmlPath ) );
+    writer.write( xmlData.constData( ),
+      static_cast< size_t >( xmlData.size( ) ) );
+    _progress->addDone( 1 );
+    _outputs.emplace_back( _xmlPath );
+    return closeWriter( writer );
+  }
+
+  bool DataSetBuilder::createGeometricData( void )
+  {
+    if ( isCanceled( ) )
+    {
+      return false;
+    }
+    _progress->setStage( BuildProgress::Stage::Geometry, 0 );
+
+    //Geometry files are packed or staged from the source folder
+    std::string sourceGeometryFolder = _geometrySource;
+    if ( sourceGeometryFolder.empty( ) )
+    {
+      QDir qDir( QString::fromStdString( _path ) );
+      sourceGeometryFolder = qDir.absolutePath( ).toStdString( )
+        + std::string( "/" ) + GEOMETRY_DATA_FOLDER;
+    }
+    QDir qSourceGeometryFolder(
+      QString::fromStdString( sourceGeometryFolder ) );
+    if ( _geometryArchive )
+    {
+      return createGeometryArchive( qSourceGeometryFolder );
+    }
+
+    //Create geometric data folder
+    std::string geometryFolder = _path + std::string( "/" )
+      + GEOMETRY_DATA_FOLDER;
+    QDir qGeometryFolder( QString::fromStdString( geometryFolder ) );
+    if ( !qGeometryFolder.mkpath( QString::fromStdString( geometryFolder ) ) )
+    {
+      _error = "Can't create " + geometryFolder + " folder.";
+      return false;
+    }
+
+    //Files staged by the previous sync, while it describes them
+    StagedGeometry staged;
+    StoredGeometry stored;
+    if ( _geometrySync )
+    {
+      readGeometryManifest( qSourceGeometryFolder, staged );
+      readGeometryIndex( stored );
+    }
+    std::remove( _geometryManifestPath.c_str( ) );
+    std::remove( _geometryIndexPath.c_str( ) );
+
+    //Nested folders are recreated, listed before their contents
+    GeometryStager::Files files;
+    GeometryManifest::Files manifestFiles;
+    std::unordered_set< std::string > sourceFiles;
+    size_t total = 0;
+    size_t totalFiles = 0;
+    QDirIterator iterator( qSourceGeometryFolder.absolutePath( ),
+      QDir::Dirs | QDir::Files | QDir::NoDotAndDotDot,
+      QDirIterator::Subdirectories );
+    while ( iterator.hasNext( ) )
+    {
+      iterator.next( );
+      QFileInfo info = iterator.fileInfo( );
+      QString relativePath =
+        qSourceGeometryFolder.relativeFilePath( info.absoluteFilePath( ) );
+      std::string dstPath =
+        qGeometryFolder.absoluteFilePath( relativePath ).toStdString( );
+      sourceFiles.insert( relativePath.toStdString( ) );
+      if ( info.isDir( ) )
+      {
+        if ( !QFileInfo( QString::fromStdString( dstPath ) ).isDir( ) )
+        {
+          if ( !qGeometryFolder.mkpath( relativePath ) )
+          {
+            _error = "Can't create " + dstPath + " folder.";
+            return false;
+          }
+          _createdFiles.emplace_back( dstPath );
+        }
+        continue;
+      }
+      GeometryStager::File file;
+      file.srcFilePath = info.absoluteFilePath( ).toStdString( );
+      file.dstFilePath = dstPath;
+      if ( !addGeometryFile( file, relativePath.toStdString( ), staged,
+        files, manifestFiles ) )
+      {
+        return false;
+      }
+      total += static_cast< size_t >( info.size( ) );
+      ++totalFiles;
+    }
+    _progress->setTotal( total );
+    _progress->setTotalFiles( totalFiles );
+
+    if ( _geometrySync && !removeStaleGeometry( qGeometryFolder,
+      sourceFiles ) )
+    {
+      return false;
+    }
+
+    GeometryStager geometryStager( _geometryStaging, _geometryWorkers );
+    geometryStager.setProgress( _progress );
+    if ( !_geometryStore.empty( ) )
+    {
+      geometryStager.setStore( GeometryStorePtr(
+        new GeometryStore( _geometryStore ) ) );
+    }
+    if ( !geometryStager.stage( files ) )
+    {
+      _error = geometryStager.getError( );
+      return false;
+    }
+    if ( !_geometryStore.empty( ) && !writeGeometryIndex( qGeometryFolder,
+      geometryStager, files, manifestFiles, stored ) )
+    {
+      return false;
+    }
+
+    if ( _geometrySync )
+    {
+      GeometryManifestPtr manifest( new GeometryManifest( ) );
+      manifest->setSource(
+        qSourceGeometryFolder.canonicalPath( ).toStdString( ) );
+      manifest->setMode( GeometryStager::toString( _geometryStaging ) );
+      manifest->setStore( _geometryStore );
+      manifest->setFiles( manifestFiles );
+      _createdFiles.emplace_back( _geometryManifestPath );
+      if ( !vishnucommon::JSON::serialize( _geometryManifestPath, manifest ) )
+      {
+        _error = "Can't create " + _geometryManifestPath + " file.";
+        return false;
+      }
+    }
+    return true;
+  }
+
+  bool DataSetBuilder::createGeometryArchive(
+    const QDir& qSourceGeometryFolder )
+  {
+    GeometryArchiveWriter::Files files;
+    size_t total = 0;
+    QDirIterator iterator( qSourceGeometryFolder.absolutePath( ),
+      QDir::Files, QDirIterator::Subdirectories );
+    while ( iterator.hasNext( ) )
+    {
+      iterator.next( );
+      QFileInfo info = iterator.fileInfo( );
+      GeometryArchiveWriter::File file;
+      file.name = qSourceGeometryFolder.relativeFilePath(
+        info.absoluteFilePath( ) ).toStdString( );
+      file.filePath = info.absoluteFilePath( ).toStdString( );
+      files.emplace_back( file );
+      total += static_cast< size_t >( info.size( ) );
+    }
+    _progress->setTotal( total );
+    _progress->setTotalFiles( files.size( ) );
+
+    GeometryArchiveWriter archiveWriter( _geometryCompression,
+      _geometryWorkers );
+    archiveWriter.setProgress( _progress );
+    _createdFiles.emplace_back( _geometryArchivePath );
+    if ( !archiveWriter.write( _geometryArchivePath, files ) )
+    {
+      _error = archiveWriter.getError( );
+      return false;
+    }
+    return true;
+  }
+
+  void DataSetBuilder::readGeometryManifest(
+    const QDir& qSourceGeometryFolder, StagedGeometry& staged ) const
+  {
+    if ( !vishnucommon::Files::exist( _geometryManifestPath ) )
+    {
+      return;
+    }
+    GeometryManifestPtr manifest = vishnucommon::JSON::deserialize<
+      GeometryManifest >( _geometryManifestPath );
+
+    //Files staged from another folder, in another mode or through another
+    //store are staged again
+    if ( !manifest || manifest->getSource( )
+        != qSourceGeometryFolder.canonicalPath( ).toStdString( )
+      || GeometryStager::toMode( manifest->getMode( ) ) != _geometryStaging
+      || manifest->getStore( ) != _geometryStore )
+    {
+      return;
+    }
+    for ( const auto& file : manifest->getFiles( ) )
+    {
+      staged[ file.path ] = file.fingerprint;
+    }
+  }
+
+  void DataSetBuilder::readGeometryIndex( StoredGeometry& stored ) const
+  {
+    if ( !vishnucommon::Files::exist( _geometryIndexPath ) )
+    {
+      return;
+    }
+    GeometryIndexPtr index = vishnucommon::JSON::deserialize<
+      GeometryIndex >( _geometryIndexPath );
+    if ( !index || index->getStore( ) != _geometryStore )
+    {
+      return;
+    }
+    for ( const auto& file : index->getFiles( ) )
+    {
+      stored[ file.path ] = file.object;
+    }
+  }
+
+  bool DataSetBuilder::writeGeometryIndex( const QDir& qGeometryFolder,
+    const GeometryStager& geometryStager, const GeometryStager::Files& files,
+    const GeometryManifest::Files& manifestFiles, StoredGeometry& stored )
+  {
+    std::vector< std::string > objects = geometryStager.getObjects( );
+    for ( size_t i = 0; i < files.size( ) && i < objects.size( ); ++i )
+    {
+      stored[ qGeometryFolder.relativeFilePath( QString::fromStdString(
+        files.at( i ).dstFilePath ) ).toStdString( ) ] = objects.at( i );
+    }
+
+    //Every current file, unchanged ones keep the object of the last sync
+    GeometryIndex::Files indexFiles;
+    for ( const auto& manifestFile : manifestFiles )
+    {
+      auto storedFile = stored.find( manifestFile.path );
+      if ( storedFile != stored.end( ) )
+      {
+        GeometryIndex::File indexFile;
+        indexFile.path = manifestFile.path;
+        indexFile.object = storedFile->second;
+        indexFiles.emplace_back( indexFile );
+      }
+    }
+
+    GeometryIndexPtr index( new GeometryIndex( ) );
+    index->setStore( _geometryStore );
+    index->setFiles( indexFiles );
+    _createdFiles.emplace_back( _geometryIndexPath );
+    if ( !vishnucommon::JSON::serialize( _geometryIndexPath, index ) )
+    {
+      _error = "Can't create " + _geometryIndexPath + " file.";
+      return false;
+    }
+    return true;
+  }
+
+  bool DataSetBuilder::addGeometryFile( const GeometryStager::File& file,
+    const std::string& relativePath, const StagedGeometry& staged,
+    GeometryStager::Files& files, GeometryManifest::Files& manifestFiles )
+  {
+    GeometryManifest::File manifestFile;
+    manifestFile.path = relativePath;
+    if ( _geometrySync && !( _geometryHash
+      ? FileFingerprint::computeFull( file.srcFilePath,
+        manifestFile.fingerprint )
+      : FileFingerprint::stat( file.srcFilePath, manifestFile.fingerprint ) ) )
+    {
+      _error = "Can't read " + file.srcFilePath + " file.";
+      return false;
+    }
+
+    //Rebuilding in place, the file is already there. A symlink to the
+    //source is staged again when the mode changed
+    QFileInfo srcInfo( QString::fromStdString( file.srcFilePath ) );
+    QFileInfo dstInfo( QString::fromStdString( file.dstFilePath ) );
+    if ( srcInfo.absoluteFilePath( ) == dstInfo.absoluteFilePath( )
+      || ( srcInfo.canonicalFilePath( ) == dstInfo.canonicalFilePath( )
+        && !( _geometryRestage && dstInfo.isSymLink( ) ) ) )
+    {
+      _progress->addDone( static_cast< size_t >( srcInfo.size( ) ) );
+      _progress->addFiles( 1 );
+      manifestFiles.emplace_back( manifestFile );
+      return true;
+    }
+
+    if ( dstInfo.exists( ) || dstInfo.isSymLink( ) )
+    {
+      //Without sync, existing files (or links) are only overwritten when
+      //they were placed with other options
+      if ( !_geometrySync && !_geometryRestage )
+      {
+        _error = "Can't copy " + file.srcFilePath + " file.";
+        return false;
+      }
+
+      //Unchanged since it was staged: same size and modification time, or
+      //same hash of the whole content when hashing
+      auto stagedFile = staged.find( relativePath );
+      if ( stagedFile != staged.end( )
+        && stagedFile->second.size == manifestFile.fingerprint.size
+        && ( stagedFile->second.modificationTime
+          == manifestFile.fingerprint.modificationTime
+          || ( _geometryHash && stagedFile->second.contentHash
+            == manifestFile.fingerprint.contentHash ) ) )
+      {
+        _progress->addDone( static_cast< size_t >( srcInfo.size( ) ) );
+        _progress->addFiles( 1 );
+        manifestFiles.emplace_back( manifestFile );
+        return true;
+      }
+      if ( std::remove( file.dstFilePath.c_str( ) ) != 0 )
+      {
+        _error = "Can't replace " + file.dstFilePath + " file.";
+        return false;
+      }
+    }
+    _createdFiles.emplace_back( file.dstFilePath );
+    files.emplace_back( file );
+    manifestFiles.emplace_back( manifestFile );
+    return true;
+  }
+
+  bool DataSetBuilder::removeStaleGeometry( const QDir& qGeometryFolder,
+    const std::unordered_set< std::string >& sourceFiles )
+  {
+    //Broken links are listed as system files
+    std::vector< std::string > staleFolders;
+    QDirIterator iterator( qGeometryFolder.absolutePath( ),
+      QDir::Dirs | QDir::Files | QDir::System | QDir::NoDotAndDotDot,
+      QDirIterator::Subdirectories );
+    while ( iterator.hasNext( ) )
+    {
+      iterator.next( );
+      QFileInfo info = iterator.fileInfo( );
+      std::string relativePath = qGeometryFolder.relativeFilePath(
+        info.absoluteFilePath( ) ).toStdString( );
+      if ( sourceFiles.count( relativePath ) != 0 )
+      {
+        continue;
+      }
+      if ( info.isDir( ) && !info.isSymLink( ) )
+      {
+        staleFolders.emplace_back( info.absoluteFilePath( ).toStdString( ) );
+      }
+      else if ( std::remove( info.absoluteFilePath( ).toStdString( ).c_str( ) )
+        != 0 )
+      {
+        _error = "Can't remove " + info.absoluteFilePath( ).toStdString( )
+          + " file.";
+        return false;
+      }
+    }
+
+    //Nested folders first
+    for ( auto staleFolder = staleFolders.rbegin( );
+      staleFolder != staleFolders.rend( ); ++staleFolder )
+    {
+      QDir( ).rmdir( QString::fromStdString( *staleFolder ) );
+    }
+    return true;
+  }
+
+  bool DataSetBuilder::closeWriter( DataSetWriter& writer )
+  {
+    if ( !writer.close( ) )
+    {
+      _error = writer.getError( );
+      return false;
+    }
+    return true;
+  }
+
+  bool DataSetBuilder::commitOutputs( void )
+  {
+    //Outputs are written to temporary files and replace the previous ones
+    //together once every stage succeeded, so a failed or canceled build
+    //keeps the previous dataset and the manifest describing it
+    if ( isCanceled( ) )
+    {
+      return false;
+    }
+    std::remove( _manifestPath.c_str( ) );
+    if ( vishnucommon::Vectors::find( _outputs, _csvPath ) != -1 )
+    {
+      //Left over by a previous sparse or filtered build
+      if ( !_sparse )
+      {
+        std::remove( _nullBitmapPath.c_str( ) );
+      }
+      if ( !isFiltered( ) )
+      {
+        std::remove( _conflictReportPath.c_str( ) );
+      }
+    }
+    for ( const auto& output : _outputs )
+    {
+      if ( !commitFile( getTempPath( output ), output ) )
+      {
+        return false;
+      }
+    }
+    _outputs.clear( );
+    return true;
+  }
+
+  bool DataSetBuilder::commitFile( const std::string& tempPath,
+    const std::string& path )
+  {
+    bool existed = vishnucommon::Files::exist( path );
+    std::remove( path.c_str( ) );
+    if ( std::rename( tempPath.c_str( ), path.c_str( ) ) != 0 )
+    {
+      _error = "Can't rename " + tempPath + " file.";
+      return false;
+    }
+
+    //Only outputs this build created are removed if it fails later
+    auto createdFile = std::find( _createdFiles.begin( ),
+      _createdFiles.end( ), tempPath );
+    if ( createdFile != _createdFiles.end( ) )
+    {
+      if ( existed )
+      {
+        _createdFiles.erase( createdFile );
+      }
+      else
+      {
+        *createdFile = path;
+      }
+    }
+    return true;
+  }
+
+  void DataSetBuilder::removeCreatedFiles( void )
+  {
+    //Newest first, so folders are empty by the time they are removed
+    for ( auto createdFile = _createdFiles.rbegin( );
+      createdFile != _createdFiles.rend( ); ++createdFile )
+    {
+      std::remove( createdFile->c_str( ) );
+    }
+    _createdFiles.clear( );
+
+    //Rows appended to the previous CSV file are dropped, and the previous
+    //manifest describes it again
+    if ( _csvAppended )
+    {
+      _csvAppended = false;
+      FileFingerprint csvFingerprint;
+      if ( QFile::resize( QString::fromStdString( _csvPath ),
+        static_cast< qint64 >( _csvAppendOffset ) )
+        && FileFingerprint::compute( _csvPath, csvFingerprint ) )
+      {
+        _manifest->setCsvFingerprint( csvFingerprint );
+        vishnucommon::JSON::serialize( _manifestPath, _manifest );
+      }
+      else
+      {
+        std::remove( _manifestPath.c_str( ) );
+      }
+    }
+  }
+
+}
@@ -0,0 +1,244 @@
+/*
+ * Vishnu
+ * Copyright (c) 2017-2019 GMRV/URJC.
+ *
+ * Authors: Gonzalo Bayo Martinez <gonzalo.bayo@urjc.es>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef VISHNU_DATASETBUILDER_H
+#define VISHNU_DATASETBUILDER_H
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <unordered_map>
+#include <unordered_set>
+
+#include <QDir>
+#include <QJsonObject>
+
+#include <vishnucommon/vishnucommon.h>
+
+#include "BuildProgress.h"
+#include "DataSetWriter.h"
+#include "DuplicateFilter.h"
+#include "FileFingerprint.h"
+#include "GeometryArchiveWriter.h"
+#include "GeometryStager.h"
+#include "NullBitmapWriter.h"
+#include "RowFilter.h"
+#include "../model/BuildManifest.h"
+#include "../model/GeometryIndex.h"
+#include "../model/GeometryManifest.h"
+
+namespace vishnu
+{
+
+  class DataSetBuilder;
+  using DataSetBuilderPtr = std::shared_ptr< DataSetBuilder >;
+
+  /*
+   * Creates the CSV, JSON, XML and geometric data of a dataset from its
+   * sources. It does not touch any widget, so it can run on a worker thread;
+   * progress and cancellation go through a BuildProgress. The CSV, JSON and
+   * XML files (and the null bitmap and conflict report) are written to
+   * temporary files and replace the previous ones together, followed by
+   * the manifest, only once the geometric data is ready too. A build that
+   * fails or is canceled removes only the outputs it created and keeps the
+   * previous ones.
+   *
+   * A BuildManifest is written next to the JSON file. When the schema is the
+   * same, the next build of these outputs does nothing if no source changed,
+   * appends the rows of sources added at the end, and otherwise copies the
+   * rows of unchanged sources from the previous CSV, merging only the new or
+   * changed ones. Appended rows are truncated away if the build fails.
+   *
+   * In sparse mode missing fields are written empty and recorded in a null
+   * bitmap next to the CSV file, referenced from the JSON schema. Its rows
+   * can't be reused, so the CSV is merged again whenever a source changes.
+   *
+   * Merged rows with the same primary key (the same fields without primary
+   * keys) can be filtered with a duplicate policy; dropped rows are listed
+   * in a conflict report next to the CSV file. Filtered results are merged
+   * again whenever a source changes too.
+   *
+   * Rows can also be sorted by primary key. They are merged or joined to a
+   * temporary file first and then sorted into the CSV file with an
+   * external merge sort, bounded by its own memory budget.
+   *
+   * A row filter expression (see RowFilter) drops merged or joined rows
+   * while they are streamed, before they are written or sorted.
+   */
+  class DataSetBuilder
+  {
+
+    public:
+
+      DataSetBuilder( const vishnucommon::DataSetsPtr& resultDataSets,
+        const std::vector< std::string >& sourcePaths, const std::string& path,
+        const std::string& csvPath, const std::string& jsonPath,
+        const std::string& xmlPath );
+      ~DataSetBuilder( void );
+
+      bool build( void );
+
+      std::string getError( void ) const;
+      bool isCanceled( void ) const;
+
+      void setProgress( const BuildProgressPtr& progress );
+      BuildProgressPtr getProgress( void ) const;
+
+      //One row per primary key instead of one row per source row
+      void setJoin( const bool& join );
+      //Sources are read through columnar caches in this folder (see
+      //SourceCache), directly when empty
+      void setCacheFolder( const std::string& cacheFolder );
+      void setJoinMemoryBudget( const size_t& joinMemoryBudget );
+      void setTempFolder( const std::string& tempFolder );
+      void setSparse( const bool& sparse );
+      //Ignored when joining, joined rows have unique keys
+      void setDuplicatePolicy( const DuplicateFilter::Policy& duplicatePolicy );
+      //Ignored without primary keys
+      void setSort( const bool& sort );
+      void setSortMemoryBudget( const size_t& sortMemoryBudget );
+      //Empty to keep every row
+      void setRowFilter( const std::string& rowFilter );
+
+      //Folder the geometric data is copied from, by default the one of the
+      //dataset itself
+      void setGeometrySource( const std::string& geometrySource );
+      //How geometric data files are placed, by default they are copied
+      void setGeometryStaging( const GeometryStager::Mode& geometryStaging );
+      //Files staged at the same time, 0 for GEOMETRY_STAGING_WORKERS
+      void setGeometryWorkers( const size_t& geometryWorkers );
+      //Only new or changed geometry files are staged, and files no longer
+      //in the source are removed
+      void setGeometrySync( const bool& geometrySync );
+      //Changed files are told apart by a hash of their content too, not
+      //only by size and modification time
+      void setGeometryHash( const bool& geometryHash );
+      //Folder of the shared geometry store (see GeometryStore), empty to
+      //stage files on their own. Stored objects are listed in a geometry
+      //index next to the geometric data folder
+      void setGeometryStore( const std::string& geometryStore );
+      //Geometric data is packed in one archive (see GeometryArchive),
+      //referenced from the XML file, instead of staged file by file. The
+      //staging mode, sync and store don't apply to it
+      void setGeometryArchive( const bool& geometryArchive );
+      //zlib level of archive entries, 0 to store them as they are
+      void setGeometryCompression( const int& geometryCompression );
+
+    private:
+
+      vishnucommon::DataSetsPtr _resultDataSets;
+      std::vector< std::string > _sourcePaths;
+      std::string _path;
+      std::string _csvPath;
+      std::string _jsonPath;
+      std::string _xmlPath;
+      std::string _manifestPath;
+      std::string _geometryManifestPath;
+      std::string _geometryIndexPath;
+      std::string _geometryArchivePath;
+      std::string _nullBitmapPath;
+      std::string _conflictReportPath;
+      BuildProgressPtr _progress;
+      bool _join;
+      std::string _cacheFolder;
+      size_t _joinMemoryBudget;
+      std::string _tempFolder;
+      bool _sparse;
+      NullBitmapWriterPtr _nullBitmap;
+      DuplicateFilter::Policy _duplicatePolicy;
+      bool _sort;
+      size_t _sortMemoryBudget;
+      std::string _rowFilterExpression;
+      RowFilterPtr _rowFilter;
+      std::string _geometrySource;
+      GeometryStager::Mode _geometryStaging;
+      size_t _geometryWorkers;
+      bool _geometrySync;
+      bool _geometryHash;
+      std::string _geometryStore;
+      bool _geometryArchive;
+      int _geometryCompression;
+      std::string _error;
+      std::vector< std::string > _createdFiles;
+      std::vector< FileFingerprint > _sourceFingerprints;
+      QJsonObject _schema;
+      BuildManifestPtr _manifest;
+      BuildManifest::Sources _manifestSources;
+      uint64_t _headerSize;
+      //Outputs written to temporary files, replaced by commitOutputs
+      std::vector< std::string > _outputs;
+      bool _csvAppended;
+      uint64_t _csvAppendOffset;
+      //Geometry placed with other options, whose files are replaced even
+      //without sync
+      bool _geometryRestage;
+
+      bool isJoined( void ) const;
+      bool isFiltered( void ) const;
+      bool isSorted( void ) const;
+      bool canReuseRows( void ) const;
+      std::string getMergePath( void ) const;
+      //Outputs are written next to their final path and then moved there
+      std::string getTempPath( const std::string& path ) const;
+      void readManifest( void );
+      bool isUpToDate( void ) const;
+      //Packed, or staged from the same source with the same mode and store,
+      //as the manifest describes
+      bool isGeometryUpToDate( void ) const;
+      bool writeManifest( void );
+      bool createCSV( void );
+      bool joinCSV( const std::vector< std::string >& headers );
+      bool mergeCSV( const std::vector< std::string >& headers );
+      bool sortCSV( const std::vector< std::string >& headers );
+      bool mergeSources( const std::vector< std::string >& headers,
+        const size_t& begin, const size_t& end, const uint64_t& baseOffset,
+        DataSetWriter& writer );
+      bool createJSON( void );
+      bool createXML( void );
+      bool createGeometricData( void );
+      bool createGeometryArchive( const QDir& qSourceGeometryFolder );
+      //Source fingerprints of staged geometry files, by relative path
+      using StagedGeometry =
+        std::unordered_map< std::string, FileFingerprint >;
+      //Stored objects of staged geometry files, by relative path
+      using StoredGeometry = std::unordered_map< std::string, std::string >;
+
+      void readGeometryManifest( const QDir& qSourceGeometryFolder,
+        StagedGeometry& staged ) const;
+      void readGeometryIndex( StoredGeometry& stored ) const;
+      bool writeGeometryIndex( const QDir& qGeometryFolder,
+        const GeometryStager& geometryStager,
+        const GeometryStager::Files& files,
+        const GeometryManifest::Files& manifestFiles, StoredGeometry& stored );
+      bool addGeometryFile( const GeometryStager::File& file,
+        const std::string& relativePath, const StagedGeometry& staged,
+        GeometryStager::Files& files,
+        GeometryManifest::Files& manifestFiles );
+      bool removeStaleGeometry( const QDir& qGeometryFolder,
+        const std::unordered_set< std::string >& sourceFiles );
+      bool closeWriter( DataSetWriter& writer );
+      bool commitOutputs( void );
+      bool commitFile( const std::string& tempPath, const std::string& path );
+      void removeCreatedFiles( void );
+  };
+
+}
+
+#endif
@@ -0,0 +1,169 @@
+/*
+ * Vishnu
+ * Copyright (c) 2017-2019 GMRV/URJC.
+ *
+ * Authors: Gonzalo Bayo Martinez <gonzalo.bayo@urjc.es>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "DataSetSchema.h"
+
+namespace vishnu
+{
+
+  vishnucommon::DataSetPtr DataSetSchema::readCsvDataSet(
+    const std::string& path, const size_t& sampleRows,
+    const std::string& cacheFolder )
+  {
+    TypeInference::Columns columns;
+    TypeInference::infer( path, sampleRows, columns, cacheFolder );
+    return createCsvDataSet( path, columns );
+  }
+
+  std::vector< vishnucommon::DataSetPtr > DataSetSchema::readCsvDataSets(
+    const std::vector< std::string >& paths, const size_t& sampleRows,
+    const std::string& cacheFolder )
+  {
+    std::vector< TypeInference::Columns > columns =
+      TypeInference::infer( paths, sampleRows, 0, cacheFolder );
+    std::vector< vishnucommon::DataSetPtr > dataSets;
+    for ( size_t i = 0; i < paths.size( ); ++i )
+    {
+      dataSets.emplace_back( createCsvDataSet( paths[ i ], columns[ i ] ) );
+    }
+    return dataSets;
+  }
+
+  std::vector< std::string > DataSetSchema::getCommonProperties(
+    const vishnucommon::DataSetsPtr& dataSets )
+  {
+    std::vector< std::string > commonProperties;
+    for ( const auto& dataset : dataSets->getDataSets( ) )
+    {
+      std::vector< std::string > dataSetHeaders = dataset->getPropertyNames( );
+
+      if ( !commonProperties.empty( ) )
+      {
+        commonProperties = vishnucommon::Vectors::intersect( commonProperties,
+          dataSetHeaders );
+      }
+      else
+      {
+        commonProperties = dataSetHeaders;
+      }
+    }
+
+    return commonProperties;
+  }
+
+  vishnucommon::DataSetsPtr DataSetSchema::createResultDataSets(
+    const Properties& properties )
+  {
+    vishnucommon::DataSetsPtr dataSets( new vishnucommon::DataSets( ) );
+    vishnucommon::DataSetPtr dataSet( new vishnucommon::DataSet( ) );
+    vishnucommon::PropertyGroupsPtr propertyGroups(
+      new vishnucommon::PropertyGroups( ) );
+    std::string xAxis;
+    std::string yAxis;
+    std::string zAxis;
+    std::string xyzAxis;
+    for ( const auto& property : properties )
+    {
+      if ( property.use )
+      {
+        if ( property.primaryKey )
+        {
+          propertyGroups->addUsedPrimaryKey( property.name );
+        }
+        else
+        {
+          propertyGroups->addUsedNonPrimaryKey( property.name );
+        }
+        dataSet->addProperty( vishnucommon::PropertyPtr(
+          new vishnucommon::Property( property.name, property.dataCategory,
+          vishnucommon::DataStructureType::None ) ) );
+      }
+
+      switch( property.axisType )
+      {
+        case vishnucommon::AxisType::X:
+          xAxis = property.name;
+          break;
+        case vishnucommon::AxisType::Y:
+          yAxis = property.name;
+          break;
+        case vishnucommon::AxisType::Z:
+          zAxis = property.name;
+          break;
+        case vishnucommon::AxisType::XYZ:
+          xyzAxis = property.name;
+          break;
+        default:
+          break;
+      }
+    }
+
+    if ( !xyzAxis.empty( ) )
+    {
+      propertyGroups->setAxes( xyzAxis );
+    }
+    else
+    {
+      propertyGroups->setAxes( xAxis, yAxis, zAxis );
+    }
+
+    dataSets->setDataSets( { dataSet } );
+    dataSets->setPropertyGroups( propertyGroups );
+
+    return dataSets;
+  }
+
+  vishnucommon::DataSetPtr DataSetSchema::createCsvDataSet(
+    const std::string& path, const TypeInference::Columns& columns )
+  {
+    vishnucommon::DataSetPtr dataSet( new vishnucommon::DataSet( path ) );
+    bool geometric = false;
+    for ( const auto& column : columns )
+    {
+      vishnucommon::DataCategory dataCategory =
+        vishnucommon::DataCategory::Undefined;
+      switch( column.type )
+      {
+        case TypeInference::ColumnType::Integer:
+        case TypeInference::ColumnType::Float:
+          dataCategory = vishnucommon::DataCategory::Quantitative;
+          break;
+        case TypeInference::ColumnType::Categorical:
+          dataCategory = vishnucommon::DataCategory::Categorical;
+          break;
+        case TypeInference::ColumnType::GeometricPath:
+          //A dataset has one geometry column
+          if ( !geometric )
+          {
+            dataCategory = vishnucommon::DataCategory::Geometric;
+            geometric = true;
+          }
+          break;
+        default:
+          break;
+      }
+      dataSet->addProperty( vishnucommon::PropertyPtr(
+        new vishnucommon::Property( column.name, dataCategory,
+        vishnucommon::DataStructureType::None ) ) );
+    }
+    return dataSet;
+  }
+
+}
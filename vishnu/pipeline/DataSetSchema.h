@@ -0,0 +1,85 @@
+/*
+ * Vishnu
+ * Copyright (c) 2017-2019 GMRV/URJC.
+ *
+ * Authors: Gonzalo Bayo Martinez <gonzalo.bayo@urjc.es>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef VISHNU_DATASETSCHEMA_H
+#define VISHNU_DATASETSCHEMA_H
+
+#include <string>
+#include <vector>
+
+#include <vishnucommon/vishnucommon.h>
+
+#include "TypeInference.h"
+#include "../Definitions.hpp"
+
+namespace vishnu
+{
+
+  /*
+   * Schema stage of a dataset build, without widgets: source datasets from
+   * their headers, properties shared by all of them and the result schema
+   * (used properties, primary keys and axes).
+   */
+  class DataSetSchema
+  {
+
+    public:
+
+      //One row of the properties table
+      struct Property
+      {
+        std::string name;
+        bool use = true;
+        bool primaryKey = false;
+        vishnucommon::DataCategory dataCategory =
+          vishnucommon::DataCategory::Undefined;
+        vishnucommon::AxisType axisType = vishnucommon::AxisType::None;
+      };
+      using Properties = std::vector< Property >;
+
+      //Dataset of a CSV source, one property per header with the data
+      //category inferred from its first sampleRows records (see
+      //TypeInference), read through the source cache in cacheFolder if any
+      static vishnucommon::DataSetPtr readCsvDataSet( const std::string& path,
+        const size_t& sampleRows = TYPE_INFERENCE_SAMPLE_ROWS,
+        const std::string& cacheFolder = std::string( ) );
+
+      //Same as above, sampling the sources in parallel
+      static std::vector< vishnucommon::DataSetPtr > readCsvDataSets(
+        const std::vector< std::string >& paths,
+        const size_t& sampleRows = TYPE_INFERENCE_SAMPLE_ROWS,
+        const std::string& cacheFolder = std::string( ) );
+
+      //Properties found in every dataset
+      static std::vector< std::string > getCommonProperties(
+        const vishnucommon::DataSetsPtr& dataSets );
+
+      static vishnucommon::DataSetsPtr createResultDataSets(
+        const Properties& properties );
+
+    private:
+
+      static vishnucommon::DataSetPtr createCsvDataSet( const std::string& path,
+        const TypeInference::Columns& columns );
+  };
+
+}
+
+#endif
@@ -0,0 +1,135 @@
+/*
+ * Vishnu
+ * Copyright (c) 2017-2019 GMRV/URJC.
+ *
+ * Authors: Gonzalo Bayo Martinez <gonzalo.bayo@urjc.es>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "DataSetWriter.h"
+
+#include <cstring>
+
+namespace vishnu
+{
+
+  DataSetWriter::DataSetWriter( const std::string& path,
+    const size_t& flushSize, const bool& append )
+    : _path( path )
+    , _file( nullptr )
+    , _buffer( flushSize > 0 ? flushSize : 1 )
+    , _used( 0 )
+    , _bytesWritten( 0 )
+  {
+    _file = std::fopen( path.c_str( ), append ? "ab" : "wb" );
+    if ( _file == nullptr )
+    {
+      _error = "Can't open " + path + " file.";
+    }
+    else
+    {
+      //Our own buffer already batches writes
+      std::setvbuf( _file, nullptr, _IONBF, 0 );
+    }
+  }
+
+  DataSetWriter::~DataSetWriter( void )
+  {
+    close( );
+  }
+
+  void DataSetWriter::write( const char* data, const size_t& size )
+  {
+    if ( _file == nullptr )
+    {
+      return;
+    }
+
+    if ( _used + size > _buffer.size( ) )
+    {
+      flush( );
+      //Big chunks go straight to the file
+      if ( size >= _buffer.size( ) )
+      {
+        if ( _error.empty( ) &&
+          std::fwrite( data, 1, size, _file ) != size )
+        {
+          _error = "Can't write " + _path + " file.";
+        }
+        _bytesWritten += size;
+        return;
+      }
+    }
+    std::memcpy( _buffer.data( ) + _used, data, size );
+    _used += size;
+    _bytesWritten += size;
+  }
+
+  void DataSetWriter::write( const std::string& data )
+  {
+    write( data.data( ), data.size( ) );
+  }
+
+  void DataSetWriter::writeLine( const std::string& line )
+  {
+    write( line.data( ), line.size( ) );
+    write( "\n", 1 );
+  }
+
+  bool DataSetWriter::close( void )
+  {
+    if ( _file != nullptr )
+    {
+      flush( );
+      if ( std::fclose( _file ) != 0 && _error.empty( ) )
+      {
+        _error = "Can't close " + _path + " file.";
+      }
+      _file = nullptr;
+    }
+    return _error.empty( );
+  }
+
+  bool DataSetWriter::hasError( void ) const
+  {
+    return !_error.empty( );
+  }
+
+  std::string DataSetWriter::getError( void ) const
+  {
+    return _error;
+  }
+
+  std::string DataSetWriter::getPath( void ) const
+  {
+    return _path;
+  }
+
+  size_t DataSetWriter::getBytesWritten( void ) const
+  {
+    return _bytesWritten;
+  }
+
+  void DataSetWriter::flush( void )
+  {
+    if ( _used > 0 && _error.empty( ) &&
+      std::fwrite( _buffer.data( ), 1, _used, _file ) != _used )
+    {
+      _error = "Can't write " + _path + " file.";
+    }
+    _used = 0;
+  }
+
+}
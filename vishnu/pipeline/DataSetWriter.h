@@ -0,0 +1,79 @@
+/*
+ * Vishnu
+ * Copyright (c) 2017-2019 GMRV/URJC.
+ *
+ * Authors: Gonzalo Bayo Martinez <gonzalo.bayo@urjc.es>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef VISHNU_DATASETWRITER_H
+#define VISHNU_DATASETWRITER_H
+
+#include <cstdio>
+#include <string>
+#include <vector>
+#include <memory>
+
+#include "../Definitions.hpp"
+
+namespace vishnu
+{
+
+  class DataSetWriter;
+  using DataSetWriterPtr = std::shared_ptr< DataSetWriter >;
+
+  /*
+   * Output file writer. The file is opened once and data is accumulated in
+   * a user space buffer that is flushed when it reaches flushSize bytes.
+   * Errors are kept and reported once by close( ).
+   */
+  class DataSetWriter
+  {
+
+    public:
+
+      explicit DataSetWriter( const std::string& path,
+        const size_t& flushSize = DEFAULT_WRITE_BUFFER_SIZE,
+        const bool& append = false );
+      ~DataSetWriter( void );
+
+      void write( const char* data, const size_t& size );
+      void write( const std::string& data );
+      void writeLine( const std::string& line );
+
+      //Flushes pending data and closes the file
+      bool close( void );
+
+      bool hasError( void ) const;
+      std::string getError( void ) const;
+
+      std::string getPath( void ) const;
+      size_t getBytesWritten( void ) const;
+
+    private:
+
+      std::string _path;
+      std::FILE* _file;
+      std::vector< char > _buffer;
+      size_t _used;
+      size_t _bytesWritten;
+      std::string _error;
+
+      void flush( void );
+  };
+
+}
+
+#endif
@@ -0,0 +1,112 @@
+/*
+ * Vishnu
+ * Copyright (c) 2017-2019 GMRV/URJC.
+ *
+ * Authors: Gonzalo Bayo Martinez <gonzalo.bayo@urjc.es>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "DuplicateFilter.h"
+
+namespace vishnu
+{
+
+  DuplicateFilter::DuplicateFilter( const Policy& policy )
+    : _policy( policy )
+    , _conflicts( 0 )
+  {
+
+  }
+
+  DuplicateFilter::Policy DuplicateFilter::getPolicy( void ) const
+  {
+    return _policy;
+  }
+
+  void DuplicateFilter::recordLast( const uint64_t& fingerprint,
+    const RowId& row )
+  {
+    _rows[ fingerprint ] = row;
+  }
+
+  bool DuplicateFilter::accept( const uint64_t& fingerprint,
+    const RowId& row, RowId& keptRow )
+  {
+    if ( _policy == Policy::KeepAll )
+    {
+      return true;
+    }
+
+    if ( _policy == Policy::KeepLast )
+    {
+      auto it = _rows.find( fingerprint );
+      if ( it == _rows.end( ) || it->second == row )
+      {
+        return true;
+      }
+      keptRow = it->second;
+      ++_conflicts;
+      return false;
+    }
+
+    auto inserted = _rows.emplace( fingerprint, row );
+    if ( inserted.second )
+    {
+      return true;
+    }
+    keptRow = inserted.first->second;
+    ++_conflicts;
+    return false;
+  }
+
+  size_t DuplicateFilter::getConflicts( void ) const
+  {
+    return _conflicts;
+  }
+
+  DuplicateFilter::Policy DuplicateFilter::toPolicy(
+    const std::string& policy )
+  {
+    if ( policy == "keepFirst" )
+    {
+      return Policy::KeepFirst;
+    }
+    if ( policy == "keepLast" )
+    {
+      return Policy::KeepLast;
+    }
+    if ( policy == "fail" )
+    {
+      return Policy::Fail;
+    }
+    return Policy::KeepAll;
+  }
+
+  std::string DuplicateFilter::toString( const Policy& policy )
+  {
+    switch( policy )
+    {
+      case Policy::KeepFirst:
+        return "keepFirst";
+      case Policy::KeepLast:
+        return "keepLast";
+      case Policy::Fail:
+        return "fail";
+      default:
+        return "keepAll";
+    }
+  }
+
+}
@@ -0,0 +1,93 @@
+/*
+ * Vishnu
+ * Copyright (c) 2017-2019 GMRV/URJC.
+ *
+ * Authors: Gonzalo Bayo Martinez <gonzalo.bayo@urjc.es>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef VISHNU_DUPLICATEFILTER_H
+#define VISHNU_DUPLICATEFILTER_H
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <memory>
+
+namespace vishnu
+{
+
+  class DuplicateFilter;
+  using DuplicateFilterPtr = std::shared_ptr< DuplicateFilter >;
+
+  /*
+   * Finds rows of a merge describing the same entity. Rows are identified
+   * by a 64 bit fingerprint of their primary key fields (or of the whole
+   * row without primary keys), and only fingerprints and the row they were
+   * first or last seen at are kept, so memory grows with the number of
+   * distinct keys but not with their size.
+   */
+  class DuplicateFilter
+  {
+
+    public:
+
+      enum class Policy
+      {
+        KeepAll, //No detection
+        KeepFirst,
+        KeepLast, //Needs a first pass over the rows, see recordLast
+        Fail
+      };
+
+      //Row of a source in merge order, rows counted from 0 after the headers
+      struct RowId
+      {
+        uint32_t source = 0;
+        uint64_t row = 0;
+
+        bool operator==( const RowId& other ) const
+        {
+          return source == other.source && row == other.row;
+        }
+      };
+
+      explicit DuplicateFilter( const Policy& policy );
+
+      Policy getPolicy( void ) const;
+
+      //First pass of KeepLast: remembers the last row of every fingerprint
+      void recordLast( const uint64_t& fingerprint, const RowId& row );
+
+      //True if the row is written. Otherwise keptRow is the row written for
+      //its fingerprint (or already written with Fail)
+      bool accept( const uint64_t& fingerprint, const RowId& row,
+        RowId& keptRow );
+
+      size_t getConflicts( void ) const;
+
+      static Policy toPolicy( const std::string& policy );
+      static std::string toString( const Policy& policy );
+
+    private:
+
+      Policy _policy;
+      std::unordered_map< uint64_t, RowId > _rows;
+      size_t _conflicts;
+  };
+
+}
+
+#endif
@@ -0,0 +1,497 @@
+/*
+ * Vishnu
+ * Copyright (c) 2017-2019 GMRV/URJC.
+ *
+ * Authors: Gonzalo Bayo Martinez <gonzalo.bayo@urjc.es>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "ExternalSorter.h"
+
+#include <QCoreApplication>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <queue>
+
+#include "BinaryIO.h"
+#include "CsvFormat.h"
+#include "CsvReader.h"
+#include "NumberFormat.h"
+
+namespace vishnu
+{
+
+  namespace
+  {
+    //Key fields are encoded so that keys compare with memcmp: numbers are
+    //tagged first and stored as order preserving big endian doubles, text
+    //follows with a terminator. parseNumber ignores the locale, so keys and
+    //sorted order don't depend on LC_NUMERIC
+    const char NUMBER_TAG = '\x01';
+    const char TEXT_TAG = '\x02';
+
+    void appendKeyField( std::string& key, const StringView& field )
+    {
+      double value;
+      if ( !parseNumber( field, value ) )
+      {
+        key += TEXT_TAG;
+        key.append( field.data, field.size );
+        key += '\0';
+        return;
+      }
+
+      uint64_t bits;
+      std::memcpy( &bits, &value, sizeof( bits ) );
+      bits = ( bits >> 63 ) ? ~bits : ( bits | ( 1ULL << 63 ) );
+      key += NUMBER_TAG;
+      for ( int i = 7; i >= 0; --i )
+      {
+        key += static_cast< char >( ( bits >> ( 8 * i ) ) & 0xFF );
+      }
+    }
+
+    //Records: key size, row size, key and row, the row being length
+    //prefixed fields
+    StringView getKey( const char* record )
+    {
+      return StringView( record + 8, decodeUInt32( record ) );
+    }
+
+    StringView getRow( const char* record )
+    {
+      return StringView( record + 8 + decodeUInt32( record ),
+        decodeUInt32( record + 4 ) );
+    }
+
+    bool isLess( const StringView& a, const StringView& b )
+    {
+      int comparison = std::memcmp( a.data, b.data,
+        std::min( a.size, b.size ) );
+      return comparison < 0 || ( comparison == 0 && a.size < b.size );
+    }
+
+    //Sequential reader of a run file
+    struct RunReader
+    {
+      std::ifstream file;
+      std::string record;
+
+      bool next( void )
+      {
+        char sizes[ 8 ];
+        if ( !file.read( sizes, 8 ) )
+        {
+          return false;
+        }
+        size_t size = 8 + decodeUInt32( sizes ) + decodeUInt32( sizes + 4 );
+        record.resize( size );
+        std::memcpy( &record[ 0 ], sizes, 8 );
+        return static_cast< bool >( file.read( &record[ 8 ], size - 8 ) );
+      }
+    };
+  }
+
+  ExternalSorter::ExternalSorter( const std::vector< std::string >& headers,
+    const std::vector< std::string >& primaryKeys,
+    const size_t& memoryBudget, const std::string& tempFolder )
+    : _headers( headers )
+    , _memoryBudget( std::max( memoryBudget,
+        static_cast< size_t >( SORT_MIN_MEMORY_BUDGET ) ) )
+    , _tempFolder( tempFolder )
+    , _runCounter( 0 )
+  {
+    for ( const auto& primaryKey : primaryKeys )
+    {
+      for ( size_t col = 0; col < _headers.size( ); ++col )
+      {
+        if ( _headers[ col ] == primaryKey )
+        {
+          _keyColumns.emplace_back( col );
+          break;
+        }
+      }
+    }
+  }
+
+  ExternalSorter::~ExternalSorter( void )
+  {
+
+  }
+
+  bool ExternalSorter::sort( const std::string& path, DataSetWriter& writer )
+  {
+    _error.clear( );
+
+    CsvReader reader( path );
+    std::vector< std::string > headers;
+    if ( !reader.isOpen( ) )
+    {
+      _error = "Can't open " + path + " file.";
+      return false;
+    }
+    writer.writeLine( joinCsvFields( _headers ) );
+    if ( !reader.readHeaders( headers ) )
+    {
+      return true;
+    }
+
+    //Run generation
+    std::vector< int > columns;
+    for ( size_t col = 0; col < _headers.size( ); ++col )
+    {
+      columns.emplace_back( static_cast< int >( col ) );
+    }
+    reader.setProjection( columns, MISSING_DATA_FIELD );
+
+    std::vector< std::string > runPaths;
+    std::vector< StringView > fields;
+    Run run;
+    bool result = true;
+    size_t rows = 0;
+    size_t position = reader.getPosition( );
+    while ( reader.readRecord( fields ) )
+    {
+      appendRecord( run, fields );
+      if ( run.data.size( ) + run.records.size( ) * sizeof( size_t )
+        > _memoryBudget )
+      {
+        sortRun( run );
+        if ( !writeRun( run, runPaths ) )
+        {
+          result = false;
+          break;
+        }
+        clearRun( run );
+      }
+      if ( ++rows % PROGRESS_UPDATE_ROWS == 0 )
+      {
+        if ( _progress )
+        {
+          _progress->addDone( reader.getPosition( ) - position );
+          position = reader.getPosition( );
+        }
+        if ( isCanceled( ) )
+        {
+          result = false;
+          break;
+        }
+      }
+    }
+    if ( _progress )
+    {
+      _progress->addDone( reader.getSize( ) - position );
+    }
+
+    //Everything fit in memory
+    if ( result && runPaths.empty( ) )
+    {
+      sortRun( run );
+      for ( size_t i = 0; i < run.records.size( ); ++i )
+      {
+        writeRecord( getRow( run.data.data( ) + run.records[ i ] ), writer );
+        if ( ( i + 1 ) % PROGRESS_UPDATE_ROWS == 0 && isCanceled( ) )
+        {
+          result = false;
+          break;
+        }
+      }
+      clearRun( run );
+      return result;
+    }
+
+    if ( result && !run.records.empty( ) )
+    {
+      sortRun( run );
+      result = writeRun( run, runPaths );
+    }
+    //Memory is released before merging
+    clearRun( run );
+    run = Run( );
+
+    //Runs are merged in groups until one pass can merge them all
+    while ( result && runPaths.size( ) > SORT_MAX_MERGE_RUNS )
+    {
+      std::vector< std::string > mergedPaths;
+      for ( size_t begin = 0; begin < runPaths.size( ) && result;
+        begin += SORT_MAX_MERGE_RUNS )
+      {
+        size_t end = std::min( begin + SORT_MAX_MERGE_RUNS, runPaths.size( ) );
+        std::vector< std::string > groupPaths( runPaths.begin( ) + begin,
+          runPaths.begin( ) + end );
+        mergedPaths.emplace_back( getRunPath( ) );
+        result = mergeRuns( groupPaths, nullptr, mergedPaths.back( ) );
+        for ( const auto& groupPath : groupPaths )
+        {
+          std::remove( groupPath.c_str( ) );
+        }
+      }
+      if ( !result )
+      {
+        runPaths.insert( runPaths.end( ), mergedPaths.begin( ),
+          mergedPaths.end( ) );
+        break;
+      }
+      runPaths = mergedPaths;
+    }
+    if ( result )
+    {
+      result = mergeRuns( runPaths, &writer, std::string( ) );
+    }
+
+    for ( const auto& runPath : runPaths )
+    {
+      std::remove( runPath.c_str( ) );
+    }
+    return result;
+  }
+
+  std::string ExternalSorter::getError( void ) const
+  {
+    return _error;
+  }
+
+  void ExternalSorter::setProgress( const BuildProgressPtr& progress )
+  {
+    _progress = progress;
+  }
+
+  void ExternalSorter::setNullBitmap( const NullBitmapWriterPtr& nullBitmap )
+  {
+    _nullBitmap = nullBitmap;
+  }
+
+  bool ExternalSorter::isCanceled( void )
+  {
+    if ( _progress && _progress->isCanceled( ) )
+    {
+      _error = "Canceled.";
+      return true;
+    }
+    return false;
+  }
+
+  void ExternalSorter::appendRecord( Run& run,
+    std::vector< StringView >& fields )
+  {
+    size_t dataCapacity = run.data.capacity( );
+    size_t recordsCapacity = run.records.capacity( );
+    _key.clear( );
+    for ( const auto& keyColumn : _keyColumns )
+    {
+      fields[ keyColumn ].trim( );
+      appendKeyField( _key, fields[ keyColumn ] );
+    }
+    size_t rowSize = 0;
+    for ( auto& field : fields )
+    {
+      field.trim( );
+      rowSize += 4 + field.size;
+    }
+
+    run.records.emplace_back( run.data.size( ) );
+    appendUInt32( run.data, static_cast< uint32_t >( _key.size( ) ) );
+    appendUInt32( run.data, static_cast< uint32_t >( rowSize ) );
+    run.data += _key;
+    for ( const auto& field : fields )
+    {
+      appendUInt32( run.data, static_cast< uint32_t >( field.size ) );
+      run.data.append( field.data, field.size );
+    }
+    run.allocations += ( run.data.capacity( ) != dataCapacity ) ? 1 : 0;
+    run.allocations += ( run.records.capacity( ) != recordsCapacity ) ? 1 : 0;
+  }
+
+  void ExternalSorter::sortRun( Run& run ) const
+  {
+    const char* data = run.data.data( );
+    std::stable_sort( run.records.begin( ), run.records.end( ),
+      [ data ]( const size_t& a, const size_t& b )
+      {
+        return isLess( getKey( data + a ), getKey( data + b ) );
+      } );
+  }
+
+  void ExternalSorter::clearRun( Run& run )
+  {
+    if ( _progress && !run.records.empty( ) )
+    {
+      _progress->addBatch( run.data.size( )
+        + run.records.size( ) * sizeof( size_t ), run.allocations );
+    }
+    run.data.clear( );
+    run.records.clear( );
+    run.allocations = 0;
+  }
+
+  bool ExternalSorter::writeRun( const Run& run,
+    std::vector< std::string >& runPaths )
+  {
+    runPaths.emplace_back( getRunPath( ) );
+    std::ofstream file( runPaths.back( ), std::ios::binary | std::ios::trunc );
+    for ( const auto& record : run.records )
+    {
+      const char* data = run.data.data( ) + record;
+      file.write( data, 8 + decodeUInt32( data ) + decodeUInt32( data + 4 ) );
+    }
+    file.close( );
+    if ( file.fail( ) )
+    {
+      _error = "Can't write " + runPaths.back( ) + " file.";
+      return false;
+    }
+    return true;
+  }
+
+  bool ExternalSorter::mergeRuns( const std::vector< std::string >& runPaths,
+    DataSetWriter* writer, const std::string& runPath )
+  {
+    std::vector< std::unique_ptr< RunReader > > readers;
+    for ( const auto& path : runPaths )
+    {
+      readers.emplace_back( new RunReader( ) );
+      readers.back( )->file.open( path, std::ios::binary );
+      if ( !readers.back( )->file.is_open( ) )
+      {
+        _error = "Can't open " + path + " file.";
+        return false;
+      }
+    }
+
+    std::ofstream output;
+    if ( writer == nullptr )
+    {
+      output.open( runPath, std::ios::binary | std::ios::trunc );
+      if ( !output.is_open( ) )
+      {
+        _error = "Can't create " + runPath + " file.";
+        return false;
+      }
+    }
+
+    //Equal keys are taken from the earlier run, keeping the input order
+    auto greater = [ &readers ]( const size_t& a, const size_t& b )
+    {
+      StringView keyA = getKey( readers[ a ]->record.data( ) );
+      StringView keyB = getKey( readers[ b ]->record.data( ) );
+      return isLess( keyB, keyA ) || ( !isLess( keyA, keyB ) && a > b );
+    };
+    std::priority_queue< size_t, std::vector< size_t >,
+      std::function< bool( const size_t&, const size_t& ) > > queue( greater );
+    for ( size_t i = 0; i < readers.size( ); ++i )
+    {
+      if ( readers[ i ]->next( ) )
+      {
+        queue.push( i );
+      }
+    }
+
+    size_t rows = 0;
+    while ( !queue.empty( ) )
+    {
+      size_t i = queue.top( );
+      queue.pop( );
+      const std::string& record = readers[ i ]->record;
+      if ( writer != nullptr )
+      {
+        writeRecord( getRow( record.data( ) ), *writer );
+      }
+      else if ( !output.write( record.data( ), record.size( ) ) )
+      {
+        _error = "Can't write " + runPath + " file.";
+        return false;
+      }
+      if ( readers[ i ]->next( ) )
+      {
+        queue.push( i );
+      }
+      if ( ++rows % PROGRESS_UPDATE_ROWS == 0 && isCanceled( ) )
+      {
+        return false;
+      }
+    }
+    if ( writer == nullptr )
+    {
+      output.close( );
+      if ( output.fail( ) )
+      {
+        _error = "Can't write " + runPath + " file.";
+        return false;
+      }
+    }
+    return true;
+  }
+
+  void ExternalSorter::writeRecord( const StringView& row,
+    DataSetWriter& writer )
+  {
+    const StringView missing( MISSING_DATA_FIELD,
+      sizeof( MISSING_DATA_FIELD ) - 1 );
+    std::string& line = _line;
+    std::vector< uint8_t >& nulls = _nulls;
+    line.clear( );
+    nulls.clear( );
+    size_t col = 0;
+    for ( size_t i = 0; i < row.size; ++col )
+    {
+      StringView field( row.data + i + 4, decodeUInt32( row.data + i ) );
+      i += 4 + field.size;
+      if ( col != 0 )
+      {
+        line += ",";
+      }
+      if ( _nullBitmap && field == missing )
+      {
+        NullBitmapWriter::setNull( nulls, col );
+        //A blank line would not be read back as a record
+        if ( _headers.size( ) == 1 )
+        {
+          line += "\"\"";
+        }
+        continue;
+      }
+      appendCsvField( line, field );
+    }
+    line += "\n";
+    writer.write( line );
+    if ( _nullBitmap )
+    {
+      _nullBitmap->addRows( 1, nulls );
+    }
+    if ( _progress )
+    {
+      _progress->addDone( line.size( ) );
+    }
+  }
+
+  std::string ExternalSorter::getRunPath( void )
+  {
+    //Processes sharing the temporary folder never pick the same name
+    return _tempFolder + std::string( "/vishnu-sort-" )
+      + std::to_string( QCoreApplication::applicationPid( ) )
+      + std::string( "-" )
+      + std::to_string( std::chrono::steady_clock::now( )
+        .time_since_epoch( ).count( ) )
+      + std::string( "-" ) + std::to_string( _runCounter++ )
+      + std::string( ".tmp" );
+  }
+
+}
@@ -0,0 +1,110 @@
+/*
+ * Vishnu
+ * Copyright (c) 2017-2019 GMRV/URJC.
+ *
+ * Authors: Gonzalo Bayo Martinez <gonzalo.bayo@urjc.es>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef VISHNU_EXTERNALSORTER_H
+#define VISHNU_EXTERNALSORTER_H
+
+#include <string>
+#include <vector>
+#include <memory>
+
+#include "BuildProgress.h"
+#include "DataSetWriter.h"
+#include "NullBitmapWriter.h"
+#include "StringView.h"
+
+namespace vishnu
+{
+
+  class ExternalSorter;
+  using ExternalSorterPtr = std::shared_ptr< ExternalSorter >;
+
+  /*
+   * Sorts the records of a CSV file by its primary key fields, numbers
+   * before text and numbers by value. Records are gathered until the memory
+   * budget is reached, sorted and written as a run in the temporary folder;
+   * runs are then merged, SORT_MAX_MERGE_RUNS at a time. Records with the
+   * same key keep their order.
+   */
+  class ExternalSorter
+  {
+
+    public:
+
+      ExternalSorter( const std::vector< std::string >& headers,
+        const std::vector< std::string >& primaryKeys,
+        const size_t& memoryBudget = DEFAULT_SORT_MEMORY_BUDGET,
+        const std::string& tempFolder = std::string( "." ) );
+      ~ExternalSorter( void );
+
+      //Writes the headers and the sorted records of the CSV file at path,
+      //whose headers must be the given ones
+      bool sort( const std::string& path, DataSetWriter& writer );
+
+      std::string getError( void ) const;
+
+      //Source bytes read and written are added to progress, and sorting
+      //stops early when it is canceled
+      void setProgress( const BuildProgressPtr& progress );
+
+      //MISSING_DATA_FIELD fields are written empty and recorded in the bitmap
+      void setNullBitmap( const NullBitmapWriterPtr& nullBitmap );
+
+    private:
+
+      //Records in memory, encoded as in run files. Buffers are kept from
+      //run to run
+      struct Run
+      {
+        std::string data;
+        std::vector< size_t > records;
+        //Buffers grown since the run was started
+        size_t allocations = 0;
+      };
+
+      std::vector< std::string > _headers;
+      std::vector< size_t > _keyColumns;
+      size_t _memoryBudget;
+      std::string _tempFolder;
+      std::string _error;
+      BuildProgressPtr _progress;
+      NullBitmapWriterPtr _nullBitmap;
+      size_t _runCounter;
+
+      //Buffers reused between records
+      std::string _key;
+      std::string _line;
+      std::vector< uint8_t > _nulls;
+
+      bool isCanceled( void );
+
+      void appendRecord( Run& run, std::vector< StringView >& fields );
+      void sortRun( Run& run ) const;
+      void clearRun( Run& run );
+      bool writeRun( const Run& run, std::vector< std::string >& runPaths );
+      bool mergeRuns( const std::vector< std::string >& runPaths,
+        DataSetWriter* writer, const std::string& runPath );
+      void writeRecord( const StringView& row, DataSetWriter& writer );
+      std::string getRunPath( void );
+  };
+
+}
+
+#endif
@@ -0,0 +1,123 @@
+/*
+ * Vishnu
+ * Copyright (c) 2017-2019 GMRV/URJC.
+ *
+ * Authors: Gonzalo Bayo Martinez <gonzalo.bayo@urjc.es>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "FileFingerprint.h"
+
+#include <algorithm>
+
+#include <sys/stat.h>
+#include <sys/types.h>
+
+#include "MappedFile.h"
+#include "../Definitions.hpp"
+
+namespace vishnu
+{
+
+  bool FileFingerprint::compute( const std::string& path,
+    FileFingerprint& fingerprint )
+  {
+    if ( !stat( path, fingerprint ) )
+    {
+      return false;
+    }
+
+    MappedFile file( path );
+    if ( !file.isOpen( ) )
+    {
+      return false;
+    }
+
+    //Only the head and the tail are read, so big files are cheap to check
+    size_t size = file.getSize( );
+    size_t sample = std::min( size,
+      static_cast< size_t >( FINGERPRINT_SAMPLE_SIZE ) );
+    fingerprint.contentHash = hash( file.getData( ), sample );
+    if ( size > sample )
+    {
+      size_t tail = std::min( size - sample,
+        static_cast< size_t >( FINGERPRINT_SAMPLE_SIZE ) );
+      fingerprint.contentHash = hash( file.getData( ) + size - tail, tail,
+        fingerprint.contentHash );
+    }
+    return true;
+  }
+
+  bool FileFingerprint::computeFull( const std::string& path,
+    FileFingerprint& fingerprint )
+  {
+    if ( !stat( path, fingerprint ) )
+    {
+      return false;
+    }
+
+    MappedFile file( path );
+    if ( !file.isOpen( ) )
+    {
+      return false;
+    }
+    fingerprint.contentHash = hash( file.getData( ), file.getSize( ) );
+    return true;
+  }
+
+  bool FileFingerprint::stat( const std::string& path,
+    FileFingerprint& fingerprint )
+  {
+#ifdef _WIN32
+    struct _stat64 status;
+    if ( ::_stat64( path.c_str( ), &status ) != 0 )
+    {
+      return false;
+    }
+    fingerprint.modificationTime =
+      static_cast< int64_t >( status.st_mtime ) * 1000000000LL;
+#else
+    struct ::stat status;
+    if ( ::stat( path.c_str( ), &status ) != 0 )
+    {
+      return false;
+    }
+  #ifdef __APPLE__
+    fingerprint.modificationTime =
+      static_cast< int64_t >( status.st_mtimespec.tv_sec ) * 1000000000LL
+      + status.st_mtimespec.tv_nsec;
+  #else
+    fingerprint.modificationTime =
+      static_cast< int64_t >( status.st_mtim.tv_sec ) * 1000000000LL
+      + status.st_mtim.tv_nsec;
+  #endif
+#endif
+    fingerprint.size = static_cast< uint64_t >( status.st_size );
+    return true;
+  }
+
+  uint64_t FileFingerprint::hash( const char* data, const size_t& size,
+    const uint64_t& seed )
+  {
+    uint64_t result = seed;
+    for ( size_t i = 0; i < size; ++i )
+    {
+      result ^= static_cast< unsigned char >( data[ i ] );
+      result *= 1099511628211ULL;
+    }
+    return result;
+  }
+
+}
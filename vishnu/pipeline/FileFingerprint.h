@@ -0,0 +1,69 @@
+/*
+ * Vishnu
+ * Copyright (c) 2017-2019 GMRV/URJC.
+ *
+ * Authors: Gonzalo Bayo Martinez <gonzalo.bayo@urjc.es>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef VISHNU_FILEFINGERPRINT_H
+#define VISHNU_FILEFINGERPRINT_H
+
+#include <cstdint>
+#include <string>
+
+namespace vishnu
+{
+
+  /*
+   * Identifies a version of a file by size, modification time and a hash of
+   * its first and last FINGERPRINT_SAMPLE_SIZE bytes (or of all of them).
+   */
+  struct FileFingerprint
+  {
+    uint64_t size = 0;
+    int64_t modificationTime = 0;
+    uint64_t contentHash = 0;
+
+    bool operator==( const FileFingerprint& other ) const
+    {
+      return size == other.size && modificationTime == other.modificationTime
+        && contentHash == other.contentHash;
+    }
+
+    bool operator!=( const FileFingerprint& other ) const
+    {
+      return !( *this == other );
+    }
+
+    static bool compute( const std::string& path,
+      FileFingerprint& fingerprint );
+
+    //Hashes the whole file instead of its head and tail, for comparisons
+    //that must see any change of the content
+    static bool computeFull( const std::string& path,
+      FileFingerprint& fingerprint );
+
+    //Size and modification time only, without reading the file
+    static bool stat( const std::string& path, FileFingerprint& fingerprint );
+
+    //64 bit FNV-1a
+    static uint64_t hash( const char* data, const size_t& size,
+      const uint64_t& seed = 14695981039346656037ULL );
+  };
+
+}
+
+#endif
@@ -0,0 +1,131 @@
+/*
+ * Vishnu
+ * Copyright (c) 2017-2019 GMRV/URJC.
+ *
+ * Authors: Gonzalo Bayo Martinez <gonzalo.bayo@urjc.es>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "GeometryArchive.h"
+
+#include <cstring>
+
+#include "BinaryIO.h"
+#include "../Definitions.hpp"
+
+namespace vishnu
+{
+
+  GeometryArchive::GeometryArchive( const std::string& path )
+    : _file( path )
+    , _open( false )
+  {
+    _open = _file.isOpen( ) && parseIndex( );
+  }
+
+  GeometryArchive::~GeometryArchive( void )
+  {
+
+  }
+
+  bool GeometryArchive::isOpen( void ) const
+  {
+    return _open;
+  }
+
+  const GeometryArchive::Entries& GeometryArchive::getEntries( void ) const
+  {
+    return _entries;
+  }
+
+  const GeometryArchive::Entry* GeometryArchive::find(
+    const std::string& name ) const
+  {
+    auto entry = _names.find( name );
+    if ( entry == _names.end( ) )
+    {
+      return nullptr;
+    }
+    return &_entries.at( entry->second );
+  }
+
+  const char* GeometryArchive::getData( const Entry& entry ) const
+  {
+    return _file.getData( ) + entry.offset;
+  }
+
+  bool GeometryArchive::read( const Entry& entry, QByteArray& data ) const
+  {
+    if ( !_open )
+    {
+      return false;
+    }
+    if ( !entry.compressed )
+    {
+      data = QByteArray( getData( entry ),
+        static_cast< int >( entry.storedSize ) );
+      return true;
+    }
+    data = qUncompress( reinterpret_cast< const uchar* >( getData( entry ) ),
+      static_cast< int >( entry.storedSize ) );
+    return static_cast< uint64_t >( data.size( ) ) == entry.size;
+  }
+
+  bool GeometryArchive::parseIndex( void )
+  {
+    const char* data = _file.getData( );
+    uint64_t size = _file.getSize( );
+    if ( data == nullptr || size < GEOMETRY_ARCHIVE_HEADER_SIZE
+      || std::memcmp( data, GEOMETRY_ARCHIVE_MAGIC, 8 ) != 0
+      || decodeUInt32( data + 8 ) != GEOMETRY_ARCHIVE_VERSION )
+    {
+      return false;
+    }
+
+    uint32_t entries = decodeUInt32( data + 12 );
+    uint64_t tableOffset = decodeUInt64( data + 16 );
+    uint64_t namesOffset = decodeUInt64( data + 24 );
+    uint64_t namesSize = decodeUInt64( data + 32 );
+    if ( tableOffset > size || static_cast< uint64_t >( entries )
+        * GEOMETRY_ARCHIVE_ENTRY_SIZE > size - tableOffset
+      || namesOffset > size || namesSize > size - namesOffset )
+    {
+      return false;
+    }
+
+    _entries.resize( entries );
+    const char* current = data + tableOffset;
+    for ( uint32_t i = 0; i < entries; ++i )
+    {
+      Entry& entry = _entries.at( i );
+      entry.offset = decodeUInt64( current );
+      entry.storedSize = decodeUInt64( current + 8 );
+      entry.size = decodeUInt64( current + 16 );
+      uint32_t nameOffset = decodeUInt32( current + 24 );
+      uint32_t nameSize = decodeUInt32( current + 28 );
+      entry.compressed = ( decodeUInt32( current + 32 ) & 1u ) != 0;
+      current += GEOMETRY_ARCHIVE_ENTRY_SIZE;
+      if ( entry.offset > size || entry.storedSize > size - entry.offset
+        || nameOffset > namesSize || nameSize > namesSize - nameOffset )
+      {
+        return false;
+      }
+      entry.name.assign( data + namesOffset + nameOffset, nameSize );
+      _names[ entry.name ] = i;
+    }
+    return true;
+  }
+
+}
@@ -0,0 +1,99 @@
+/*
+ * Vishnu
+ * Copyright (c) 2017-2019 GMRV/URJC.
+ *
+ * Authors: Gonzalo Bayo Martinez <gonzalo.bayo@urjc.es>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef VISHNU_GEOMETRYARCHIVE_H
+#define VISHNU_GEOMETRYARCHIVE_H
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include <memory>
+
+#include <QByteArray>
+
+#include "MappedFile.h"
+
+namespace vishnu
+{
+
+  class GeometryArchive;
+  using GeometryArchivePtr = std::shared_ptr< GeometryArchive >;
+
+  /*
+   * Reads the geometric data of a dataset packed in one file by
+   * GeometryArchiveWriter. The archive is mapped and its entries are found
+   * by name, so any mesh is reached with a single seek.
+   *
+   * Layout (little endian): a GEOMETRY_ARCHIVE_HEADER_SIZE bytes header
+   * (magic, version, entries, entry table offset, names offset, names size
+   * and a reserved field), the data of every entry aligned to
+   * GEOMETRY_ARCHIVE_ALIGNMENT, the entry table sorted by name and the
+   * names. Every GEOMETRY_ARCHIVE_ENTRY_SIZE bytes entry holds the data
+   * offset, stored size and size, the name offset (from the names) and
+   * size, flags (bit 0 set if compressed with qCompress) and a reserved
+   * field.
+   */
+  class GeometryArchive
+  {
+
+    public:
+
+      struct Entry
+      {
+        //Relative to the geometric data folder
+        std::string name;
+        uint64_t offset = 0;
+        uint64_t storedSize = 0;
+        uint64_t size = 0;
+        bool compressed = false;
+      };
+      using Entries = std::vector< Entry >;
+
+      explicit GeometryArchive( const std::string& path );
+      ~GeometryArchive( void );
+
+      bool isOpen( void ) const;
+
+      //Sorted by name
+      const Entries& getEntries( void ) const;
+
+      //Null if there is no entry with that name
+      const Entry* find( const std::string& name ) const;
+
+      //Stored bytes of an entry, inside the mapping
+      const char* getData( const Entry& entry ) const;
+
+      //Contents of an entry, uncompressed if needed
+      bool read( const Entry& entry, QByteArray& data ) const;
+
+    private:
+
+      MappedFile _file;
+      bool _open;
+      Entries _entries;
+      std::unordered_map< std::string, size_t > _names;
+
+      bool parseIndex( void );
+  };
+
+}
+
+#endif
@@ -0,0 +1,282 @@
+/*
+ * Vishnu
+ * Copyright (c) 2017-2019 GMRV/URJC.
+ *
+ * Authors: Gonzalo Bayo Martinez <gonzalo.bayo@urjc.es>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "GeometryArchiveWriter.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <climits>
+#include <cstdio>
+#include <thread>
+
+#include <QByteArray>
+
+#include "BinaryIO.h"
+#include "../Definitions.hpp"
+
+namespace vishnu
+{
+
+  namespace
+  {
+
+    //A file read, and maybe compressed, by a worker
+    struct PackedFile
+    {
+      QByteArray data;
+      uint64_t size = 0;
+      bool compressed = false;
+      std::string error;
+    };
+
+    bool readFile( const std::string& filePath, QByteArray& data )
+    {
+      std::FILE* file = std::fopen( filePath.c_str( ), "rb" );
+      if ( file == nullptr )
+      {
+        return false;
+      }
+      bool result = std::fseek( file, 0, SEEK_END ) == 0;
+      long size = result ? std::ftell( file ) : -1;
+      result = size >= 0 && size <= INT_MAX
+        && std::fseek( file, 0, SEEK_SET ) == 0;
+      if ( result )
+      {
+        data.resize( static_cast< int >( size ) );
+        result = std::fread( data.data( ), 1, static_cast< size_t >( size ),
+          file ) == static_cast< size_t >( size );
+      }
+      std::fclose( file );
+      return result;
+    }
+
+  }
+
+  GeometryArchiveWriter::GeometryArchiveWriter( const int& compression,
+    const size_t& workers )
+    : _compression( std::max( 0, std::min( compression, 9 ) ) )
+    , _workers( workers )
+    , _compressedFiles( 0 )
+  {
+    if ( _workers == 0 )
+    {
+      _workers = GEOMETRY_STAGING_WORKERS;
+    }
+  }
+
+  bool GeometryArchiveWriter::write( const std::string& path,
+    const Files& files )
+  {
+    _error.clear( );
+    _compressedFiles = 0;
+
+    //Entries are sorted by name, so is the entry table
+    Files sortedFiles = files;
+    std::sort( sortedFiles.begin( ), sortedFiles.end( ),
+      [ ]( const File& a, const File& b ) { return a.name < b.name; } );
+
+    static std::atomic< size_t > archiveCounter( 0 );
+    std::string tempPath = path + std::string( "." )
+      + std::to_string( std::chrono::steady_clock::now( )
+        .time_since_epoch( ).count( ) )
+      + std::string( "-" ) + std::to_string( archiveCounter++ )
+      + std::string( ".tmp" );
+    std::ofstream archive( tempPath, std::ios::binary | std::ios::trunc );
+    bool result = archive.is_open( ) && writeArchive( archive, sortedFiles );
+    archive.close( );
+    if ( result && archive.fail( ) )
+    {
+      _error = "Can't write " + path + " file.";
+      result = false;
+    }
+    else if ( !result && _error.empty( ) && !isCanceled( ) )
+    {
+      _error = "Can't create " + path + " file.";
+    }
+
+    if ( result )
+    {
+      std::remove( path.c_str( ) );
+      result = ( std::rename( tempPath.c_str( ), path.c_str( ) ) == 0 );
+      if ( !result )
+      {
+        _error = "Can't create " + path + " file.";
+      }
+    }
+    if ( !result )
+    {
+      std::remove( tempPath.c_str( ) );
+    }
+    return result;
+  }
+
+  size_t GeometryArchiveWriter::getCompressedFiles( void ) const
+  {
+    return _compressedFiles;
+  }
+
+  std::string GeometryArchiveWriter::getError( void ) const
+  {
+    return _error;
+  }
+
+  void GeometryArchiveWriter::setProgress( const BuildProgressPtr& progress )
+  {
+    _progress = progress;
+  }
+
+  bool GeometryArchiveWriter::isCanceled( void ) const
+  {
+    return _progress && _progress->isCanceled( );
+  }
+
+  bool GeometryArchiveWriter::writeArchive( std::ofstream& archive,
+    const Files& files )
+  {
+    //The header is written last, once the tables are placed
+    static const char padding[ GEOMETRY_ARCHIVE_HEADER_SIZE ] = { };
+    archive.write( padding, GEOMETRY_ARCHIVE_HEADER_SIZE );
+    uint64_t offset = GEOMETRY_ARCHIVE_HEADER_SIZE;
+
+    std::string table;
+    std::string names;
+    size_t batchSize = _workers * GEOMETRY_ARCHIVE_BATCH_FILES;
+    std::vector< PackedFile > batch;
+    for ( size_t begin = 0; begin < files.size( ); begin += batchSize )
+    {
+      size_t end = std::min( begin + batchSize, files.size( ) );
+      batch.assign( end - begin, PackedFile( ) );
+
+      std::atomic< bool > abort( false );
+      std::atomic< size_t > nextFile( begin );
+      std::vector< std::thread > workers;
+      size_t workersSize = std::min( _workers, end - begin );
+      for ( size_t i = 0; i < workersSize; ++i )
+      {
+        workers.emplace_back( [ & ]( )
+        {
+          size_t index;
+          while ( !abort && !isCanceled( )
+            && ( index = nextFile++ ) < end )
+          {
+            const File& file = files.at( index );
+            PackedFile& packedFile = batch.at( index - begin );
+            if ( !readFile( file.filePath, packedFile.data ) )
+            {
+              packedFile.error = "Can't read " + file.filePath + " file.";
+              abort = true;
+              break;
+            }
+            packedFile.size = static_cast< uint64_t >(
+              packedFile.data.size( ) );
+            if ( _compression > 0 )
+            {
+              QByteArray compressed =
+                qCompress( packedFile.data, _compression );
+              if ( compressed.size( ) < packedFile.data.size( ) )
+              {
+                packedFile.data = compressed;
+                packedFile.compressed = true;
+              }
+            }
+          }
+        } );
+      }
+      for ( auto& worker : workers )
+      {
+        worker.join( );
+      }
+      if ( isCanceled( ) )
+      {
+        return false;
+      }
+
+      for ( size_t i = 0; i < batch.size( ); ++i )
+      {
+        PackedFile& packedFile = batch.at( i );
+        if ( !packedFile.error.empty( ) )
+        {
+          _error = packedFile.error;
+          return false;
+        }
+        const std::string& name = files.at( begin + i ).name;
+        if ( names.size( ) + name.size( ) > UINT32_MAX )
+        {
+          _error = "Too many geometry files to pack.";
+          return false;
+        }
+
+        uint64_t alignment = ( GEOMETRY_ARCHIVE_ALIGNMENT
+          - offset % GEOMETRY_ARCHIVE_ALIGNMENT ) % GEOMETRY_ARCHIVE_ALIGNMENT;
+        archive.write( padding, static_cast< std::streamsize >( alignment ) );
+        offset += alignment;
+        archive.write( packedFile.data.constData( ), packedFile.data.size( ) );
+
+        char entry[ GEOMETRY_ARCHIVE_ENTRY_SIZE ] = { };
+        encodeUInt64( entry, offset );
+        encodeUInt64( entry + 8,
+          static_cast< uint64_t >( packedFile.data.size( ) ) );
+        encodeUInt64( entry + 16, packedFile.size );
+        encodeUInt32( entry + 24, static_cast< uint32_t >( names.size( ) ) );
+        encodeUInt32( entry + 28, static_cast< uint32_t >( name.size( ) ) );
+        encodeUInt32( entry + 32, packedFile.compressed ? 1u : 0u );
+        table.append( entry, GEOMETRY_ARCHIVE_ENTRY_SIZE );
+        names.append( name );
+        offset += static_cast< uint64_t >( packedFile.data.size( ) );
+
+        if ( packedFile.compressed )
+        {
+          ++_compressedFiles;
+        }
+        if ( _progress )
+        {
+          _progress->addDone( static_cast< size_t >( packedFile.size ) );
+          _progress->addFiles( 1 );
+        }
+        packedFile.data = QByteArray( );
+      }
+      if ( !archive )
+      {
+        return false;
+      }
+    }
+
+    uint64_t alignment = ( GEOMETRY_ARCHIVE_ALIGNMENT
+      - offset % GEOMETRY_ARCHIVE_ALIGNMENT ) % GEOMETRY_ARCHIVE_ALIGNMENT;
+    archive.write( padding, static_cast< std::streamsize >( alignment ) );
+    uint64_t tableOffset = offset + alignment;
+    archive.write( table.data( ), static_cast< std::streamsize >(
+      table.size( ) ) );
+    archive.write( names.data( ), static_cast< std::streamsize >(
+      names.size( ) ) );
+
+    archive.seekp( 0 );
+    archive.write( GEOMETRY_ARCHIVE_MAGIC, 8 );
+    writeUInt32( archive, GEOMETRY_ARCHIVE_VERSION );
+    writeUInt32( archive, static_cast< uint32_t >( files.size( ) ) );
+    writeUInt64( archive, tableOffset );
+    writeUInt64( archive, tableOffset + table.size( ) );
+    writeUInt64( archive, names.size( ) );
+    writeUInt64( archive, 0 );
+    return static_cast< bool >( archive );
+  }
+
+}
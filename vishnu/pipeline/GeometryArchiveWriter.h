@@ -0,0 +1,90 @@
+/*
+ * Vishnu
+ * Copyright (c) 2017-2019 GMRV/URJC.
+ *
+ * Authors: Gonzalo Bayo Martinez <gonzalo.bayo@urjc.es>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef VISHNU_GEOMETRYARCHIVEWRITER_H
+#define VISHNU_GEOMETRYARCHIVEWRITER_H
+
+#include <fstream>
+#include <string>
+#include <vector>
+#include <memory>
+
+#include "BuildProgress.h"
+
+namespace vishnu
+{
+
+  class GeometryArchiveWriter;
+  using GeometryArchiveWriterPtr = std::shared_ptr< GeometryArchiveWriter >;
+
+  /*
+   * Packs the geometric data files of a dataset in one archive (see
+   * GeometryArchive for its layout), so viewers open a single file instead
+   * of thousands of small ones.
+   *
+   * Files are read, and compressed, by a bounded pool of workers in batches
+   * of GEOMETRY_ARCHIVE_BATCH_FILES files per worker, and written in order.
+   * A compressed file is only kept compressed if it got smaller.
+   */
+  class GeometryArchiveWriter
+  {
+
+    public:
+
+      struct File
+      {
+        //Name of the entry, relative to the geometric data folder
+        std::string name;
+        std::string filePath;
+      };
+      using Files = std::vector< File >;
+
+      //A compression of 0 stores files as they are, 1 to 9 is the zlib
+      //level. A workers value of 0 uses GEOMETRY_STAGING_WORKERS
+      explicit GeometryArchiveWriter( const int& compression = 0,
+        const size_t& workers = 0 );
+
+      //Written to a temporary file renamed once complete. Packed bytes,
+      //before compression, and files are added to progress. Writing stops
+      //at the first error or when progress is canceled
+      bool write( const std::string& path, const Files& files );
+
+      //Files stored compressed in the last archive
+      size_t getCompressedFiles( void ) const;
+
+      std::string getError( void ) const;
+
+      void setProgress( const BuildProgressPtr& progress );
+
+    private:
+
+      int _compression;
+      size_t _workers;
+      size_t _compressedFiles;
+      std::string _error;
+      BuildProgressPtr _progress;
+
+      bool isCanceled( void ) const;
+      bool writeArchive( std::ofstream& archive, const Files& files );
+  };
+
+}
+
+#endif
@@ -0,0 +1,465 @@
+/*
+ * Vishnu
+ * Copyright (c) 2017-2019 GMRV/URJC.
+ *
+ * Authors: Gonzalo Bayo Martinez <gonzalo.bayo@urjc.es>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "GeometryStager.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstdio>
+#include <mutex>
+#include <thread>
+
+#include <QDir>
+#include <QFileInfo>
+
+#ifdef _WIN32
+  #ifndef NOMINMAX
+    #define NOMINMAX
+  #endif
+  #include <windows.h>
+#else
+  #include <fcntl.h>
+  #include <sys/ioctl.h>
+  #include <unistd.h>
+  #ifdef __linux__
+    #include <linux/fs.h>
+  #endif
+#endif
+
+//copy_file_range is wrapped by glibc since 2.27
+#if defined( __linux__ ) && defined( __GLIBC__ ) \
+  && ( __GLIBC__ > 2 || ( __GLIBC__ == 2 && __GLIBC_MINOR__ >= 27 ) )
+  #define VISHNU_COPY_FILE_RANGE
+#endif
+
+#include "FileFingerprint.h"
+#include "../Definitions.hpp"
+
+namespace vishnu
+{
+
+  GeometryStager::GeometryStager( const Mode& mode, const size_t& workers )
+    : _mode( mode )
+    , _workers( workers )
+    , _stagedFiles( { { 0, 0, 0, 0 } } )
+  {
+    if ( _workers == 0 )
+    {
+      _workers = GEOMETRY_STAGING_WORKERS;
+    }
+  }
+
+  GeometryStager::Mode GeometryStager::getMode( void ) const
+  {
+    return _mode;
+  }
+
+  bool GeometryStager::stage( const Files& files )
+  {
+    _error.clear( );
+    _stagedFiles.fill( 0 );
+    _objects.clear( );
+    if ( _store )
+    {
+      _objects.resize( files.size( ) );
+    }
+
+    std::mutex mutex;
+    std::atomic< bool > abort( false );
+    std::atomic< size_t > nextFile( 0 );
+    std::vector< std::thread > workers;
+    size_t workersSize = std::min( _workers, files.size( ) );
+    for ( size_t i = 0; i < workersSize; ++i )
+    {
+      workers.emplace_back( [ & ]( )
+      {
+        //Every worker copies through its own buffer
+        std::vector< char > buffer;
+        size_t index;
+        while ( !abort && ( index = nextFile++ ) < files.size( ) )
+        {
+          Mode usedMode;
+          std::string object;
+          std::string error;
+          bool result = stageFile( files.at( index ), buffer, usedMode,
+            object, error );
+          std::lock_guard< std::mutex > lock( mutex );
+          if ( !result )
+          {
+            //Only the first error is kept
+            if ( !abort )
+            {
+              _error = error;
+            }
+            abort = true;
+            break;
+          }
+          ++_stagedFiles[ static_cast< size_t >( usedMode ) ];
+          if ( _store )
+          {
+            _objects[ index ] = object;
+          }
+        }
+      } );
+    }
+    for ( auto& worker : workers )
+    {
+      worker.join( );
+    }
+    return !abort;
+  }
+
+  size_t GeometryStager::getStagedFiles( const Mode& mode ) const
+  {
+    return _stagedFiles[ static_cast< size_t >( mode ) ];
+  }
+
+  std::vector< std::string > GeometryStager::getObjects( void ) const
+  {
+    return _objects;
+  }
+
+  std::string GeometryStager::getError( void ) const
+  {
+    return _error;
+  }
+
+  void GeometryStager::setProgress( const BuildProgressPtr& progress )
+  {
+    _progress = progress;
+  }
+
+  void GeometryStager::setStore( const GeometryStorePtr& store )
+  {
+    _store = store;
+  }
+
+  GeometryStager::Mode GeometryStager::toMode( const std::string& mode )
+  {
+    if ( mode == "hardLink" )
+    {
+      return Mode::HardLink;
+    }
+    if ( mode == "reflink" )
+    {
+      return Mode::Reflink;
+    }
+    if ( mode == "symlink" )
+    {
+      return Mode::Symlink;
+    }
+    return Mode::Copy;
+  }
+
+  std::string GeometryStager::toString( const Mode& mode )
+  {
+    switch( mode )
+    {
+      case Mode::HardLink:
+        return "hardLink";
+      case Mode::Reflink:
+        return "reflink";
+      case Mode::Symlink:
+        return "symlink";
+      default:
+        return "copy";
+    }
+  }
+
+  bool GeometryStager::isCanceled( void ) const
+  {
+    return _progress && _progress->isCanceled( );
+  }
+
+  bool GeometryStager::stageFile( const File& file,
+    std::vector< char >& buffer, Mode& usedMode, std::string& object,
+    std::string& error ) const
+  {
+    if ( isCanceled( ) )
+    {
+      return false;
+    }
+
+    //Staged from the stored object instead of the source
+    File stagedFile = file;
+    if ( _store )
+    {
+      if ( !storeFile( file, buffer, object, error ) )
+      {
+        return false;
+      }
+      stagedFile.srcFilePath = _store->getObjectPath( object );
+    }
+
+    usedMode = _mode;
+    if ( _store && usedMode == Mode::Copy )
+    {
+      //The file was already copied once into the store, so it is only
+      //copied again when the object can't be shared. Reflinks come first as
+      //they still behave like copies
+      if ( reflink( stagedFile ) )
+      {
+        usedMode = Mode::Reflink;
+      }
+      else if ( hardLink( stagedFile ) )
+      {
+        usedMode = Mode::HardLink;
+      }
+      else if ( symlink( stagedFile ) )
+      {
+        usedMode = Mode::Symlink;
+      }
+      if ( usedMode != Mode::Copy )
+      {
+        addLinked( stagedFile );
+        return true;
+      }
+      return copy( stagedFile, buffer, error );
+    }
+
+    if ( usedMode == Mode::Symlink )
+    {
+      if ( symlink( stagedFile ) )
+      {
+        addLinked( stagedFile );
+        return true;
+      }
+      usedMode = Mode::HardLink;
+    }
+    if ( usedMode == Mode::HardLink )
+    {
+      if ( hardLink( stagedFile ) )
+      {
+        addLinked( stagedFile );
+        return true;
+      }
+      usedMode = Mode::Reflink;
+    }
+    if ( usedMode == Mode::Reflink )
+    {
+      if ( reflink( stagedFile ) )
+      {
+        addLinked( stagedFile );
+        return true;
+      }
+      usedMode = Mode::Copy;
+    }
+    return copy( stagedFile, buffer, error );
+  }
+
+  bool GeometryStager::storeFile( const File& file,
+    std::vector< char >& buffer, std::string& object,
+    std::string& error ) const
+  {
+    if ( !_store->hash( file.srcFilePath, buffer, object ) )
+    {
+      error = "Can't read " + file.srcFilePath + " file.";
+      return false;
+    }
+    if ( _store->contains( object ) )
+    {
+      return true;
+    }
+
+    //Progress counts staging the object into the dataset, not storing it
+    File storedFile;
+    storedFile.srcFilePath = file.srcFilePath;
+    if ( !_store->createTempPath( object, storedFile.dstFilePath ) )
+    {
+      error = "Can't create " + _store->getFolder( ) + " folder.";
+      return false;
+    }
+    if ( !reflink( storedFile ) && !copy( storedFile, buffer, error, false ) )
+    {
+      std::remove( storedFile.dstFilePath.c_str( ) );
+      return false;
+    }
+    if ( !_store->commit( storedFile.dstFilePath, object ) )
+    {
+      error = "Can't store " + file.srcFilePath + " file.";
+      return false;
+    }
+    return true;
+  }
+
+  bool GeometryStager::symlink( const File& file ) const
+  {
+    //Relative, so the dataset and its sources can be moved together
+    QFileInfo srcInfo( QString::fromStdString( file.srcFilePath ) );
+    QFileInfo dstInfo( QString::fromStdString( file.dstFilePath ) );
+    std::string target = QDir::toNativeSeparators( QDir(
+      dstInfo.absolutePath( ) ).relativeFilePath(
+      srcInfo.absoluteFilePath( ) ) ).toStdString( );
+#ifdef _WIN32
+    //Needs developer mode or the symbolic link privilege
+    return CreateSymbolicLinkA( file.dstFilePath.c_str( ),
+      target.c_str( ), 0 ) != 0;
+#else
+    return ::symlink( target.c_str( ), file.dstFilePath.c_str( ) ) == 0;
+#endif
+  }
+
+  bool GeometryStager::hardLink( const File& file ) const
+  {
+#ifdef _WIN32
+    return CreateHardLinkA( file.dstFilePath.c_str( ),
+      file.srcFilePath.c_str( ), nullptr ) != 0;
+#else
+    return ::link( file.srcFilePath.c_str( ),
+      file.dstFilePath.c_str( ) ) == 0;
+#endif
+  }
+
+  bool GeometryStager::reflink( const File& file ) const
+  {
+#if defined( __linux__ ) && defined( FICLONE )
+    int srcDescriptor = ::open( file.srcFilePath.c_str( ), O_RDONLY );
+    if ( srcDescriptor < 0 )
+    {
+      return false;
+    }
+    int dstDescriptor = ::open( file.dstFilePath.c_str( ),
+      O_WRONLY | O_CREAT | O_EXCL, 0644 );
+    if ( dstDescriptor < 0 )
+    {
+      ::close( srcDescriptor );
+      return false;
+    }
+    bool result = ::ioctl( dstDescriptor, FICLONE, srcDescriptor ) == 0;
+    result = ( ::close( dstDescriptor ) == 0 ) && result;
+    ::close( srcDescriptor );
+    if ( !result )
+    {
+      std::remove( file.dstFilePath.c_str( ) );
+    }
+    return result;
+#else
+    ( void ) file;
+    return false;
+#endif
+  }
+
+  bool GeometryStager::copy( const File& file, std::vector< char >& buffer,
+    std::string& error, const bool& addProgress ) const
+  {
+    std::FILE* srcFile = std::fopen( file.srcFilePath.c_str( ), "rb" );
+    if ( srcFile == nullptr )
+    {
+      error = "Can't copy " + file.srcFilePath + " file.";
+      return false;
+    }
+    std::FILE* dstFile = std::fopen( file.dstFilePath.c_str( ), "wb" );
+    if ( dstFile == nullptr )
+    {
+      std::fclose( srcFile );
+      error = "Can't create " + file.dstFilePath + " file.";
+      return false;
+    }
+
+    //Copied in chunks so a cancel request is served within one chunk
+    bool result = true;
+    bool copied = false;
+#ifdef VISHNU_COPY_FILE_RANGE
+    //Done by the kernel without going through user space. Files it can't
+    //copy fail on the first chunk and are copied through buffers instead
+    size_t kernelCopied = 0;
+    bool kernelCopy = true;
+    while ( result && kernelCopy )
+    {
+      ssize_t size = ::copy_file_range( fileno( srcFile ), nullptr,
+        fileno( dstFile ), nullptr, COPY_BUFFER_SIZE, 0 );
+      if ( size > 0 )
+      {
+        kernelCopied += static_cast< size_t >( size );
+        if ( _progress && addProgress )
+        {
+          _progress->addDone( static_cast< size_t >( size ) );
+        }
+        result = !isCanceled( );
+      }
+      else if ( size == 0 )
+      {
+        copied = true;
+        kernelCopy = false;
+      }
+      else if ( errno != EINTR )
+      {
+        if ( kernelCopied != 0 )
+        {
+          error = "Can't write " + file.dstFilePath + " file.";
+          result = false;
+        }
+        kernelCopy = false;
+      }
+    }
+#endif
+
+    if ( result && !copied )
+    {
+      buffer.resize( COPY_BUFFER_SIZE );
+      size_t size;
+      while ( result && ( size = std::fread( buffer.data( ), 1,
+        buffer.size( ), srcFile ) ) > 0 )
+      {
+        if ( std::fwrite( buffer.data( ), 1, size, dstFile ) != size )
+        {
+          error = "Can't write " + file.dstFilePath + " file.";
+          result = false;
+          break;
+        }
+        if ( _progress && addProgress )
+        {
+          _progress->addDone( size );
+        }
+        result = !isCanceled( );
+      }
+      if ( result && std::ferror( srcFile ) )
+      {
+        error = "Can't read " + file.srcFilePath + " file.";
+        result = false;
+      }
+    }
+
+    std::fclose( srcFile );
+    if ( std::fclose( dstFile ) != 0 && result )
+    {
+      error = "Can't write " + file.dstFilePath + " file.";
+      result = false;
+    }
+    if ( result && _progress && addProgress )
+    {
+      _progress->addFiles( 1 );
+    }
+    return result;
+  }
+
+  void GeometryStager::addLinked( const File& file ) const
+  {
+    if ( _progress )
+    {
+      FileFingerprint fingerprint;
+      FileFingerprint::stat( file.srcFilePath, fingerprint );
+      _progress->addDone( static_cast< size_t >( fingerprint.size ) );
+      _progress->addFiles( 1 );
+    }
+  }
+
+}
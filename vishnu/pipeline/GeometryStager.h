@@ -0,0 +1,131 @@
+/*
+ * Vishnu
+ * Copyright (c) 2017-2019 GMRV/URJC.
+ *
+ * Authors: Gonzalo Bayo Martinez <gonzalo.bayo@urjc.es>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef VISHNU_GEOMETRYSTAGER_H
+#define VISHNU_GEOMETRYSTAGER_H
+
+#include <array>
+#include <string>
+#include <vector>
+#include <memory>
+
+#include "BuildProgress.h"
+#include "GeometryStore.h"
+
+namespace vishnu
+{
+
+  class GeometryStager;
+  using GeometryStagerPtr = std::shared_ptr< GeometryStager >;
+
+  /*
+   * Places the geometric data files of a dataset. Besides copying them,
+   * files can be hard linked, reflinked (sharing their blocks on
+   * filesystems with copy on write, like Btrfs or XFS) or symlinked with a
+   * relative path, so that no data is duplicated. A mode that isn't
+   * possible for a file, e.g. a hard link across filesystems, falls back to
+   * the next one: symlinks to hard links, hard links to reflinks and
+   * reflinks to copies.
+   *
+   * Files are staged by a bounded pool of workers, so that many small files
+   * keep the device busy instead of waiting on each other. Copies are done
+   * by the kernel where possible (copy_file_range on Linux), or through
+   * large buffers otherwise.
+   *
+   * With a store, every file is first added to it, unless an identical one
+   * is already there, and then staged from the stored object, which is
+   * shared between datasets. As the store already holds a copy, the copy
+   * mode reflinks, hard links or symlinks the object instead, in that
+   * order, and only copies it when none of them is possible.
+   */
+  class GeometryStager
+  {
+
+    public:
+
+      enum class Mode
+      {
+        Copy,
+        HardLink,
+        Reflink,
+        Symlink
+      };
+
+      struct File
+      {
+        std::string srcFilePath;
+        std::string dstFilePath;
+      };
+      using Files = std::vector< File >;
+
+      //A workers value of 0 uses GEOMETRY_STAGING_WORKERS
+      explicit GeometryStager( const Mode& mode = Mode::Copy,
+        const size_t& workers = 0 );
+
+      Mode getMode( void ) const;
+
+      //Destinations must not exist, but their folders must. Copied bytes,
+      //or the whole size of linked files, and staged files are added to
+      //progress. Staging stops at the first error or when progress is
+      //canceled
+      bool stage( const Files& files );
+
+      //Files staged with a mode, after falling back, in the last stage
+      size_t getStagedFiles( const Mode& mode ) const;
+
+      //Stored object of every file of the last stage, in the same order.
+      //Empty without a store
+      std::vector< std::string > getObjects( void ) const;
+
+      std::string getError( void ) const;
+
+      void setProgress( const BuildProgressPtr& progress );
+
+      void setStore( const GeometryStorePtr& store );
+
+      static Mode toMode( const std::string& mode );
+      static std::string toString( const Mode& mode );
+
+    private:
+
+      Mode _mode;
+      size_t _workers;
+      std::string _error;
+      BuildProgressPtr _progress;
+      std::array< size_t, 4 > _stagedFiles;
+      GeometryStorePtr _store;
+      std::vector< std::string > _objects;
+
+      bool isCanceled( void ) const;
+      bool stageFile( const File& file, std::vector< char >& buffer,
+        Mode& usedMode, std::string& object, std::string& error ) const;
+      bool storeFile( const File& file, std::vector< char >& buffer,
+        std::string& object, std::string& error ) const;
+      bool symlink( const File& file ) const;
+      bool hardLink( const File& file ) const;
+      bool reflink( const File& file ) const;
+      bool copy( const File& file, std::vector< char >& buffer,
+        std::string& error, const bool& addProgress = true ) const;
+      void addLinked( const File& file ) const;
+  };
+
+}
+
+#endif
@@ -0,0 +1,137 @@
+/*
+ * Vishnu
+ * Copyright (c) 2017-2019 GMRV/URJC.
+ *
+ * Authors: Gonzalo Bayo Martinez <gonzalo.bayo@urjc.es>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "GeometryStore.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+
+#include <QCryptographicHash>
+#include <QDir>
+
+#ifndef _WIN32
+  #include <unistd.h>
+#endif
+
+#include "FileFingerprint.h"
+#include "../Definitions.hpp"
+
+namespace vishnu
+{
+
+  GeometryStore::GeometryStore( const std::string& folder )
+    : _folder( folder )
+  {
+    while ( !_folder.empty( ) && ( _folder.back( ) == '/'
+      || _folder.back( ) == '\\' ) )
+    {
+      _folder.pop_back( );
+    }
+  }
+
+  std::string GeometryStore::getFolder( void ) const
+  {
+    return _folder;
+  }
+
+  bool GeometryStore::hash( const std::string& filePath,
+    std::vector< char >& buffer, std::string& object ) const
+  {
+    std::FILE* file = std::fopen( filePath.c_str( ), "rb" );
+    if ( file == nullptr )
+    {
+      return false;
+    }
+
+    //SHA-256, so different contents never share an object in practice
+    QCryptographicHash sha256( QCryptographicHash::Sha256 );
+    buffer.resize( COPY_BUFFER_SIZE );
+    uint64_t total = 0;
+    size_t size;
+    while ( ( size = std::fread( buffer.data( ), 1, buffer.size( ),
+      file ) ) > 0 )
+    {
+      sha256.addData( buffer.data( ), static_cast< int >( size ) );
+      total += size;
+    }
+    bool result = !std::ferror( file );
+    std::fclose( file );
+    if ( !result )
+    {
+      return false;
+    }
+
+    object = sha256.result( ).toHex( ).toStdString( ) + std::string( "-" )
+      + std::to_string( total );
+    return true;
+  }
+
+  bool GeometryStore::contains( const std::string& object ) const
+  {
+    FileFingerprint fingerprint;
+    return FileFingerprint::stat( getObjectPath( object ), fingerprint );
+  }
+
+  std::string GeometryStore::getObjectPath( const std::string& object ) const
+  {
+    return _folder + std::string( "/" ) + object.substr( 0, 2 )
+      + std::string( "/" ) + object;
+  }
+
+  bool GeometryStore::createTempPath( const std::string& object,
+    std::string& tempPath ) const
+  {
+    std::string subfolder = _folder + std::string( "/" )
+      + object.substr( 0, 2 );
+    if ( !QDir( ).mkpath( QString::fromStdString( subfolder ) ) )
+    {
+      return false;
+    }
+    static std::atomic< size_t > tempCounter( 0 );
+    tempPath = getObjectPath( object ) + std::string( "." )
+      + std::to_string( std::chrono::steady_clock::now( )
+        .time_since_epoch( ).count( ) )
+      + std::string( "-" ) + std::to_string( tempCounter++ )
+      + std::string( ".tmp" );
+    return true;
+  }
+
+  bool GeometryStore::commit( const std::string& tempPath,
+    const std::string& object ) const
+  {
+    std::string objectPath = getObjectPath( object );
+#ifdef _WIN32
+    //Renaming never replaces an existing file on Windows
+    bool result = std::rename( tempPath.c_str( ), objectPath.c_str( ) ) == 0
+      || contains( object );
+#else
+    //Linked rather than renamed, so that an existing object isn't replaced
+    //and the dataset files linked to it stay shared. Renamed where there
+    //are no hard links
+    bool result = ::link( tempPath.c_str( ), objectPath.c_str( ) ) == 0
+      || contains( object )
+      || std::rename( tempPath.c_str( ), objectPath.c_str( ) ) == 0;
+#endif
+    std::remove( tempPath.c_str( ) );
+    return result;
+  }
+
+}
@@ -0,0 +1,77 @@
+/*
+ * Vishnu
+ * Copyright (c) 2017-2019 GMRV/URJC.
+ *
+ * Authors: Gonzalo Bayo Martinez <gonzalo.bayo@urjc.es>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef VISHNU_GEOMETRYSTORE_H
+#define VISHNU_GEOMETRYSTORE_H
+
+#include <string>
+#include <vector>
+#include <memory>
+
+namespace vishnu
+{
+
+  class GeometryStore;
+  using GeometryStorePtr = std::shared_ptr< GeometryStore >;
+
+  /*
+   * Content addressed store of geometry files shared by every dataset
+   * (USER_DATA_FOLDER/GEOMETRY_STORE_FOLDER). An object is named after the
+   * SHA-256 hash and the size of its content, so identical meshes are kept
+   * once whatever their names, and datasets link to them.
+   *
+   * Objects live in subfolders named after their first two hex digits.
+   * They are written to a temporary file in the same subfolder and then
+   * moved into place, so a concurrent build never sees half an object.
+   */
+  class GeometryStore
+  {
+
+    public:
+
+      explicit GeometryStore( const std::string& folder );
+
+      std::string getFolder( void ) const;
+
+      //Object name of a file content. Reads the whole file through buffer
+      bool hash( const std::string& filePath, std::vector< char >& buffer,
+        std::string& object ) const;
+
+      bool contains( const std::string& object ) const;
+
+      std::string getObjectPath( const std::string& object ) const;
+
+      //Unique on every call, next to the object. Creates its subfolder
+      bool createTempPath( const std::string& object,
+        std::string& tempPath ) const;
+
+      //Moves a temporary file into place. An object stored meanwhile by
+      //someone else is kept, as it has the same content
+      bool commit( const std::string& tempPath,
+        const std::string& object ) const;
+
+    private:
+
+      std::string _folder;
+  };
+
+}
+
+#endif
@@ -0,0 +1,163 @@
+/*
+ * Vishnu
+ * Copyright (c) 2017-2019 GMRV/URJC.
+ *
+ * Authors: Gonzalo Bayo Martinez <gonzalo.bayo@urjc.es>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "MappedFile.h"
+
+#ifdef _WIN32
+  #ifndef NOMINMAX
+    #define NOMINMAX
+  #endif
+  #include <windows.h>
+#else
+  #include <fcntl.h>
+  #include <sys/mman.h>
+  #include <sys/stat.h>
+  #include <unistd.h>
+#endif
+
+namespace vishnu
+{
+
+#ifdef _WIN32
+
+  MappedFile::MappedFile( const std::string& path )
+    : _data( nullptr )
+    , _size( 0 )
+    , _open( false )
+    , _file( INVALID_HANDLE_VALUE )
+    , _mapping( nullptr )
+  {
+    _file = CreateFileA( path.c_str( ), GENERIC_READ, FILE_SHARE_READ,
+      nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr );
+    if ( _file == INVALID_HANDLE_VALUE )
+    {
+      return;
+    }
+
+    LARGE_INTEGER size;
+    if ( !GetFileSizeEx( _file, &size ) )
+    {
+      return;
+    }
+    _size = static_cast< size_t >( size.QuadPart );
+
+    //Empty files can't be mapped
+    if ( _size == 0 )
+    {
+      _open = true;
+      return;
+    }
+
+    _mapping = CreateFileMappingA( _file, nullptr, PAGE_READONLY, 0, 0,
+      nullptr );
+    if ( _mapping == nullptr )
+    {
+      return;
+    }
+    _data = static_cast< const char* >(
+      MapViewOfFile( _mapping, FILE_MAP_READ, 0, 0, 0 ) );
+    _open = ( _data != nullptr );
+  }
+
+  MappedFile::~MappedFile( void )
+  {
+    if ( _data != nullptr )
+    {
+      UnmapViewOfFile( _data );
+    }
+    if ( _mapping != nullptr )
+    {
+      CloseHandle( _mapping );
+    }
+    if ( _file != INVALID_HANDLE_VALUE )
+    {
+      CloseHandle( _file );
+    }
+  }
+
+#else
+
+  MappedFile::MappedFile( const std::string& path )
+    : _data( nullptr )
+    , _size( 0 )
+    , _open( false )
+    , _descriptor( -1 )
+  {
+    _descriptor = ::open( path.c_str( ), O_RDONLY );
+    if ( _descriptor == -1 )
+    {
+      return;
+    }
+
+    struct stat status;
+    if ( ::fstat( _descriptor, &status ) == -1 )
+    {
+      return;
+    }
+    _size = static_cast< size_t >( status.st_size );
+
+    //Empty files can't be mapped
+    if ( _size == 0 )
+    {
+      _open = true;
+      return;
+    }
+
+    void* data = ::mmap( nullptr, _size, PROT_READ, MAP_PRIVATE,
+      _descriptor, 0 );
+    if ( data == MAP_FAILED )
+    {
+      return;
+    }
+    ::madvise( data, _size, MADV_SEQUENTIAL );
+    _data = static_cast< const char* >( data );
+    _open = true;
+  }
+
+  MappedFile::~MappedFile( void )
+  {
+    if ( _data != nullptr )
+    {
+      ::munmap( const_cast< char* >( _data ), _size );
+    }
+    if ( _descriptor != -1 )
+    {
+      ::close( _descriptor );
+    }
+  }
+
+#endif
+
+  bool MappedFile::isOpen( void ) const
+  {
+    return _open;
+  }
+
+  const char* MappedFile::getData( void ) const
+  {
+    return _data;
+  }
+
+  size_t MappedFile::getSize( void ) const
+  {
+    return _size;
+  }
+
+}
@@ -0,0 +1,67 @@
+/*
+ * Vishnu
+ * Copyright (c) 2017-2019 GMRV/URJC.
+ *
+ * Authors: Gonzalo Bayo Martinez <gonzalo.bayo@urjc.es>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef VISHNU_MAPPEDFILE_H
+#define VISHNU_MAPPEDFILE_H
+
+#include <string>
+#include <memory>
+
+namespace vishnu
+{
+
+  class MappedFile;
+  using MappedFilePtr = std::shared_ptr< MappedFile >;
+
+  /*
+   * Read only memory mapping of a whole file.
+   */
+  class MappedFile
+  {
+
+    public:
+
+      explicit MappedFile( const std::string& path );
+      ~MappedFile( void );
+
+      MappedFile( const MappedFile& ) = delete;
+      MappedFile& operator=( const MappedFile& ) = delete;
+
+      bool isOpen( void ) const;
+
+      const char* getData( void ) const;
+      size_t getSize( void ) const;
+
+    private:
+
+      const char* _data;
+      size_t _size;
+      bool _open;
+#ifdef _WIN32
+      void* _file;
+      void* _mapping;
+#else
+      int _descriptor;
+#endif
+  };
+
+}
+
+#endif
@@ -0,0 +1,157 @@
+/*
+ * Vishnu
+ * Copyright (c) 2017-2019 GMRV/URJC.
+ *
+ * Authors: Gonzalo Bayo Martinez <gonzalo.bayo@urjc.es>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "NullBitmapWriter.h"
+
+#include <algorithm>
+
+#include "BinaryIO.h"
+#include "../Definitions.hpp"
+
+namespace vishnu
+{
+
+  NullBitmapWriter::NullBitmapWriter( const std::string& path,
+    const size_t& columns )
+    : _path( path )
+    , _file( path, std::ios::binary | std::ios::trunc )
+    , _columns( columns )
+    , _rows( 0 )
+    , _blockRows( 0 )
+    , _block( columns, std::vector< uint8_t >( NULL_BITMAP_BLOCK_ROWS / 8 ) )
+  {
+    if ( !_file.is_open( ) )
+    {
+      _error = "Can't create " + _path + " file.";
+      return;
+    }
+
+    //Row count is written by close( )
+    _file.write( NULL_BITMAP_MAGIC, 8 );
+    writeUInt32( _file, NULL_BITMAP_VERSION );
+    writeUInt32( _file, static_cast< uint32_t >( _columns ) );
+    writeUInt32( _file, NULL_BITMAP_BLOCK_ROWS );
+    writeUInt32( _file, 0 );
+    writeUInt64( _file, 0 );
+  }
+
+  NullBitmapWriter::~NullBitmapWriter( void )
+  {
+    if ( _file.is_open( ) )
+    {
+      close( );
+    }
+  }
+
+  void NullBitmapWriter::addRows( const size_t& rows,
+    const std::vector< uint8_t >& nulls )
+  {
+    if ( !_error.empty( ) )
+    {
+      return;
+    }
+    size_t index = 0;
+    for ( size_t row = 0; row < rows; ++row )
+    {
+      for ( size_t col = 0; col < _columns; ++col, ++index )
+      {
+        if ( isNull( nulls, index ) )
+        {
+          _block[ col ][ _blockRows / 8 ] |=
+            static_cast< uint8_t >( 1u << ( _blockRows % 8 ) );
+        }
+      }
+      ++_rows;
+      if ( ++_blockRows == NULL_BITMAP_BLOCK_ROWS )
+      {
+        writeBlock( );
+      }
+    }
+  }
+
+  bool NullBitmapWriter::close( void )
+  {
+    if ( !_file.is_open( ) )
+    {
+      return _error.empty( );
+    }
+    if ( _blockRows > 0 )
+    {
+      writeBlock( );
+    }
+    _file.seekp( NULL_BITMAP_HEADER_SIZE - 8 );
+    writeUInt64( _file, _rows );
+    _file.close( );
+    if ( _file.fail( ) && _error.empty( ) )
+    {
+      _error = "Can't write " + _path + " file.";
+    }
+    return _error.empty( );
+  }
+
+  bool NullBitmapWriter::hasError( void ) const
+  {
+    return !_error.empty( );
+  }
+
+  std::string NullBitmapWriter::getError( void ) const
+  {
+    return _error;
+  }
+
+  std::string NullBitmapWriter::getPath( void ) const
+  {
+    return _path;
+  }
+
+  void NullBitmapWriter::setNull( std::vector< uint8_t >& nulls,
+    const size_t& index )
+  {
+    if ( index / 8 >= nulls.size( ) )
+    {
+      nulls.resize( index / 8 + 1, 0 );
+    }
+    nulls[ index / 8 ] |= static_cast< uint8_t >( 1u << ( index % 8 ) );
+  }
+
+  bool NullBitmapWriter::isNull( const std::vector< uint8_t >& nulls,
+    const size_t& index )
+  {
+    return index / 8 < nulls.size( )
+      && ( ( nulls[ index / 8 ] >> ( index % 8 ) ) & 1 );
+  }
+
+  void NullBitmapWriter::writeBlock( void )
+  {
+    //The last block only stores its rows
+    size_t size = ( _blockRows + 7 ) / 8;
+    for ( auto& bitmap : _block )
+    {
+      _file.write( reinterpret_cast< const char* >( bitmap.data( ) ), size );
+      std::fill( bitmap.begin( ), bitmap.end( ), 0 );
+    }
+    if ( !_file && _error.empty( ) )
+    {
+      _error = "Can't write " + _path + " file.";
+    }
+    _blockRows = 0;
+  }
+
+}
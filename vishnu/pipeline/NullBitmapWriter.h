@@ -0,0 +1,86 @@
+/*
+ * Vishnu
+ * Copyright (c) 2017-2019 GMRV/URJC.
+ *
+ * Authors: Gonzalo Bayo Martinez <gonzalo.bayo@urjc.es>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef VISHNU_NULLBITMAPWRITER_H
+#define VISHNU_NULLBITMAPWRITER_H
+
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <memory>
+
+namespace vishnu
+{
+
+  class NullBitmapWriter;
+  using NullBitmapWriterPtr = std::shared_ptr< NullBitmapWriter >;
+
+  /*
+   * Sidecar of a sparse CSV result, telling missing fields (written empty)
+   * from empty values. After a NULL_BITMAP_HEADER_SIZE bytes header (magic,
+   * version, columns, rows per block and rows) rows are stored in blocks of
+   * NULL_BITMAP_BLOCK_ROWS. Every block holds one bitmap per column, one bit
+   * per row of the block (least significant bit first, set if missing), so
+   * the bits of a column are found without reading the other columns.
+   */
+  class NullBitmapWriter
+  {
+
+    public:
+
+      NullBitmapWriter( const std::string& path, const size_t& columns );
+      ~NullBitmapWriter( void );
+
+      NullBitmapWriter( const NullBitmapWriter& ) = delete;
+      NullBitmapWriter& operator=( const NullBitmapWriter& ) = delete;
+
+      //Appends rows given as a row major bitmap, columns bits per row
+      void addRows( const size_t& rows, const std::vector< uint8_t >& nulls );
+
+      //Writes the pending block and the row count and closes the file
+      bool close( void );
+
+      bool hasError( void ) const;
+      std::string getError( void ) const;
+
+      std::string getPath( void ) const;
+
+      //Sets bit index of a row major bitmap, growing it as needed
+      static void setNull( std::vector< uint8_t >& nulls, const size_t& index );
+      static bool isNull( const std::vector< uint8_t >& nulls,
+        const size_t& index );
+
+    private:
+
+      std::string _path;
+      std::ofstream _file;
+      size_t _columns;
+      uint64_t _rows;
+      size_t _blockRows;
+      std::vector< std::vector< uint8_t > > _block;
+      std::string _error;
+
+      void writeBlock( void );
+  };
+
+}
+
+#endif
@@ -0,0 +1,116 @@
+/*
+ * Vishnu
+ * Copyright (c) 2017-2019 GMRV/URJC.
+ *
+ * Authors: Gonzalo Bayo Martinez <gonzalo.bayo@urjc.es>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef VISHNU_NUMBERFORMAT_H
+#define VISHNU_NUMBERFORMAT_H
+
+#include <cstdlib>
+#include <cstring>
+#include <string>
+
+#include <locale.h>
+#ifdef __APPLE__
+  #include <xlocale.h>
+#endif
+
+#include "StringView.h"
+
+namespace vishnu
+{
+
+  //strtod over a terminated number with the "C" locale, so the decimal
+  //point is always '.' whatever LC_NUMERIC the application set (Qt sets
+  //the user locale on Unix)
+  inline double parseCNumber( const char* text )
+  {
+#ifdef _WIN32
+    static const _locale_t cLocale = _create_locale( LC_NUMERIC, "C" );
+    return _strtod_l( text, nullptr, cLocale );
+#else
+    static const locale_t cLocale = newlocale( LC_NUMERIC_MASK, "C",
+      static_cast< locale_t >( 0 ) );
+    return strtod_l( text, nullptr, cLocale );
+#endif
+  }
+
+  //Decimal notation with optional exponent, like 1.5, -.5, 2e-3. The value
+  //is only stored for valid numbers, read the same under any locale
+  inline bool parseNumber( const StringView& field, double& value )
+  {
+    const char* current = field.data;
+    const char* end = field.data + field.size;
+    size_t digits = 0;
+    if ( current < end && ( *current == '-' || *current == '+' ) )
+    {
+      ++current;
+    }
+    for ( ; current < end && *current >= '0' && *current <= '9'; ++current )
+    {
+      ++digits;
+    }
+    if ( current < end && *current == '.' )
+    {
+      for ( ++current; current < end && *current >= '0' && *current <= '9';
+        ++current )
+      {
+        ++digits;
+      }
+    }
+    if ( digits == 0 )
+    {
+      return false;
+    }
+    if ( current < end && ( *current == 'e' || *current == 'E' ) )
+    {
+      ++current;
+      if ( current < end && ( *current == '-' || *current == '+' ) )
+      {
+        ++current;
+      }
+      const char* exponent = current;
+      for ( ; current < end && *current >= '0' && *current <= '9'; ++current );
+      if ( current == exponent )
+      {
+        return false;
+      }
+    }
+    if ( current != end )
+    {
+      return false;
+    }
+
+    //Parsing needs a terminated copy, kept on the stack for usual numbers
+    char buffer[ 64 ];
+    if ( field.size < sizeof( buffer ) )
+    {
+      std::memcpy( buffer, field.data, field.size );
+      buffer[ field.size ] = '\0';
+      value = parseCNumber( buffer );
+    }
+    else
+    {
+      value = parseCNumber( field.str( ).c_str( ) );
+    }
+    return true;
+  }
+
+}
+
+#endif
@@ -0,0 +1,69 @@
+/*
+ * Vishnu
+ * Copyright (c) 2017-2019 GMRV/URJC.
+ *
+ * Authors: Gonzalo Bayo Martinez <gonzalo.bayo@urjc.es>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef VISHNU_RECORDREADER_H
+#define VISHNU_RECORDREADER_H
+
+#include <string>
+#include <vector>
+#include <memory>
+
+#include "StringView.h"
+
+namespace vishnu
+{
+
+  class RecordReader;
+  using RecordReaderPtr = std::shared_ptr< RecordReader >;
+
+  /*
+   * Sequential access to the records of a source dataset.
+   */
+  class RecordReader
+  {
+
+    public:
+
+      virtual ~RecordReader( void )
+      {
+
+      }
+
+      virtual bool isOpen( void ) const = 0;
+
+      //Reads first record with trimmed fields
+      virtual bool readHeaders( std::vector< std::string >& headers ) = 0;
+
+      //Restricts next records to the given source columns, in that order.
+      //Columns set to -1 or not present in a record get missingValue
+      virtual void setProjection( const std::vector< int >& columns,
+        const std::string& missingValue ) = 0;
+
+      //Reads next record. Views are valid until the next read
+      virtual bool readRecord( std::vector< StringView >& fields ) = 0;
+
+      //Progress over the source, in bytes
+      virtual size_t getPosition( void ) const = 0;
+      virtual size_t getSize( void ) const = 0;
+  };
+
+}
+
+#endif
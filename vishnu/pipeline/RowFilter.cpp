@@ -0,0 +1,455 @@
+/*
+ * Vishnu
+ * Copyright (c) 2017-2019 GMRV/URJC.
+ *
+ * Authors: Gonzalo Bayo Martinez <gonzalo.bayo@urjc.es>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "RowFilter.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+
+#include "NumberFormat.h"
+#include "../Definitions.hpp"
+
+namespace vishnu
+{
+
+  namespace
+  {
+    const StringView MISSING_FIELD( MISSING_DATA_FIELD,
+      sizeof( MISSING_DATA_FIELD ) - 1 );
+
+    //Characters that end an unquoted word
+    bool isDelimiter( const char& c )
+    {
+      return std::isspace( static_cast< unsigned char >( c ) ) || c == '('
+        || c == ')' || c == ',' || c == '<' || c == '>' || c == '='
+        || c == '!' || c == '"';
+    }
+
+    bool isLess( const std::string& value, const StringView& field )
+    {
+      int comparison = std::memcmp( value.data( ), field.data,
+        std::min( value.size( ), field.size ) );
+      return comparison < 0
+        || ( comparison == 0 && value.size( ) < field.size );
+    }
+  }
+
+  RowFilter::RowFilter( void )
+    : _root( 0 )
+    , _token( 0 )
+    , _headers( nullptr )
+  {
+
+  }
+
+  RowFilter::~RowFilter( void )
+  {
+
+  }
+
+  bool RowFilter::parse( const std::string& expression,
+    const std::vector< std::string >& headers )
+  {
+    _nodes.clear( );
+    _error.clear( );
+    _token = 0;
+    _headers = &headers;
+    bool result = tokenize( expression );
+    if ( result && _tokens.empty( ) )
+    {
+      _error = "Empty expression.";
+      result = false;
+    }
+    result = result && parseOr( _root );
+    if ( result && _token < _tokens.size( ) )
+    {
+      _error = "Unexpected " + _tokens[ _token ].text + ".";
+      result = false;
+    }
+    _tokens.clear( );
+    _headers = nullptr;
+    if ( !result )
+    {
+      _nodes.clear( );
+    }
+    return result;
+  }
+
+  bool RowFilter::accept( const std::vector< StringView >& fields ) const
+  {
+    return _nodes.empty( ) || evaluate( _root, fields );
+  }
+
+  std::string RowFilter::getError( void ) const
+  {
+    return _error;
+  }
+
+  bool RowFilter::tokenize( const std::string& expression )
+  {
+    _tokens.clear( );
+    size_t i = 0;
+    while ( i < expression.size( ) )
+    {
+      char c = expression[ i ];
+      if ( std::isspace( static_cast< unsigned char >( c ) ) )
+      {
+        ++i;
+        continue;
+      }
+
+      Token token;
+      token.quoted = false;
+      if ( c == '"' )
+      {
+        //Quotes inside are doubled, as in CSV files
+        token.quoted = true;
+        bool closed = false;
+        for ( ++i; i < expression.size( ) && !closed; ++i )
+        {
+          if ( expression[ i ] != '"' )
+          {
+            token.text += expression[ i ];
+          }
+          else if ( i + 1 < expression.size( ) && expression[ i + 1 ] == '"' )
+          {
+            token.text += '"';
+            ++i;
+          }
+          else
+          {
+            closed = true;
+          }
+        }
+        if ( !closed )
+        {
+          _error = "Unterminated quoted text.";
+          return false;
+        }
+      }
+      else if ( c == '(' || c == ')' || c == ',' )
+      {
+        token.text = c;
+        ++i;
+      }
+      else if ( c == '<' || c == '>' || c == '=' || c == '!' )
+      {
+        token.text = c;
+        ++i;
+        if ( i < expression.size( ) && expression[ i ] == '=' )
+        {
+          token.text += '=';
+          ++i;
+        }
+        if ( token.text == "!" )
+        {
+          _error = "Unexpected !.";
+          return false;
+        }
+      }
+      else
+      {
+        size_t begin = i;
+        while ( i < expression.size( ) && !isDelimiter( expression[ i ] ) )
+        {
+          ++i;
+        }
+        token.text = expression.substr( begin, i - begin );
+      }
+      _tokens.emplace_back( token );
+    }
+    return true;
+  }
+
+  bool RowFilter::isKeyword( const char* keyword ) const
+  {
+    if ( _token >= _tokens.size( ) || _tokens[ _token ].quoted )
+    {
+      return false;
+    }
+    const std::string& text = _tokens[ _token ].text;
+    if ( text.size( ) != std::strlen( keyword ) )
+    {
+      return false;
+    }
+    for ( size_t i = 0; i < text.size( ); ++i )
+    {
+      if ( std::toupper( static_cast< unsigned char >( text[ i ] ) )
+        != keyword[ i ] )
+      {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  bool RowFilter::isSymbol( const char* symbol ) const
+  {
+    return _token < _tokens.size( ) && !_tokens[ _token ].quoted
+      && _tokens[ _token ].text == symbol;
+  }
+
+  bool RowFilter::parseOr( size_t& node )
+  {
+    if ( !parseAnd( node ) )
+    {
+      return false;
+    }
+    while ( isKeyword( "OR" ) )
+    {
+      ++_token;
+      size_t right;
+      if ( !parseAnd( right ) )
+      {
+        return false;
+      }
+      Node orNode;
+      orNode.type = NodeType::Or;
+      orNode.left = node;
+      orNode.right = right;
+      _nodes.emplace_back( orNode );
+      node = _nodes.size( ) - 1;
+    }
+    return true;
+  }
+
+  bool RowFilter::parseAnd( size_t& node )
+  {
+    if ( !parseTerm( node ) )
+    {
+      return false;
+    }
+    while ( isKeyword( "AND" ) )
+    {
+      ++_token;
+      size_t right;
+      if ( !parseTerm( right ) )
+      {
+        return false;
+      }
+      Node andNode;
+      andNode.type = NodeType::And;
+      andNode.left = node;
+      andNode.right = right;
+      _nodes.emplace_back( andNode );
+      node = _nodes.size( ) - 1;
+    }
+    return true;
+  }
+
+  bool RowFilter::parseTerm( size_t& node )
+  {
+    if ( _token >= _tokens.size( ) )
+    {
+      _error = "Unexpected end of expression.";
+      return false;
+    }
+    if ( isSymbol( "(" ) )
+    {
+      ++_token;
+      if ( !parseOr( node ) )
+      {
+        return false;
+      }
+      if ( !isSymbol( ")" ) )
+      {
+        _error = "Missing ).";
+        return false;
+      }
+      ++_token;
+      return true;
+    }
+
+    //Column
+    const Token& columnToken = _tokens[ _token++ ];
+    auto header = std::find( _headers->begin( ), _headers->end( ),
+      columnToken.text );
+    if ( header == _headers->end( ) )
+    {
+      _error = "Unknown column " + columnToken.text + ".";
+      return false;
+    }
+    Node term;
+    term.column = static_cast< size_t >( header - _headers->begin( ) );
+
+    //Set membership
+    if ( isKeyword( "NOT" ) || isKeyword( "IN" ) )
+    {
+      term.type = NodeType::In;
+      if ( isKeyword( "NOT" ) )
+      {
+        term.type = NodeType::NotIn;
+        ++_token;
+        if ( !isKeyword( "IN" ) )
+        {
+          _error = "Expected IN after NOT.";
+          return false;
+        }
+      }
+      ++_token;
+      if ( !parseList( term ) )
+      {
+        return false;
+      }
+      _nodes.emplace_back( term );
+      node = _nodes.size( ) - 1;
+      return true;
+    }
+
+    //Comparison
+    const char* symbols[ ] = { "<", "<=", ">", ">=", "=", "!=" };
+    const Operator operators[ ] = { Operator::Less, Operator::LessEqual,
+      Operator::Greater, Operator::GreaterEqual, Operator::Equal,
+      Operator::NotEqual };
+    bool found = false;
+    term.type = NodeType::Compare;
+    for ( size_t i = 0; i < 6 && !found; ++i )
+    {
+      if ( isSymbol( symbols[ i ] )
+        || ( operators[ i ] == Operator::Equal && isSymbol( "==" ) ) )
+      {
+        term.op = operators[ i ];
+        found = true;
+      }
+    }
+    if ( !found )
+    {
+      _error = "Expected a comparison or IN after " + columnToken.text + ".";
+      return false;
+    }
+    ++_token;
+    if ( _token >= _tokens.size( ) || ( !_tokens[ _token ].quoted
+      && isDelimiter( _tokens[ _token ].text[ 0 ] ) ) )
+    {
+      _error = "Expected a value after " + columnToken.text + ".";
+      return false;
+    }
+    const Token& valueToken = _tokens[ _token++ ];
+    term.text = valueToken.text;
+    term.numeric = !valueToken.quoted
+      && parseNumber( StringView( valueToken.text ), term.number );
+    if ( !term.numeric && term.op != Operator::Equal
+      && term.op != Operator::NotEqual )
+    {
+      _error = "Expected a number after " + columnToken.text + ".";
+      return false;
+    }
+    _nodes.emplace_back( term );
+    node = _nodes.size( ) - 1;
+    return true;
+  }
+
+  bool RowFilter::parseList( Node& node )
+  {
+    if ( !isSymbol( "(" ) )
+    {
+      _error = "Expected ( after IN.";
+      return false;
+    }
+    ++_token;
+    while ( true )
+    {
+      if ( _token >= _tokens.size( ) || ( !_tokens[ _token ].quoted
+        && isDelimiter( _tokens[ _token ].text[ 0 ] ) ) )
+      {
+        _error = "Expected a value in IN list.";
+        return false;
+      }
+      node.values.emplace_back( _tokens[ _token++ ].text );
+      if ( isSymbol( ")" ) )
+      {
+        ++_token;
+        break;
+      }
+      if ( !isSymbol( "," ) )
+      {
+        _error = "Expected , or ) in IN list.";
+        return false;
+      }
+      ++_token;
+    }
+    std::sort( node.values.begin( ), node.values.end( ) );
+    return true;
+  }
+
+  bool RowFilter::evaluate( const size_t& node,
+    const std::vector< StringView >& fields ) const
+  {
+    const Node& current = _nodes[ node ];
+    switch ( current.type )
+    {
+      case NodeType::And:
+        return evaluate( current.left, fields )
+          && evaluate( current.right, fields );
+      case NodeType::Or:
+        return evaluate( current.left, fields )
+          || evaluate( current.right, fields );
+      default:
+        break;
+    }
+
+    if ( current.column >= fields.size( ) )
+    {
+      return false;
+    }
+    const StringView& field = fields[ current.column ];
+    if ( field == MISSING_FIELD )
+    {
+      return false;
+    }
+
+    if ( current.type != NodeType::Compare )
+    {
+      auto value = std::lower_bound( current.values.begin( ),
+        current.values.end( ), field, isLess );
+      bool found = value != current.values.end( )
+        && StringView( *value ) == field;
+      return found == ( current.type == NodeType::In );
+    }
+
+    if ( !current.numeric )
+    {
+      return ( field == StringView( current.text ) )
+        == ( current.op == Operator::Equal );
+    }
+    double number;
+    if ( !parseNumber( field, number ) )
+    {
+      return false;
+    }
+    switch ( current.op )
+    {
+      case Operator::Less:
+        return number < current.number;
+      case Operator::LessEqual:
+        return number <= current.number;
+      case Operator::Greater:
+        return number > current.number;
+      case Operator::GreaterEqual:
+        return number >= current.number;
+      case Operator::Equal:
+        return number == current.number;
+      default:
+        return number != current.number;
+    }
+  }
+
+}
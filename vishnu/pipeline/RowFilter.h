@@ -0,0 +1,129 @@
+/*
+ * Vishnu
+ * Copyright (c) 2017-2019 GMRV/URJC.
+ *
+ * Authors: Gonzalo Bayo Martinez <gonzalo.bayo@urjc.es>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef VISHNU_ROWFILTER_H
+#define VISHNU_ROWFILTER_H
+
+#include <string>
+#include <vector>
+#include <memory>
+
+#include "StringView.h"
+
+namespace vishnu
+{
+
+  class RowFilter;
+  using RowFilterPtr = std::shared_ptr< RowFilter >;
+
+  /*
+   * Predicate on merged rows, parsed from expressions like
+   *
+   *   volume >= 10 AND ( type IN ( spine, dendrite ) OR region != CA1 )
+   *
+   * Comparisons (<, <=, >, >=, =, ==, !=) against a number compare numbers,
+   * and fail for fields that are not one; = and != against text compare
+   * text. IN and NOT IN test membership in a list of values. AND binds
+   * tighter than OR, and keywords are case insensitive. Column names and
+   * values with spaces or symbols are double quoted. Missing fields never
+   * match.
+   */
+  class RowFilter
+  {
+
+    public:
+
+      RowFilter( void );
+      ~RowFilter( void );
+
+      //Columns are resolved against headers, in the order of the fields
+      //that will be accepted
+      bool parse( const std::string& expression,
+        const std::vector< std::string >& headers );
+
+      //Fields must be trimmed
+      bool accept( const std::vector< StringView >& fields ) const;
+
+      std::string getError( void ) const;
+
+    private:
+
+      enum class NodeType
+      {
+        And,
+        Or,
+        Compare,
+        In,
+        NotIn
+      };
+
+      enum class Operator
+      {
+        Less,
+        LessEqual,
+        Greater,
+        GreaterEqual,
+        Equal,
+        NotEqual
+      };
+
+      struct Node
+      {
+        NodeType type;
+        size_t left = 0;
+        size_t right = 0;
+        size_t column = 0;
+        Operator op = Operator::Equal;
+        bool numeric = false;
+        double number = 0.0;
+        std::string text;
+        //Sorted, searched without copying fields
+        std::vector< std::string > values;
+      };
+
+      struct Token
+      {
+        std::string text;
+        bool quoted;
+      };
+
+      std::vector< Node > _nodes;
+      size_t _root;
+      std::string _error;
+
+      //Parse state
+      std::vector< Token > _tokens;
+      size_t _token;
+      const std::vector< std::string >* _headers;
+
+      bool tokenize( const std::string& expression );
+      bool isKeyword( const char* keyword ) const;
+      bool isSymbol( const char* symbol ) const;
+      bool parseOr( size_t& node );
+      bool parseAnd( size_t& node );
+      bool parseTerm( size_t& node );
+      bool parseList( Node& node );
+      bool evaluate( const size_t& node,
+        const std::vector< StringView >& fields ) const;
+  };
+
+}
+
+#endif
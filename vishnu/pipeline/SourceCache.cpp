@@ -0,0 +1,470 @@
+/*
+ * Vishnu
+ * Copyright (c) 2017-2019 GMRV/URJC.
+ *
+ * Authors: Gonzalo Bayo Martinez <gonzalo.bayo@urjc.es>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "SourceCache.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <memory>
+#include <unordered_map>
+
+#include <QDir>
+#include <QFileInfo>
+
+#include "BinaryIO.h"
+#include "CacheReader.h"
+#include "CsvReader.h"
+#include "FileFingerprint.h"
+#include "../Definitions.hpp"
+
+namespace vishnu
+{
+
+  std::string SourceCache::getCachePath( const std::string& sourcePath,
+    const std::string& cacheFolder )
+  {
+    //Named after the source and a hash of its absolute path, so sources
+    //with the same name in different folders don't share a cache
+    QFileInfo sourceInfo( QString::fromStdString( sourcePath ) );
+    std::string absolutePath = sourceInfo.absoluteFilePath( ).toStdString( );
+    char hash[ 17 ];
+    std::snprintf( hash, sizeof( hash ), "%016llx",
+      static_cast< unsigned long long >( FileFingerprint::hash(
+        absolutePath.data( ), absolutePath.size( ) ) ) );
+    return cacheFolder + std::string( "/" )
+      + sourceInfo.fileName( ).toStdString( ) + std::string( "-" ) + hash
+      + std::string( "." ) + STR_EXT_CACHE;
+  }
+
+  RecordReaderPtr SourceCache::openCache( const std::string& sourcePath,
+    const std::string& cacheFolder )
+  {
+    std::string cachePath = getCachePath( sourcePath, cacheFolder );
+    FileFingerprint cacheFingerprint;
+    if ( !FileFingerprint::stat( cachePath, cacheFingerprint ) )
+    {
+      return RecordReaderPtr( );
+    }
+
+    std::shared_ptr< CacheReader > cacheReader( new CacheReader( cachePath ) );
+    FileFingerprint sourceFingerprint;
+    if ( !cacheReader->isOpen( )
+      || !FileFingerprint::compute( sourcePath, sourceFingerprint )
+      || sourceFingerprint != cacheReader->getSourceFingerprint( ) )
+    {
+      return RecordReaderPtr( );
+    }
+    return cacheReader;
+  }
+
+  bool SourceCache::build( const std::string& sourcePath,
+    const std::string& cacheFolder )
+  {
+    FileFingerprint sourceFingerprint;
+    if ( !FileFingerprint::compute( sourcePath, sourceFingerprint )
+      || !QDir( ).mkpath( QString::fromStdString( cacheFolder ) ) )
+    {
+      return false;
+    }
+
+    CsvReader reader( sourcePath );
+    std::vector< std::string > headers;
+    if ( !reader.isOpen( ) || !reader.readHeaders( headers )
+      || headers.size( ) > SOURCE_CACHE_MAX_COLUMNS )
+    {
+      return false;
+    }
+
+    //Columns are buffered in memory and spilled in chunks to a single
+    //temporary file, so a build holds a couple of descriptors whatever
+    //the number of columns. Temporary names are unique, so concurrent
+    //builds of the same source don't collide and the last rename wins
+    static std::atomic< size_t > buildCounter( 0 );
+    std::string cachePath = getCachePath( sourcePath, cacheFolder );
+    std::string tempPath = cachePath + std::string( "." )
+      + std::to_string( std::chrono::steady_clock::now( )
+        .time_since_epoch( ).count( ) )
+      + std::string( "-" ) + std::to_string( buildCounter++ )
+      + std::string( ".tmp" );
+    std::string spillPath = tempPath + std::string( ".columns" );
+    std::vector< std::string > columnBuffers( headers.size( ) );
+    std::vector< std::vector< Chunk > > columnChunks( headers.size( ) );
+    std::vector< uint64_t > columnSizes( headers.size( ), 0 );
+    std::ofstream spillFile;
+    uint64_t spillSize = 0;
+    size_t bufferedSize = 0;
+    bool result = true;
+
+    uint64_t rows = 0;
+    std::vector< StringView > fields;
+    while ( result && reader.readRecord( fields ) )
+    {
+      for ( size_t column = 0; column < headers.size( ); ++column )
+      {
+        std::string& columnBuffer = columnBuffers[ column ];
+        size_t size = columnBuffer.size( );
+        if ( column < fields.size( ) )
+        {
+          StringView field = fields[ column ];
+          field.trim( );
+          appendUInt32( columnBuffer, static_cast< uint32_t >( field.size ) );
+          columnBuffer.append( field.data, field.size );
+        }
+        else
+        {
+          appendUInt32( columnBuffer, SOURCE_CACHE_ABSENT_FIELD );
+        }
+        bufferedSize += columnBuffer.size( ) - size;
+      }
+      ++rows;
+
+      if ( bufferedSize >= SOURCE_CACHE_CHUNK_SIZE )
+      {
+        if ( !spillFile.is_open( ) )
+        {
+          spillFile.open( spillPath, std::ios::binary | std::ios::trunc );
+        }
+        result = spillColumns( spillFile, spillSize, columnBuffers,
+          columnChunks, columnSizes );
+        bufferedSize = 0;
+      }
+    }
+    if ( spillFile.is_open( ) )
+    {
+      spillFile.close( );
+      result = result && !spillFile.fail( );
+    }
+
+    if ( result )
+    {
+      //What is still buffered is the last segment of every column
+      std::vector< std::string > segments( headers.size( ) );
+      for ( size_t column = 0; column < headers.size( ); ++column )
+      {
+        encodeColumn( columnBuffers[ column ], segments[ column ] );
+        std::string( ).swap( columnBuffers[ column ] );
+        columnSizes[ column ] += segments[ column ].size( );
+      }
+
+      std::ofstream cache( tempPath, std::ios::binary | std::ios::trunc );
+      cache.write( SOURCE_CACHE_MAGIC, 8 );
+      writeUInt32( cache, SOURCE_CACHE_VERSION );
+      writeUInt32( cache, static_cast< uint32_t >( headers.size( ) ) );
+      writeUInt64( cache, rows );
+      writeUInt64( cache, sourceFingerprint.size );
+      writeUInt64( cache,
+        static_cast< uint64_t >( sourceFingerprint.modificationTime ) );
+      writeUInt64( cache, sourceFingerprint.contentHash );
+
+      uint64_t offset = SOURCE_CACHE_HEADER_SIZE;
+      for ( const auto& header : headers )
+      {
+        writeUInt32( cache, static_cast< uint32_t >( header.size( ) ) );
+        cache.write( header.data( ), header.size( ) );
+        offset += 4 + header.size( );
+      }
+      offset += 16 * headers.size( );
+      for ( const auto& columnSize : columnSizes )
+      {
+        writeUInt64( cache, offset );
+        writeUInt64( cache, columnSize );
+        offset += columnSize;
+      }
+
+      //Every column block is its spilled segments, in order, followed by
+      //the last one
+      std::ifstream spilledColumns;
+      if ( spillSize != 0 )
+      {
+        spilledColumns.open( spillPath, std::ios::binary );
+      }
+      std::vector< char > buffer;
+      for ( size_t column = 0; column < headers.size( ) && result; ++column )
+      {
+        for ( const auto& chunk : columnChunks[ column ] )
+        {
+          buffer.resize( static_cast< size_t >( chunk.size ) );
+          spilledColumns.seekg( static_cast< std::streamoff >( chunk.offset ) );
+          spilledColumns.read( buffer.data( ),
+            static_cast< std::streamsize >( buffer.size( ) ) );
+          cache.write( buffer.data( ),
+            static_cast< std::streamsize >( buffer.size( ) ) );
+        }
+        cache.write( segments[ column ].data( ),
+          static_cast< std::streamsize >( segments[ column ].size( ) ) );
+        result = !spilledColumns.fail( );
+      }
+      cache.close( );
+      result = result && !cache.fail( );
+    }
+    std::remove( spillPath.c_str( ) );
+
+    if ( result )
+    {
+      std::remove( cachePath.c_str( ) );
+      result = ( std::rename( tempPath.c_str( ), cachePath.c_str( ) ) == 0 );
+    }
+    if ( !result )
+    {
+      std::remove( tempPath.c_str( ) );
+    }
+    return result;
+  }
+
+  bool SourceCache::spillColumns( std::ofstream& spillFile,
+    uint64_t& spillSize, std::vector< std::string >& columnBuffers,
+    std::vector< std::vector< Chunk > >& columnChunks,
+    std::vector< uint64_t >& columnSizes )
+  {
+    std::string segment;
+    for ( size_t column = 0; column < columnBuffers.size( ); ++column )
+    {
+      std::string& columnBuffer = columnBuffers[ column ];
+      if ( columnBuffer.empty( ) )
+      {
+        continue;
+      }
+      encodeColumn( columnBuffer, segment );
+      Chunk chunk;
+      chunk.offset = spillSize;
+      chunk.size = segment.size( );
+      spillFile.write( segment.data( ),
+        static_cast< std::streamsize >( segment.size( ) ) );
+      columnChunks[ column ].emplace_back( chunk );
+      columnSizes[ column ] += chunk.size;
+      spillSize += chunk.size;
+      columnBuffer.clear( );
+    }
+    return !spillFile.fail( );
+  }
+
+  void SourceCache::encodeColumn( const std::string& columnBuffer,
+    std::string& segment )
+  {
+    //Buffered values are length prefixed, absent ones only have the
+    //prefix. Every encoding that fits is measured and the smallest is used
+    std::vector< StringView > values;
+    std::vector< bool > present;
+    for ( size_t position = 0; position < columnBuffer.size( ); )
+    {
+      uint32_t length = decodeUInt32( columnBuffer.data( ) + position );
+      position += 4;
+      if ( length == SOURCE_CACHE_ABSENT_FIELD )
+      {
+        values.emplace_back( );
+        present.emplace_back( false );
+        continue;
+      }
+      values.emplace_back( columnBuffer.data( ) + position, length );
+      present.emplace_back( true );
+      position += length;
+    }
+
+    uint64_t plainSize = 0;
+    uint64_t numericSize = 0;
+    uint64_t dictionarySize = 0;
+    bool numeric = true;
+    std::unordered_map< std::string, uint64_t > entries;
+    std::vector< StringView > dictionary;
+    std::vector< int64_t > mantissas( values.size( ), 0 );
+    std::vector< uint64_t > scales( values.size( ), 0 );
+    std::string text;
+    for ( size_t i = 0; i < values.size( ); ++i )
+    {
+      if ( !present[ i ] )
+      {
+        ++plainSize;
+        ++numericSize;
+        ++dictionarySize;
+        continue;
+      }
+      const StringView& value = values[ i ];
+      plainSize += getVarSize( value.size + 1 ) + value.size;
+      numeric = numeric && parseNumber( value, mantissas[ i ], scales[ i ],
+        text );
+      if ( numeric )
+      {
+        numericSize += getVarSize( scales[ i ] + 1 )
+          + getVarSize( zigzag( mantissas[ i ] ) );
+      }
+      if ( dictionary.size( ) <= SOURCE_CACHE_MAX_DICTIONARY )
+      {
+        auto entry = entries.emplace( value.str( ), dictionary.size( ) );
+        if ( entry.second )
+        {
+          dictionary.emplace_back( value );
+          dictionarySize += getVarSize( value.size ) + value.size;
+        }
+        dictionarySize += getVarSize( entry.first->second + 1 );
+      }
+    }
+
+    CacheReader::Encoding encoding = CacheReader::Encoding::Plain;
+    uint64_t size = plainSize;
+    if ( numeric && numericSize < size )
+    {
+      encoding = CacheReader::Encoding::Numeric;
+      size = numericSize;
+    }
+    if ( dictionary.size( ) <= SOURCE_CACHE_MAX_DICTIONARY
+      && dictionarySize + getVarSize( dictionary.size( ) ) < size )
+    {
+      encoding = CacheReader::Encoding::Dictionary;
+    }
+
+    //Encoding, values and, for dictionaries, the entries. Every value
+    //starts with a tag, 0 for absent fields, otherwise the length of plain
+    //values, the scale of numeric ones (followed by the zigzag encoded
+    //mantissa) or the dictionary index, plus one
+    segment.clear( );
+    segment.push_back( static_cast< char >( encoding ) );
+    appendVarUInt64( segment, values.size( ) );
+    if ( encoding == CacheReader::Encoding::Dictionary )
+    {
+      appendVarUInt64( segment, dictionary.size( ) );
+      for ( const auto& entry : dictionary )
+      {
+        appendVarUInt64( segment, entry.size );
+        segment.append( entry.data, entry.size );
+      }
+    }
+    for ( size_t i = 0; i < values.size( ); ++i )
+    {
+      if ( !present[ i ] )
+      {
+        appendVarUInt64( segment, 0 );
+        continue;
+      }
+      const StringView& value = values[ i ];
+      switch( encoding )
+      {
+        case CacheReader::Encoding::Numeric:
+          appendVarUInt64( segment, scales[ i ] + 1 );
+          appendVarUInt64( segment, zigzag( mantissas[ i ] ) );
+          break;
+        case CacheReader::Encoding::Dictionary:
+          appendVarUInt64( segment, entries.at( value.str( ) ) + 1 );
+          break;
+        default:
+          appendVarUInt64( segment, value.size + 1 );
+          segment.append( value.data, value.size );
+          break;
+      }
+    }
+  }
+
+  bool SourceCache::parseNumber( const StringView& value, int64_t& mantissa,
+    uint64_t& scale, std::string& text )
+  {
+    //Decimal numbers of up to SOURCE_CACHE_MAX_DIGITS digits, only when
+    //they are written back exactly as they were, e.g. not "+1", "01",
+    //".5" or "-0"
+    const char* current = value.data;
+    const char* end = value.data + value.size;
+    bool negative = ( current < end && *current == '-' );
+    if ( negative )
+    {
+      ++current;
+    }
+    uint64_t magnitude = 0;
+    size_t digits = 0;
+    bool point = false;
+    scale = 0;
+    for ( ; current < end; ++current )
+    {
+      if ( *current == '.' && !point )
+      {
+        point = true;
+        continue;
+      }
+      if ( *current < '0' || *current > '9'
+        || ++digits > SOURCE_CACHE_MAX_DIGITS )
+      {
+        return false;
+      }
+      magnitude = magnitude * 10 + static_cast< uint64_t >( *current - '0' );
+      if ( point )
+      {
+        ++scale;
+      }
+    }
+    if ( digits == 0 )
+    {
+      return false;
+    }
+    mantissa = negative ? -static_cast< int64_t >( magnitude )
+      : static_cast< int64_t >( magnitude );
+    CacheReader::formatNumber( mantissa, scale, text );
+    return StringView( text ) == value;
+  }
+
+  uint64_t SourceCache::zigzag( const int64_t& value )
+  {
+    return ( static_cast< uint64_t >( value ) << 1 )
+      ^ static_cast< uint64_t >( value >> 63 );
+  }
+
+  uint64_t SourceCache::getVarSize( uint64_t value )
+  {
+    uint64_t size = 1;
+    while ( value >= 0x80 )
+    {
+      value >>= 7;
+      ++size;
+    }
+    return size;
+  }
+
+  RecordReaderPtr SourceCache::open( const std::string& sourcePath,
+    const std::string& cacheFolder )
+  {
+    if ( !cacheFolder.empty( ) )
+    {
+      RecordReaderPtr cacheReader = openCache( sourcePath, cacheFolder );
+      if ( !cacheReader && build( sourcePath, cacheFolder ) )
+      {
+        cacheReader = openCache( sourcePath, cacheFolder );
+      }
+      if ( cacheReader )
+      {
+        return cacheReader;
+      }
+    }
+    return RecordReaderPtr( new CsvReader( sourcePath ) );
+  }
+
+  bool SourceCache::readHeaders( const std::string& sourcePath,
+    const std::string& cacheFolder, std::vector< std::string >& headers )
+  {
+    RecordReaderPtr reader;
+    if ( !cacheFolder.empty( ) )
+    {
+      reader = openCache( sourcePath, cacheFolder );
+    }
+    if ( !reader )
+    {
+      reader.reset( new CsvReader( sourcePath ) );
+    }
+    return reader->readHeaders( headers );
+  }
+
+}
@@ -0,0 +1,96 @@
+/*
+ * Vishnu
+ * Copyright (c) 2017-2019 GMRV/URJC.
+ *
+ * Authors: Gonzalo Bayo Martinez <gonzalo.bayo@urjc.es>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef VISHNU_SOURCECACHE_H
+#define VISHNU_SOURCECACHE_H
+
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "RecordReader.h"
+
+namespace vishnu
+{
+
+  /*
+   * Columnar binary cache of a source CSV, kept in a cache folder
+   * (<source name>-<path hash>.STR_EXT_CACHE) so input folders are never
+   * written to. The cache stores the fingerprint of the source it was built
+   * from and is ignored, and rebuilt, as soon as the source changes.
+   *
+   * Layout (little endian): magic, version, columns, rows, source size,
+   * mtime and content hash, header names, column table (offset and size of
+   * every column) and column blocks. A column block is a run of segments,
+   * each encoded on its own as plain length prefixed values, decimal
+   * numbers (scale and mantissa as variable length integers) or indices
+   * into a dictionary of up to SOURCE_CACHE_MAX_DICTIONARY distinct values,
+   * whichever is smallest.
+   */
+  class SourceCache
+  {
+
+    public:
+
+      static std::string getCachePath( const std::string& sourcePath,
+        const std::string& cacheFolder );
+
+      //Reader over an up to date cache, null if there is none
+      static RecordReaderPtr openCache( const std::string& sourcePath,
+        const std::string& cacheFolder );
+
+      static bool build( const std::string& sourcePath,
+        const std::string& cacheFolder );
+
+      //Reader over the source cache (built if needed) when a cache folder
+      //is given, over the CSV file otherwise or if the cache can't be
+      //written
+      static RecordReaderPtr open( const std::string& sourcePath,
+        const std::string& cacheFolder );
+
+      //Source headers, from the cache when it is up to date
+      static bool readHeaders( const std::string& sourcePath,
+        const std::string& cacheFolder, std::vector< std::string >& headers );
+
+    private:
+
+      //Part of a column block spilled to the temporary columns file
+      struct Chunk
+      {
+        uint64_t offset;
+        uint64_t size;
+      };
+
+      static bool spillColumns( std::ofstream& spillFile, uint64_t& spillSize,
+        std::vector< std::string >& columnBuffers,
+        std::vector< std::vector< Chunk > >& columnChunks,
+        std::vector< uint64_t >& columnSizes );
+      static void encodeColumn( const std::string& columnBuffer,
+        std::string& segment );
+      static bool parseNumber( const StringView& value, int64_t& mantissa,
+        uint64_t& scale, std::string& text );
+      static uint64_t zigzag( const int64_t& value );
+      static uint64_t getVarSize( uint64_t value );
+  };
+
+}
+
+#endif
@@ -0,0 +1,104 @@
+/*
+ * Vishnu
+ * Copyright (c) 2017-2019 GMRV/URJC.
+ *
+ * Authors: Gonzalo Bayo Martinez <gonzalo.bayo@urjc.es>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef VISHNU_STRINGVIEW_H
+#define VISHNU_STRINGVIEW_H
+
+#include <cstring>
+#include <string>
+
+namespace vishnu
+{
+
+  /*
+   * Non owning reference to a run of characters, usually a field inside a
+   * mapped file. The referenced memory must outlive the view.
+   */
+  struct StringView
+  {
+    const char* data;
+    size_t size;
+
+    StringView( void )
+      : data( "" )
+      , size( 0 )
+    {
+
+    }
+
+    StringView( const char* data_, const size_t& size_ )
+      : data( data_ )
+      , size( size_ )
+    {
+
+    }
+
+    StringView( const std::string& string )
+      : data( string.data( ) )
+      , size( string.size( ) )
+    {
+
+    }
+
+    bool empty( void ) const
+    {
+      return size == 0;
+    }
+
+    std::string str( void ) const
+    {
+      return std::string( data, size );
+    }
+
+    bool operator==( const StringView& other ) const
+    {
+      return size == other.size
+        && ( size == 0 || std::memcmp( data, other.data, size ) == 0 );
+    }
+
+    bool operator!=( const StringView& other ) const
+    {
+      return !( *this == other );
+    }
+
+    //Removes leading and trailing whitespaces moving the view bounds
+    void trim( void )
+    {
+      while ( size > 0 && isWhitespace( data[ size - 1 ] ) )
+      {
+        --size;
+      }
+      while ( size > 0 && isWhitespace( *data ) )
+      {
+        ++data;
+        --size;
+      }
+    }
+
+    static bool isWhitespace( const char& c )
+    {
+      return c == ' ' || c == '\t' || c == '\n' || c == '\r' || c == '\f'
+        || c == '\v';
+    }
+  };
+
+}
+
+#endif
@@ -0,0 +1,262 @@
+/*
+ * Vishnu
+ * Copyright (c) 2017-2019 GMRV/URJC.
+ *
+ * Authors: Gonzalo Bayo Martinez <gonzalo.bayo@urjc.es>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "TypeInference.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <thread>
+#include <unordered_set>
+
+#include "CsvReader.h"
+#include "SourceCache.h"
+#include "../Definitions.hpp"
+
+namespace vishnu
+{
+
+  namespace
+  {
+    const char* GEOMETRY_EXTENSIONS[ ] = { ".obj", ".ply", ".stl", ".off",
+      ".vtk" };
+
+    bool isDigit( const char& c )
+    {
+      return c >= '0' && c <= '9';
+    }
+
+    size_t skipDigits( const StringView& value, size_t i )
+    {
+      while ( i < value.size && isDigit( value.data[ i ] ) )
+      {
+        ++i;
+      }
+      return i;
+    }
+
+    size_t skipSign( const StringView& value, size_t i )
+    {
+      return ( i < value.size
+        && ( value.data[ i ] == '-' || value.data[ i ] == '+' ) ) ? i + 1 : i;
+    }
+
+    bool isInteger( const StringView& value )
+    {
+      size_t begin = skipSign( value, 0 );
+      size_t end = skipDigits( value, begin );
+      return end > begin && end == value.size;
+    }
+
+    //Decimal notation with optional exponent, like 1.5, -.5, 2e-3
+    bool isFloat( const StringView& value )
+    {
+      size_t i = skipSign( value, 0 );
+      size_t integerEnd = skipDigits( value, i );
+      size_t digits = integerEnd - i;
+      i = integerEnd;
+      if ( i < value.size && value.data[ i ] == '.' )
+      {
+        size_t fractionEnd = skipDigits( value, i + 1 );
+        digits += fractionEnd - i - 1;
+        i = fractionEnd;
+      }
+      if ( digits == 0 )
+      {
+        return false;
+      }
+      if ( i < value.size && ( value.data[ i ] == 'e' || value.data[ i ] == 'E' ) )
+      {
+        size_t exponent = skipSign( value, i + 1 );
+        i = skipDigits( value, exponent );
+        if ( i == exponent )
+        {
+          return false;
+        }
+      }
+      return i == value.size;
+    }
+
+    bool isGeometricPath( const StringView& value )
+    {
+      for ( const char* extension : GEOMETRY_EXTENSIONS )
+      {
+        size_t size = std::strlen( extension );
+        if ( value.size > size )
+        {
+          const char* suffix = value.data + value.size - size;
+          bool equal = true;
+          for ( size_t i = 0; i < size && equal; ++i )
+          {
+            char c = suffix[ i ];
+            equal = ( ( c >= 'A' && c <= 'Z' ) ? c - 'A' + 'a' : c )
+              == extension[ i ];
+          }
+          if ( equal )
+          {
+            return true;
+          }
+        }
+      }
+      return false;
+    }
+
+    //Types still possible for a column, narrowed value by value
+    struct ColumnSample
+    {
+      bool integer = true;
+      bool number = true;
+      bool geometricPath = true;
+      std::unordered_set< std::string > distinctValues;
+    };
+  }
+
+  bool TypeInference::infer( const std::string& path,
+    const size_t& sampleRows, Columns& columns,
+    const std::string& cacheFolder )
+  {
+    columns.clear( );
+    //Inference runs on the GUI thread, so caches are only read, never built
+    RecordReaderPtr reader;
+    if ( !cacheFolder.empty( ) )
+    {
+      reader = SourceCache::openCache( path, cacheFolder );
+    }
+    if ( !reader )
+    {
+      reader.reset( new CsvReader( path ) );
+    }
+    std::vector< std::string > headers;
+    if ( !reader->isOpen( ) )
+    {
+      return false;
+    }
+    if ( !reader->readHeaders( headers ) )
+    {
+      //Empty file
+      return true;
+    }
+
+    columns.resize( headers.size( ) );
+    std::vector< ColumnSample > samples( headers.size( ) );
+    for ( size_t col = 0; col < headers.size( ); ++col )
+    {
+      columns[ col ].name = headers[ col ];
+    }
+
+    std::vector< StringView > fields;
+    size_t begin = reader->getPosition( );
+    for ( size_t row = 0; row < sampleRows
+      && reader->getPosition( ) - begin < TYPE_INFERENCE_SAMPLE_BYTES
+      && reader->readRecord( fields ); ++row )
+    {
+      for ( size_t col = 0; col < columns.size( ); ++col )
+      {
+        Column& column = columns[ col ];
+        StringView value;
+        if ( col < fields.size( ) )
+        {
+          value = fields[ col ];
+          value.trim( );
+        }
+        if ( value.empty( ) || value == StringView( MISSING_DATA_FIELD,
+          sizeof( MISSING_DATA_FIELD ) - 1 ) )
+        {
+          ++column.missingValues;
+          continue;
+        }
+
+        ++column.values;
+        ColumnSample& sample = samples[ col ];
+        sample.integer = sample.integer && isInteger( value );
+        sample.number = sample.number && ( sample.integer || isFloat( value ) );
+        sample.geometricPath = sample.geometricPath
+          && isGeometricPath( value );
+        if ( sample.distinctValues.size( ) <= TYPE_INFERENCE_MAX_CATEGORIES )
+        {
+          sample.distinctValues.emplace( value.data, value.size );
+        }
+      }
+    }
+
+    for ( size_t col = 0; col < columns.size( ); ++col )
+    {
+      Column& column = columns[ col ];
+      const ColumnSample& sample = samples[ col ];
+      column.cardinality = sample.distinctValues.size( );
+      if ( column.values == 0 )
+      {
+        column.type = ColumnType::Empty;
+      }
+      else if ( sample.integer )
+      {
+        column.type = ColumnType::Integer;
+      }
+      else if ( sample.number )
+      {
+        column.type = ColumnType::Float;
+      }
+      else if ( sample.geometricPath )
+      {
+        column.type = ColumnType::GeometricPath;
+      }
+      else if ( column.cardinality <= TYPE_INFERENCE_MAX_CATEGORIES
+        && column.cardinality < column.values )
+      {
+        column.type = ColumnType::Categorical;
+      }
+      else
+      {
+        column.type = ColumnType::Text;
+      }
+    }
+    return true;
+  }
+
+  std::vector< TypeInference::Columns > TypeInference::infer(
+    const std::vector< std::string >& paths, const size_t& sampleRows,
+    const size_t& workers, const std::string& cacheFolder )
+  {
+    std::vector< Columns > columns( paths.size( ) );
+    size_t workersSize = ( workers == 0 )
+      ? std::max( 1u, std::thread::hardware_concurrency( ) ) : workers;
+    workersSize = std::min( workersSize, paths.size( ) );
+
+    std::atomic< size_t > nextPath( 0 );
+    std::vector< std::thread > threads;
+    for ( size_t i = 0; i < workersSize; ++i )
+    {
+      threads.emplace_back( [ & ]( )
+      {
+        size_t index;
+        while ( ( index = nextPath++ ) < paths.size( ) )
+        {
+          infer( paths[ index ], sampleRows, columns[ index ], cacheFolder );
+        }
+      } );
+    }
+    for ( auto& thread : threads )
+    {
+      thread.join( );
+    }
+    return columns;
+  }
+
+}
@@ -0,0 +1,79 @@
+/*
+ * Vishnu
+ * Copyright (c) 2017-2019 GMRV/URJC.
+ *
+ * Authors: Gonzalo Bayo Martinez <gonzalo.bayo@urjc.es>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef VISHNU_TYPEINFERENCE_H
+#define VISHNU_TYPEINFERENCE_H
+
+#include <string>
+#include <vector>
+
+namespace vishnu
+{
+
+  /*
+   * Guesses the type of every column of a CSV source from a sample of its
+   * first records. At most the given rows and TYPE_INFERENCE_SAMPLE_BYTES
+   * bytes are read, so the cost does not depend on the source size.
+   * With a cache folder, an up to date source cache is read instead of the
+   * CSV file. Missing caches are left to the build (see SourceCache::open).
+   */
+  class TypeInference
+  {
+
+    public:
+
+      enum class ColumnType
+      {
+        Empty, //Only missing values in the sample
+        Integer,
+        Float,
+        Categorical, //Repeated values, up to TYPE_INFERENCE_MAX_CATEGORIES
+        GeometricPath, //Mesh file names
+        Text
+      };
+
+      struct Column
+      {
+        std::string name;
+        ColumnType type = ColumnType::Empty;
+        //Distinct values in the sample, counted up to
+        //TYPE_INFERENCE_MAX_CATEGORIES + 1
+        size_t cardinality = 0;
+        size_t values = 0;
+        size_t missingValues = 0;
+      };
+      using Columns = std::vector< Column >;
+
+      //False if the source can't be read. A sampleRows value of 0 only reads
+      //the headers, leaving every column Empty
+      static bool infer( const std::string& path, const size_t& sampleRows,
+        Columns& columns, const std::string& cacheFolder = std::string( ) );
+
+      //One source per worker thread, results in path order. A workers value
+      //of 0 uses one worker per hardware thread
+      static std::vector< Columns > infer(
+        const std::vector< std::string >& paths, const size_t& sampleRows,
+        const size_t& workers = 0,
+        const std::string& cacheFolder = std::string( ) );
+  };
+
+}
+
+#endif
@@ -32,12 +32,14 @@
 
 #include "../Definitions.hpp"
 #include "../RegExpInputDialog.h"
+#include "../pipeline/DataSetSchema.h"
 
 namespace vishnu
 {
 
   DataSetListWidget::DataSetListWidget( QWidget* parent )
       : QListWidget( parent )
+      , _typeInferenceRows( TYPE_INFERENCE_SAMPLE_ROWS )
   {
 
     setSelectionMode( QAbstractItemView::SingleSelection );
@@ -1177,22 +1179,15 @@ namespace vishnu
 
     if ( notUsedPath )
     {
-      vishnucommon::DataSetPtr dataSet( new vishnucommon::DataSet( path ) );
-
-      if ( properties.size( ) == 0 ) //CSV
+      vishnucommon::DataSetPtr dataSet;
+      if ( properties.size( ) == 0 ) //CSV without sampled properties
       {
-        std::vector< std::string > headers =
-          vishnucommon::Files::readCsvHeaders( path );
-
-        for ( const auto& header : headers )
-        {
-          dataSet->addProperty( vishnucommon::PropertyPtr(
-            new vishnucommon::Property( header, vishnucommon::DataCategory::Undefined,
-            vishnucommon::DataStructureType::None ) ) );
-        }
+        dataSet = DataSetSchema::readCsvDataSet( path, _typeInferenceRows,
+          _cacheFolder );
       }
-      else //JSON or SEG
+      else //Sampled CSV, JSON or SEG
       {
+        dataSet.reset( new vishnucommon::DataSet( path ) );
         dataSet->setProperties( properties );
       }
 
@@ -1239,6 +1234,21 @@ namespace vishnu
 
     filePaths.removeDuplicates( );
 
+    //CSV columns are sampled for their data categories, all files at once
+    std::vector< std::string > csvPaths;
+    for ( const auto& qFilePath : filePaths )
+    {
+      if ( vishnucommon::Strings::lower( QFileInfo( qFilePath ).completeSuffix( )
+        .toStdString( ) ) == STR_EXT_CSV )
+      {
+        csvPaths.emplace_back( qFilePath.toStdString( ) );
+      }
+    }
+    std::vector< vishnucommon::DataSetPtr > csvDataSets =
+      DataSetSchema::readCsvDataSets( csvPaths, _typeInferenceRows,
+        _cacheFolder );
+    size_t csvDataSet = 0;
+
     for ( int i = 0; i < filePaths.count( ); ++i )
     {
       QString qFilePath = filePaths.at( i );
@@ -1261,7 +1271,8 @@ namespace vishnu
       }
       else if ( extension == STR_EXT_CSV )
       {
-        createDataSetFromCSV( dataSetWidgets, filepath );
+        createDataSetFromCSV( dataSetWidgets, filepath,
+          csvDataSets.at( csvDataSet++ )->getProperties( ) );
       }
     }
 
@@ -1330,25 +1341,19 @@ namespace vishnu
     _propertyGroups = propertyGroups;
   }
 
-  std::vector< std::string > DataSetListWidget::getCommonProperties( )
+  void DataSetListWidget::setTypeInferenceRows( const size_t& typeInferenceRows )
   {
-    std::vector< std::string > commonProperties;
-    for ( const auto& dataset : getDataSets( )->getDataSets( ) )
-    {
-      std::vector< std::string > dataSetHeaders = dataset->getPropertyNames( );
+    _typeInferenceRows = typeInferenceRows;
+  }
 
-      if ( !commonProperties.empty( ) )
-      {
-        commonProperties = vishnucommon::Vectors::intersect( commonProperties,
-          dataSetHeaders );
-      }
-      else
-      {
-        commonProperties = dataSetHeaders;
-      }
-    }
+  void DataSetListWidget::setCacheFolder( const std::string& cacheFolder )
+  {
+    _cacheFolder = cacheFolder;
+  }
 
-    return commonProperties;
+  std::vector< std::string > DataSetListWidget::getCommonProperties( )
+  {
+    return DataSetSchema::getCommonProperties( getDataSets( ) );
   }
 
   void DataSetListWidget::dragEnterEvent( QDragEnterEvent* event )
@@ -115,6 +115,13 @@ namespace vishnu
       void setPropertyGroups(
         const vishnucommon::PropertyGroupsPtr& propertyGroups );
 
+      //Records sampled to infer the data category of CSV columns
+      void setTypeInferenceRows( const size_t& typeInferenceRows );
+
+      //CSV columns are sampled through source caches in this folder (see
+      //SourceCache), directly when empty
+      void setCacheFolder( const std::string& cacheFolder );
+
     protected:
 
       void dragEnterEvent( QDragEnterEvent* event );
@@ -181,6 +188,8 @@ namespace vishnu
         const vishnucommon::Properties& properties = vishnucommon::Properties( ) );
 
       vishnucommon::PropertyGroupsPtr _propertyGroups;
+      size_t _typeInferenceRows;
+      std::string _cacheFolder;
 
   };
 
@@ -27,6 +27,8 @@
 #include <QMimeData>
 #include <QHeaderView>
 
+#include "../pipeline/DataSetSchema.h"
+
 namespace vishnu
 {
   PropertiesTableWidget::PropertiesTableWidget( QWidget* /*parent*/ )
@@ -329,78 +331,28 @@ namespace vishnu
 
   vishnucommon::DataSetsPtr PropertiesTableWidget::getDataSets( void )
   {
-    vishnucommon::DataSetsPtr dataSets( new vishnucommon::DataSets( ) );
-    vishnucommon::DataSetPtr dataSet( new vishnucommon::DataSet( ) );
-    vishnucommon::PropertyGroupsPtr propertyGroups(
-      new vishnucommon::PropertyGroups( ) );
-    std::string xAxis;
-    std::string yAxis;
-    std::string zAxis;
-    std::string xyzAxis;
+    DataSetSchema::Properties properties;
     for( int row = 0; row < rowCount( ); ++row )
     {
-      std::string name = static_cast< QLabel* >( cellWidget( row, 0 )
+      DataSetSchema::Property property;
+      property.name = static_cast< QLabel* >( cellWidget( row, 0 )
         )->text( ).toStdString( );
-      bool use = static_cast< QCheckBox* >( cellWidget( row, 1 )
+      property.use = static_cast< QCheckBox* >( cellWidget( row, 1 )
         )->isChecked( );
-      bool primaryKey = static_cast< QCheckBox* >( cellWidget( row, 2 )
+      property.primaryKey = static_cast< QCheckBox* >( cellWidget( row, 2 )
         )->isChecked( );
       QComboBox* dataTypeComboBox = static_cast< QComboBox* >( cellWidget(
         row, 3 ) );
-      vishnucommon::DataCategory dataCategory = vishnucommon::toDataCategory(
+      property.dataCategory = vishnucommon::toDataCategory(
         dataTypeComboBox->currentText( ).toStdString( ) );
       QComboBox* axisTypeComboBox = static_cast< QComboBox* >( cellWidget(
         row, 4 ) );
-      vishnucommon::AxisType axisType = vishnucommon::toAxisType(
+      property.axisType = vishnucommon::toAxisType(
         axisTypeComboBox->currentText( ).toStdString( ) );
-
-      if ( use )
-      {
-        if ( primaryKey )
-        {
-          propertyGroups->addUsedPrimaryKey( name );
-        }
-        else
-        {
-          propertyGroups->addUsedNonPrimaryKey( name );
-        }
-        dataSet->addProperty( vishnucommon::PropertyPtr(
-          new vishnucommon::Property( name, dataCategory,
-          vishnucommon::DataStructureType::None ) ) );
-      }
-
-      switch( axisType )
-      {
-        case vishnucommon::AxisType::X:
-          xAxis = name;
-          break;
-        case vishnucommon::AxisType::Y:
-          yAxis = name;
-          break;
-        case vishnucommon::AxisType::Z:
-          zAxis = name;
-          break;
-        case vishnucommon::AxisType::XYZ:
-          xyzAxis = name;
-          break;
-        default:
-          break;
-      }
+      properties.emplace_back( property );
     }
 
-    if ( !xyzAxis.empty( ) )
-    {
-      propertyGroups->setAxes( xyzAxis );
-    }
-    else
-    {
-      propertyGroups->setAxes( xAxis, yAxis, zAxis );
-    }
-
-    dataSets->setDataSets( { dataSet } );
-    dataSets->setPropertyGroups( propertyGroups );
-
-    return dataSets;
+    return DataSetSchema::createResultDataSets( properties );
   }
 
   void PropertiesTableWidget::dragEnterEvent( QDragEnterEvent* event )